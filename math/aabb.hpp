@@ -0,0 +1,161 @@
+#pragma once
+
+#ifndef __AABB__
+#define __AABB__
+
+#include <limits>
+#include <tuple>
+
+#include "vector.hpp"
+
+template<class T>
+class aabb3;
+
+using aabb3f = aabb3<float>;
+using aabb3d = aabb3<double>;
+using aabb3ld = aabb3<long double>;
+
+/*
+	aabb3
+	- an axis-aligned box from min to max, both inclusive
+	- default constructed as the empty box (min = +inf, max = -inf), which is the identity of merge and expand
+*/
+template<class T>
+class aabb3
+{
+public:
+	vec3<T> min, max;
+	static const aabb3<T> empty;
+
+public:
+	constexpr aabb3() :
+		min(std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity()),
+		max(-std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity())
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of aabb3 must be a floating-point type!");
+	}
+
+	constexpr aabb3(vec3<T> min, vec3<T> max) : min(min), max(max)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of aabb3 must be a floating-point type!");
+	}
+
+public:
+	constexpr bool is_empty() const
+	{
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	constexpr vec3<T> center() const
+	{
+		return vec3<T>((min.x + max.x) * static_cast<T>(0.5), (min.y + max.y) * static_cast<T>(0.5), (min.z + max.z) * static_cast<T>(0.5));
+	}
+
+	constexpr vec3<T> size() const
+	{
+		return vec3<T>(max.x - min.x, max.y - min.y, max.z - min.z);
+	}
+
+	//0 for the empty box
+	constexpr T surface_area() const
+	{
+		if (is_empty())
+		{
+			return 0;
+		}
+		vec3<T> size = this->size();
+		return static_cast<T>(2.0) * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	constexpr void expand(vec3<T> point)
+	{
+		min = ::min(min, point);
+		max = ::max(max, point);
+	}
+
+	constexpr void expand(const aabb3<T>& box)
+	{
+		min = ::min(min, box.min);
+		max = ::max(max, box.max);
+	}
+
+	constexpr bool contains(vec3<T> point) const
+	{
+		return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y && point.z >= min.z && point.z <= max.z;
+	}
+
+	constexpr bool intersects(const aabb3<T>& box) const
+	{
+		return min.x <= box.max.x && max.x >= box.min.x && min.y <= box.max.y && max.y >= box.min.y && min.z <= box.max.z && max.z >= box.min.z;
+	}
+
+	/*
+		intersect_ray
+		- slab test of origin + t * direction for t in [t_min, t_max], inverse_direction is 1 / direction per component
+		  (an infinity for a zero component)
+		- returns whether the ray hits the box and the distance t at which it enters it (t_min when it starts inside)
+	*/
+	constexpr std::tuple<bool, T> intersect_ray(vec3<T> origin, vec3<T> inverse_direction, T t_min, T t_max) const
+	{
+		T tx0 = (min.x - origin.x) * inverse_direction.x, tx1 = (max.x - origin.x) * inverse_direction.x;
+		T ty0 = (min.y - origin.y) * inverse_direction.y, ty1 = (max.y - origin.y) * inverse_direction.y;
+		T tz0 = (min.z - origin.z) * inverse_direction.z, tz1 = (max.z - origin.z) * inverse_direction.z;
+		T enter = ::max(::max(::min(tx0, tx1), ::min(ty0, ty1)), ::max(::min(tz0, tz1), t_min));
+		T exit = ::min(::min(::max(tx0, tx1), ::max(ty0, ty1)), ::min(::max(tz0, tz1), t_max));
+		return { enter <= exit, enter };
+	}
+};
+
+template<class T>
+constexpr aabb3<T> aabb3<T>::empty = aabb3<T>();
+
+//Exact compare, every empty box equals every other one (the threshold == of vec3 is NaN for the infinite bounds)
+template<class T>
+constexpr bool operator==(const aabb3<T>& box1, const aabb3<T>& box2)
+{
+	if (box1.is_empty() || box2.is_empty())
+	{
+		return box1.is_empty() && box2.is_empty();
+	}
+	return box1.min.x == box2.min.x && box1.min.y == box2.min.y && box1.min.z == box2.min.z &&
+		box1.max.x == box2.max.x && box1.max.y == box2.max.y && box1.max.z == box2.max.z;
+}
+
+template<class T>
+constexpr bool operator!=(const aabb3<T>& box1, const aabb3<T>& box2)
+{
+	return !(box1 == box2);
+}
+
+//The smallest box holding both boxes
+template<class T>
+constexpr aabb3<T> merge(const aabb3<T>& box1, const aabb3<T>& box2)
+{
+	return aabb3<T>(min(box1.min, box2.min), max(box1.max, box2.max));
+}
+
+template<class T>
+constexpr aabb3<T> merge(const aabb3<T>& box, vec3<T> point)
+{
+	return aabb3<T>(min(box.min, point), max(box.max, point));
+}
+
+template<class T>
+constexpr T surface_area(const aabb3<T>& box)
+{
+	return box.surface_area();
+}
+
+template<class T>
+constexpr bool intersects(const aabb3<T>& box1, const aabb3<T>& box2)
+{
+	return box1.intersects(box2);
+}
+
+template<class T>
+constexpr std::tuple<bool, T> intersect_ray(const aabb3<T>& box, vec3<T> origin, vec3<T> inverse_direction, T t_min, T t_max)
+{
+	return box.intersect_ray(origin, inverse_direction, t_min, t_max);
+}
+
+#endif // !__AABB__
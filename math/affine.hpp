@@ -0,0 +1,192 @@
+#pragma once
+
+#ifndef __AFFINE__
+#define __AFFINE__
+
+#include "transform.hpp"
+
+template<class T>
+class affine3;
+
+using affine3f = affine3<float>;
+using affine3d = affine3<double>;
+using affine3ld = affine3<long double>;
+
+/*
+	affine3
+	- an affine transform stored as its linear part and its translation, 12 values instead of the 16 of a mat4x4
+	- like the row-vector mat4x4, a point maps to point * linear + translation, a direction to direction * linear
+	- a1 * a2 applies a1 first and then a2, the same order as to_mat4x4(a1) * to_mat4x4(a2)
+*/
+template<class T>
+class affine3
+{
+public:
+	mat3x3<T> linear;
+	vec3<T> translation;
+	static const affine3<T> identity;
+
+public:
+	constexpr affine3() : linear(), translation(0.0, 0.0, 0.0)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of affine3 must be a floating-point type!");
+	}
+
+	constexpr affine3(const mat3x3<T>& linear, vec3<T> translation) : linear(linear), translation(translation)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of affine3 must be a floating-point type!");
+	}
+
+public:
+	constexpr vec3<T> transform_direction(vec3<T> direction) const
+	{
+		return vec3<T>(
+			direction.x * linear.unchecked(0, 0) + direction.y * linear.unchecked(1, 0) + direction.z * linear.unchecked(2, 0),
+			direction.x * linear.unchecked(0, 1) + direction.y * linear.unchecked(1, 1) + direction.z * linear.unchecked(2, 1),
+			direction.x * linear.unchecked(0, 2) + direction.y * linear.unchecked(1, 2) + direction.z * linear.unchecked(2, 2));
+	}
+
+	constexpr vec3<T> transform_point(vec3<T> point) const
+	{
+		vec3<T> ret = transform_direction(point);
+		return vec3<T>(ret.x + translation.x, ret.y + translation.y, ret.z + translation.z);
+	}
+
+	constexpr T det() const
+	{
+		return linear.det();
+	}
+
+	//Inverse of the linear part, the translation is then moved back through it: -translation * linear^-1
+	constexpr std::tuple<bool, affine3<T>> inverse(T threshold = FLOATING_POINT_THRESHOLD) const
+	{
+		std::tuple<bool, mat3x3<T>> inversed = linear.inverse(threshold);
+		if (!std::get<0>(inversed))
+		{
+			return { false, affine3<T>() };
+		}
+		affine3<T> ret(std::get<1>(inversed), vec3<T>(0.0, 0.0, 0.0));
+		vec3<T> moved = ret.transform_direction(translation);
+		ret.translation = vec3<T>(-moved.x, -moved.y, -moved.z);
+		return { true, ret };
+	}
+};
+
+template<class T>
+constexpr affine3<T> affine3<T>::identity = affine3<T>(mat3x3<T>::identity, vec3<T>(0.0, 0.0, 0.0));
+
+template<class T>
+constexpr affine3<T> operator*(const affine3<T>& affine1, const affine3<T>& affine2)
+{
+	return affine3<T>(affine1.linear * affine2.linear, affine2.transform_point(affine1.translation));
+}
+
+template<class T>
+constexpr void operator*=(affine3<T>& affine1, const affine3<T>& affine2)
+{
+	affine1 = affine1 * affine2;
+}
+
+template<class T>
+constexpr bool operator==(const affine3<T>& affine1, const affine3<T>& affine2)
+{
+	return affine1.linear == affine2.linear && affine1.translation == affine2.translation;
+}
+
+template<class T>
+constexpr bool operator!=(const affine3<T>& affine1, const affine3<T>& affine2)
+{
+	return !(affine1 == affine2);
+}
+
+template<class T>
+constexpr vec3<T> transform_point(vec3<T> point, const affine3<T>& affine)
+{
+	return affine.transform_point(point);
+}
+
+template<class T>
+constexpr vec3<T> transform_direction(vec3<T> direction, const affine3<T>& affine)
+{
+	return affine.transform_direction(direction);
+}
+
+template<class T>
+constexpr T det(const affine3<T>& affine)
+{
+	return affine.det();
+}
+
+template<class T>
+constexpr std::tuple<bool, affine3<T>> inverse(const affine3<T>& affine, T threshold = FLOATING_POINT_THRESHOLD)
+{
+	return affine.inverse(threshold);
+}
+
+/*
+	to_mat4x4 / to_affine
+	- both conversions are exact, to_affine copies the upper 3x3 and the translation row (or column)
+	- to_affine returns false when the projective row (or column) of the matrix is not (0, 0, 0, 1),
+	  such a matrix has no affine3 form
+*/
+template<class T>
+constexpr mat4x4<T> to_mat4x4(const affine3<T>& affine, bool is_row_vector = true)
+{
+	mat4x4<T> mat = mat4x4<T>::identity;
+	for (size_t row = 0; row < 3; row++)
+	{
+		for (size_t col = 0; col < 3; col++)
+		{
+			mat.unchecked(row, col) = affine.linear.unchecked(row, col);
+		}
+	}
+	mat.unchecked(3, 0) = affine.translation.x; mat.unchecked(3, 1) = affine.translation.y; mat.unchecked(3, 2) = affine.translation.z;
+	return is_row_vector ? mat : mat.transpose();
+}
+
+template<class T>
+constexpr std::tuple<bool, affine3<T>> to_affine(const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	mat4x4<T> basis = is_row_vector ? mat : mat.transpose();
+	if (basis.unchecked(0, 3) != 0 || basis.unchecked(1, 3) != 0 || basis.unchecked(2, 3) != 0 || basis.unchecked(3, 3) != 1)
+	{
+		return { false, affine3<T>() };
+	}
+	affine3<T> affine;
+	for (size_t row = 0; row < 3; row++)
+	{
+		for (size_t col = 0; col < 3; col++)
+		{
+			affine.linear.unchecked(row, col) = basis.unchecked(row, col);
+		}
+	}
+	affine.translation = vec3<T>(basis.unchecked(3, 0), basis.unchecked(3, 1), basis.unchecked(3, 2));
+	return { true, affine };
+}
+
+//Array overloads run on the strided mat4x4 kernels of transform.hpp
+template<class T>
+inline void transform_points(const vec3<T>* points, vec3<T>* out, size_t count, const affine3<T>& affine)
+{
+	transform_points(points, out, count, to_mat4x4(affine));
+}
+
+template<class T>
+inline void transform_points(vec3<T>* points, size_t count, const affine3<T>& affine)
+{
+	transform_points(points, points, count, to_mat4x4(affine));
+}
+
+template<class T>
+inline void transform_directions(const vec3<T>* directions, vec3<T>* out, size_t count, const affine3<T>& affine)
+{
+	transform_directions(directions, out, count, to_mat4x4(affine));
+}
+
+template<class T>
+inline void transform_directions(vec3<T>* directions, size_t count, const affine3<T>& affine)
+{
+	transform_directions(directions, directions, count, to_mat4x4(affine));
+}
+
+#endif // !__AFFINE__
@@ -5,20 +5,20 @@
 
 #include <type_traits>
 
-#define PI 3.14159
+#define PI 3.14159265358979323846
 
 template<class T>
 T radian_to_degree(T radian)
 {
 	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
-	return radian / PI * 180.0;
+	return radian / static_cast<T>(PI) * static_cast<T>(180.0);
 }
 
 template<class T>
 T degree_to_radian(T degree)
 {
 	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
-	return degree / 180.0 * PI;
+	return degree / static_cast<T>(180.0) * static_cast<T>(PI);
 }
 
 #endif // !__ANGLE__
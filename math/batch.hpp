@@ -0,0 +1,202 @@
+#pragma once
+
+#ifndef __BATCH__
+#define __BATCH__
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+#include "dispatch.hpp"
+#include "parallel.hpp"
+
+/*
+	multiply
+	- out[i] = mats1[i] * mats2[i], out[i] = left * mats[i] or out[i] = mats[i] * right
+	- out may be the same array as an input array, the shared matrix is copied before the batch starts
+	- float batches run on the dispatched SIMD kernels, batches above PARALLEL_MATRIX_GRAIN are split across threads
+*/
+template<class T>
+inline void multiply(const mat4x4<T>* mats1, const mat4x4<T>* mats2, mat4x4<T>* out, size_t count)
+{
+	batch_multiply(mats1, mats2, out, count);
+}
+
+template<class T>
+inline void multiply(const mat4x4<T>& left, const mat4x4<T>* mats, mat4x4<T>* out, size_t count)
+{
+	mat4x4<T> shared = left;
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = shared * mats[i];
+		}
+	});
+}
+
+inline void multiply(const mat4x4<float>& left, const mat4x4<float>* mats, mat4x4<float>* out, size_t count)
+{
+	mat4x4<float> shared = left;
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().multiply_left_mat4x4f(shared.ptr(), mats[begin].ptr(), out[begin].ptr(), end - begin);
+	});
+}
+
+template<class T>
+inline void multiply(const mat4x4<T>* mats, const mat4x4<T>& right, mat4x4<T>* out, size_t count)
+{
+	mat4x4<T> shared = right;
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = mats[i] * shared;
+		}
+	});
+}
+
+inline void multiply(const mat4x4<float>* mats, const mat4x4<float>& right, mat4x4<float>* out, size_t count)
+{
+	mat4x4<float> shared = right;
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().multiply_right_mat4x4f(mats[begin].ptr(), shared.ptr(), out[begin].ptr(), end - begin);
+	});
+}
+
+/*
+	batch_inverse
+	- out[i] is the inverse of mats[i], singular matrices (|det| <= threshold) get identity as inverse() returns
+	- returns the number of singular matrices, bit i % 64 of singular_mask[i / 64] is set when mats[i] is singular
+	- singular_mask is optional and must hold (count + 63) / 64 words, it is cleared first
+	- float batches run 4 (SSE) or 8 (AVX2) matrices at a time, one matrix per SIMD lane
+*/
+template<class M, class T, class Kernel>
+inline size_t batch_inverse_parallel(const M* mats, M* out, size_t count, uint64_t* singular_mask, T threshold, Kernel kernel)
+{
+	if (singular_mask != nullptr)
+	{
+		for (size_t i = 0; i < (count + 63) / 64; i++)
+		{
+			singular_mask[i] = 0;
+		}
+	}
+	//PARALLEL_MATRIX_GRAIN is a multiple of 64, chunks never share a mask word
+	std::atomic<size_t> singular(0);
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		singular += kernel(mats->ptr(), out->ptr(), begin, end, threshold, singular_mask);
+	});
+	return singular;
+}
+
+template<class T>
+inline size_t batch_inverse(const mat4x4<T>* mats, mat4x4<T>* out, size_t count, uint64_t* singular_mask = nullptr, T threshold = FLOATING_POINT_THRESHOLD)
+{
+	return batch_inverse_parallel(mats, out, count, singular_mask, threshold, kernel_inverse_mat4x4_scalar<T>);
+}
+
+inline size_t batch_inverse(const mat4x4<float>* mats, mat4x4<float>* out, size_t count, uint64_t* singular_mask = nullptr, float threshold = FLOATING_POINT_THRESHOLD)
+{
+	return batch_inverse_parallel(mats, out, count, singular_mask, threshold, batch_kernels().inverse_mat4x4f);
+}
+
+template<class T>
+inline size_t batch_inverse(const mat3x3<T>* mats, mat3x3<T>* out, size_t count, uint64_t* singular_mask = nullptr, T threshold = FLOATING_POINT_THRESHOLD)
+{
+	return batch_inverse_parallel(mats, out, count, singular_mask, threshold, kernel_inverse_mat3x3_scalar<T>);
+}
+
+inline size_t batch_inverse(const mat3x3<float>* mats, mat3x3<float>* out, size_t count, uint64_t* singular_mask = nullptr, float threshold = FLOATING_POINT_THRESHOLD)
+{
+	return batch_inverse_parallel(mats, out, count, singular_mask, threshold, batch_kernels().inverse_mat3x3f);
+}
+
+/*
+	batch_det
+	- out[i] = mats[i].det()
+*/
+template<class T>
+inline void batch_det(const mat4x4<T>* mats, T* out, size_t count)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		kernel_det_mat4x4_scalar(mats->ptr(), out, begin, end);
+	});
+}
+
+inline void batch_det(const mat4x4<float>* mats, float* out, size_t count)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().det_mat4x4f(mats->ptr(), out, begin, end);
+	});
+}
+
+template<class T>
+inline void batch_det(const mat3x3<T>* mats, T* out, size_t count)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		kernel_det_mat3x3_scalar(mats->ptr(), out, begin, end);
+	});
+}
+
+inline void batch_det(const mat3x3<float>* mats, float* out, size_t count)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().det_mat3x3f(mats->ptr(), out, begin, end);
+	});
+}
+
+/*
+	mask_count / mask_indices
+	- read the uint64_t masks of the batch functions, bit i % 64 of mask[i / 64] stands for element i of count,
+	  bits past count must be clear
+	- mask_indices replaces indices with the set elements in increasing order, masks above PARALLEL_MATRIX_GRAIN
+	  elements are expanded across threads
+*/
+inline size_t mask_count(const uint64_t* mask, size_t count)
+{
+	size_t ret = 0;
+	for (size_t i = 0; i < (count + 63) / 64; i++)
+	{
+		ret += kernel_bit_count(mask[i]);
+	}
+	return ret;
+}
+
+inline void mask_indices(const uint64_t* mask, size_t count, std::vector<size_t>& indices)
+{
+	//Each chunk writes from the number of set bits before it
+	const size_t chunk_words = PARALLEL_MATRIX_GRAIN / 64;
+	size_t words = (count + 63) / 64;
+	std::vector<size_t> offsets((words + chunk_words - 1) / chunk_words + 1, 0);
+	for (size_t chunk = 0; chunk + 1 < offsets.size(); chunk++)
+	{
+		size_t first = chunk * chunk_words;
+		offsets[chunk + 1] = offsets[chunk] + mask_count(mask + first, (words - first < chunk_words ? words - first : chunk_words) * 64);
+	}
+	indices.resize(offsets.back());
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		size_t* out = indices.data() + offsets[begin / PARALLEL_MATRIX_GRAIN];
+		for (size_t i = begin / 64; i < (end + 63) / 64; i++)
+		{
+			for (uint64_t word = mask[i]; word != 0; word &= word - 1)
+			{
+				*out++ = i * 64 + kernel_bit_count((word & (~word + 1)) - 1);
+			}
+		}
+	});
+}
+
+//multiply(execution::seq, mats1, mats2, out, count) and so on, see execution_policy
+MATH_EXECUTION_OVERLOAD(multiply)
+MATH_EXECUTION_OVERLOAD(batch_inverse)
+MATH_EXECUTION_OVERLOAD(batch_det)
+
+#endif // !__BATCH__
@@ -0,0 +1,460 @@
+#pragma once
+
+#ifndef __BINARY__
+#define __BINARY__
+
+#include <cstring>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "soa.hpp"
+#include "view.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BINARY_VERSION 1
+//Written by the saving machine, a file from a machine of the other byte order reads back as 0x04030201
+#define BINARY_BYTE_ORDER 0x01020304
+
+enum class binary_type : uint32_t
+{
+	vec2 = 1,
+	vec3 = 2,
+	vec4 = 3,
+	mat3x3 = 4,
+	mat4x4 = 5
+};
+
+enum class binary_layout : uint32_t
+{
+	aos = 0,
+	soa = 1
+};
+
+/*
+	binary_header
+	- the first 64 bytes of a file, followed by zero padding up to data_offset
+	- aos: count packed elements, each component_size * dimension bytes (row- or column-major for matrices)
+	- soa: one column per component, column_stride bytes apart, each holding count components
+	- data_offset and column_stride are multiples of alignment
+*/
+struct binary_header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t byte_order;
+	binary_type type;
+	uint32_t component_size;
+	uint32_t dimension;
+	binary_layout layout;
+	uint32_t is_row_major;
+	uint64_t count;
+	uint64_t alignment;
+	uint64_t data_offset;
+	uint64_t column_stride;
+};
+
+static_assert(sizeof(binary_header) == 64, "binary_header must be 64 bytes!");
+
+template<class V>
+struct binary_traits;
+
+template<class T>
+struct binary_traits<vec2<T>>
+{
+	using value_type = T;
+	static const binary_type type = binary_type::vec2;
+	static const uint32_t dimension = 2;
+};
+
+template<class T>
+struct binary_traits<vec3<T>>
+{
+	using value_type = T;
+	static const binary_type type = binary_type::vec3;
+	static const uint32_t dimension = 3;
+};
+
+template<class T>
+struct binary_traits<vec4<T>>
+{
+	using value_type = T;
+	static const binary_type type = binary_type::vec4;
+	static const uint32_t dimension = 4;
+};
+
+template<class T>
+struct binary_traits<mat3x3<T>>
+{
+	using value_type = T;
+	static const binary_type type = binary_type::mat3x3;
+	static const uint32_t dimension = 9;
+};
+
+template<class T>
+struct binary_traits<mat4x4<T>>
+{
+	using value_type = T;
+	static const binary_type type = binary_type::mat4x4;
+	static const uint32_t dimension = 16;
+};
+
+//Components of one element of type, 0 for an unknown type
+inline uint32_t binary_dimension(binary_type type)
+{
+	switch (type)
+	{
+	case binary_type::vec2: return 2;
+	case binary_type::vec3: return 3;
+	case binary_type::vec4: return 4;
+	case binary_type::mat3x3: return 9;
+	case binary_type::mat4x4: return 16;
+	default: return 0;
+	}
+}
+
+inline uint64_t binary_align(uint64_t size, uint64_t alignment)
+{
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+template<class V>
+inline binary_header make_binary_header(size_t count, binary_layout layout, bool is_row_major, size_t alignment)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) { throw std::invalid_argument("alignment must be a power of two!"); }
+	using T = typename binary_traits<V>::value_type;
+	binary_header header = {};
+	memcpy(header.magic, "MATH", 4);
+	header.version = BINARY_VERSION;
+	header.byte_order = BINARY_BYTE_ORDER;
+	header.type = binary_traits<V>::type;
+	header.component_size = sizeof(T);
+	header.dimension = binary_traits<V>::dimension;
+	header.layout = layout;
+	header.is_row_major = is_row_major ? 1 : 0;
+	header.count = count;
+	header.alignment = alignment;
+	header.data_offset = binary_align(sizeof(binary_header), alignment);
+	header.column_stride = layout == binary_layout::soa ? binary_align(count * sizeof(T), alignment) : 0;
+	return header;
+}
+
+/*
+	binary_writer
+	- buffered FILE* output used by save_binary, throws std::runtime_error on any I/O failure
+*/
+class binary_writer
+{
+private:
+	FILE* file;
+
+public:
+	explicit binary_writer(const std::string& path) : file(nullptr)
+	{
+#if defined(_MSC_VER)
+		if (fopen_s(&file, path.c_str(), "wb") != 0) { file = nullptr; }
+#else
+		file = fopen(path.c_str(), "wb");
+#endif
+		if (file == nullptr) { throw std::runtime_error("failed to open the file!"); }
+	}
+
+	binary_writer(const binary_writer&) = delete;
+	binary_writer& operator=(const binary_writer&) = delete;
+
+	~binary_writer()
+	{
+		if (file != nullptr)
+		{
+			fclose(file);
+		}
+	}
+
+	void write(const void* data, size_t size)
+	{
+		if (size > 0 && fwrite(data, 1, size, file) != size) { throw std::runtime_error("failed to write the file!"); }
+	}
+
+	void pad(size_t size)
+	{
+		static const char zeros[64] = {};
+		while (size > 0)
+		{
+			size_t chunk = size < sizeof(zeros) ? size : sizeof(zeros);
+			write(zeros, chunk);
+			size -= chunk;
+		}
+	}
+
+	void close()
+	{
+		int result = fclose(file);
+		file = nullptr;
+		if (result != 0) { throw std::runtime_error("failed to write the file!"); }
+	}
+};
+
+/*
+	save_binary
+	- writes count vectors or matrices as a packed AoS file, matrices are transposed when is_output_row_major is false
+	- vec3_soa / vec4_soa containers are written as SoA columns
+	- alignment is the payload and column alignment the mapped data gets, at least the alignment of the component type
+*/
+template<class V>
+inline void save_binary(const std::string& path, const V* values, size_t count, bool is_output_row_major = true, size_t alignment = SOA_ALIGNMENT)
+{
+	binary_header header = make_binary_header<V>(count, binary_layout::aos, is_output_row_major, alignment);
+	binary_writer writer(path);
+	writer.write(&header, sizeof(header));
+	writer.pad(header.data_offset - sizeof(header));
+	if constexpr (binary_traits<V>::type >= binary_type::mat3x3)
+	{
+		if (!is_output_row_major)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				V transposed = values[i].transpose();
+				writer.write(&transposed, sizeof(V));
+			}
+			writer.close();
+			return;
+		}
+	}
+	writer.write(values, count * sizeof(V));
+	writer.close();
+}
+
+template<class S>
+inline void save_binary_soa(const std::string& path, const S& vecs, size_t alignment)
+{
+	using T = typename S::value_type;
+	using V = typename std::conditional<S::dimension == 3, vec3<T>, vec4<T>>::type;
+	binary_header header = make_binary_header<V>(vecs.size(), binary_layout::soa, true, alignment);
+	binary_writer writer(path);
+	writer.write(&header, sizeof(header));
+	writer.pad(header.data_offset - sizeof(header));
+	for (size_t c = 0; c < S::dimension; c++)
+	{
+		writer.write(vecs.component(c).data(), vecs.size() * sizeof(T));
+		writer.pad(header.column_stride - vecs.size() * sizeof(T));
+	}
+	writer.close();
+}
+
+template<class T>
+inline void save_binary(const std::string& path, const vec3_soa<T>& vecs, size_t alignment = SOA_ALIGNMENT)
+{
+	save_binary_soa(path, vecs, alignment);
+}
+
+template<class T>
+inline void save_binary(const std::string& path, const vec4_soa<T>& vecs, size_t alignment = SOA_ALIGNMENT)
+{
+	save_binary_soa(path, vecs, alignment);
+}
+
+/*
+	binary_file
+	- maps a file written by save_binary read-only, nothing is read or copied until the data is touched
+	- view<V>() is a zero-copy view of an AoS file, column<T>(c) points at a SoA column
+	- throws std::runtime_error when the file cannot be mapped or its header is not valid: an unknown type or layout,
+	  a dimension other than the one of its type or a payload past the end of the file,
+	  std::invalid_argument when the requested type or layout does not match the header
+	- views and columns are valid while the binary_file is alive
+*/
+class binary_file
+{
+private:
+	const char* base;
+	size_t bytes;
+
+public:
+	explicit binary_file(const std::string& path) : base(nullptr), bytes(0)
+	{
+		map(path);
+		try
+		{
+			validate();
+		}
+		catch (...)
+		{
+			unmap();
+			throw;
+		}
+	}
+
+	binary_file(binary_file&& file) noexcept : base(file.base), bytes(file.bytes)
+	{
+		file.base = nullptr;
+		file.bytes = 0;
+	}
+
+	binary_file& operator=(binary_file&& file) noexcept
+	{
+		if (this != &file)
+		{
+			unmap();
+			std::swap(base, file.base);
+			std::swap(bytes, file.bytes);
+		}
+		return *this;
+	}
+
+	binary_file(const binary_file&) = delete;
+	binary_file& operator=(const binary_file&) = delete;
+
+	~binary_file()
+	{
+		unmap();
+	}
+
+public:
+	const binary_header& header() const
+	{
+		return *reinterpret_cast<const binary_header*>(base);
+	}
+
+	size_t size() const
+	{
+		return static_cast<size_t>(header().count);
+	}
+
+	const void* data() const
+	{
+		return base + header().data_offset;
+	}
+
+	//Matrices must have been saved row-major, column-major payloads are left to data()
+	template<class V>
+	strided_view<const V> view() const
+	{
+		check_type<V>(binary_layout::aos);
+		if (binary_traits<V>::type >= binary_type::mat3x3 && header().is_row_major == 0) { throw std::invalid_argument("binary file holds column-major matrices!"); }
+		return strided_view<const V>(static_cast<const V*>(data()), size());
+	}
+
+	template<class T>
+	const T* column(size_t component) const
+	{
+		if (header().layout != binary_layout::soa || header().component_size != sizeof(T)) { throw std::invalid_argument("binary file does not hold SoA columns of this type!"); }
+		MATH_CHECK_INDEX(component >= header().dimension, "binary_file column out of range!");
+		return reinterpret_cast<const T*>(base + header().data_offset + component * header().column_stride);
+	}
+
+private:
+	template<class V>
+	void check_type(binary_layout layout) const
+	{
+		const binary_header& h = header();
+		if (h.type != binary_traits<V>::type || h.dimension != binary_traits<V>::dimension ||
+			h.component_size != sizeof(typename binary_traits<V>::value_type) || h.layout != layout)
+		{
+			throw std::invalid_argument("binary file does not hold this type!");
+		}
+	}
+
+	void validate() const
+	{
+		if (bytes < sizeof(binary_header)) { throw std::runtime_error("binary file is truncated!"); }
+		const binary_header& h = header();
+		if (memcmp(h.magic, "MATH", 4) != 0) { throw std::runtime_error("not a binary math file!"); }
+		if (h.byte_order != BINARY_BYTE_ORDER) { throw std::runtime_error("binary file has the other byte order!"); }
+		if (h.version != BINARY_VERSION) { throw std::runtime_error("unsupported binary file version!"); }
+		if (binary_dimension(h.type) == 0 || h.dimension != binary_dimension(h.type) || h.component_size == 0 ||
+			(h.layout != binary_layout::aos && h.layout != binary_layout::soa) ||
+			h.alignment == 0 || (h.alignment & (h.alignment - 1)) != 0 || h.data_offset % h.alignment != 0 || h.data_offset < sizeof(binary_header))
+		{
+			throw std::runtime_error("binary file header is corrupt!");
+		}
+		uint64_t element = static_cast<uint64_t>(h.component_size) * h.dimension;
+		uint64_t available = bytes - (h.data_offset < bytes ? h.data_offset : bytes);
+		uint64_t payload;
+		if (h.layout == binary_layout::aos)
+		{
+			if (h.count > available / element) { throw std::runtime_error("binary file is truncated!"); }
+			payload = h.count * element;
+		}
+		else
+		{
+			if (h.column_stride % h.alignment != 0 || h.count > h.column_stride / h.component_size) { throw std::runtime_error("binary file header is corrupt!"); }
+			if (h.column_stride > 0 && h.dimension > available / h.column_stride) { throw std::runtime_error("binary file is truncated!"); }
+			payload = h.column_stride * h.dimension;
+		}
+		if (h.data_offset + payload > bytes) { throw std::runtime_error("binary file is truncated!"); }
+	}
+
+#if defined(_WIN32)
+	void map(const std::string& path)
+	{
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) { throw std::runtime_error("failed to open the file!"); }
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			throw std::runtime_error("binary file is truncated!");
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr) { throw std::runtime_error("failed to map the file!"); }
+		//The view keeps the mapping alive
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view == nullptr) { throw std::runtime_error("failed to map the file!"); }
+		base = static_cast<const char*>(view);
+		bytes = static_cast<size_t>(size.QuadPart);
+	}
+
+	void unmap()
+	{
+		if (base != nullptr)
+		{
+			UnmapViewOfFile(base);
+		}
+		base = nullptr;
+		bytes = 0;
+	}
+#else
+	void map(const std::string& path)
+	{
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0) { throw std::runtime_error("failed to open the file!"); }
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			::close(file);
+			throw std::runtime_error("binary file is truncated!");
+		}
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (view == MAP_FAILED) { throw std::runtime_error("failed to map the file!"); }
+		base = static_cast<const char*>(view);
+		bytes = static_cast<size_t>(info.st_size);
+	}
+
+	void unmap()
+	{
+		if (base != nullptr)
+		{
+			munmap(const_cast<char*>(base), bytes);
+		}
+		base = nullptr;
+		bytes = 0;
+	}
+#endif
+};
+
+#endif // !__BINARY__
@@ -0,0 +1,622 @@
+#pragma once
+
+#ifndef __BVH__
+#define __BVH__
+
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "aabb.hpp"
+#include "parallel.hpp"
+#include "batch.hpp"
+
+//Centroid bins per axis of the binned SAH split
+#define BVH_BINS 16
+#define BVH_LEAF_SIZE 4
+//Deepest node of a bvh, past half of it nodes are split at the centroid median
+#define BVH_MAX_DEPTH 64
+
+template<class T>
+class bvh;
+
+using bvhf = bvh<float>;
+using bvhd = bvh<double>;
+using bvhld = bvh<long double>;
+
+/*
+	bvh_node
+	- a leaf holds count > 0 primitives, bvh::primitive(offset) to bvh::primitive(offset + count - 1)
+	- an interior node has count 0, its first child is the next node and offset is the index of its second child
+*/
+template<class T>
+struct bvh_node
+{
+	aabb3<T> bounds;
+	uint32_t offset;
+	uint32_t count;
+
+	bool is_leaf() const
+	{
+		return count != 0;
+	}
+};
+
+/*
+	bvh
+	- a bounding volume hierarchy over primitive boxes or triangles, built top-down with a binned surface area heuristic
+	- nodes are stored depth-first in one array, a node and its first child are adjacent
+	- nodes above PARALLEL_GRAIN primitives bin their centroids across threads, the subtrees below are built in parallel
+	- refit recomputes the bounds after the primitives moved and keeps the topology, the tree degrades as they move away
+	  from the layout it was built for
+	- triangles are 3 indices per triangle into vertices, or nullptr for a triangle soup where triangle i is
+	  vertices[3 * i] to vertices[3 * i + 2]
+	- throws std::length_error above 2^32 - 1 primitives
+*/
+template<class T>
+class bvh
+{
+private:
+	struct bin
+	{
+		aabb3<T> bounds;
+		size_t count = 0;
+	};
+
+	//Partitioned together with the index so that every pass over a node reads memory in order
+	struct build_primitive
+	{
+		aabb3<T> bounds;
+		vec3<T> centroid;
+		uint32_t index;
+	};
+
+	struct build_state
+	{
+		std::vector<build_primitive> primitives;
+		size_t leaf_size;
+	};
+
+	std::vector<bvh_node<T>> nodes;
+	std::vector<uint32_t> indices;
+	size_t max_depth;
+
+public:
+	bvh() : max_depth(0)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of bvh must be a floating-point type!");
+	}
+
+public:
+	size_t node_count() const
+	{
+		return nodes.size();
+	}
+
+	size_t primitive_count() const
+	{
+		return indices.size();
+	}
+
+	size_t depth() const
+	{
+		return max_depth;
+	}
+
+	const bvh_node<T>& node(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= nodes.size(), "bvh node index out of range!");
+		return nodes[index];
+	}
+
+	//Primitive at position index of the leaf ordering
+	size_t primitive(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= indices.size(), "bvh primitive index out of range!");
+		return indices[index];
+	}
+
+	aabb3<T> bounds() const
+	{
+		return nodes.empty() ? aabb3<T>() : nodes[0].bounds;
+	}
+
+	void build(const aabb3<T>* bounds, size_t count, size_t leaf_size = BVH_LEAF_SIZE)
+	{
+		build_from(count, leaf_size, [&](size_t i) { return bounds[i]; });
+	}
+
+	void build(const vec3<T>* vertices, const size_t* triangles, size_t triangle_count, size_t leaf_size = BVH_LEAF_SIZE)
+	{
+		build_from(triangle_count, leaf_size, [&](size_t i) { return triangle_bounds(vertices, triangles, i); });
+	}
+
+	void refit(const aabb3<T>* bounds)
+	{
+		refit_from([&](size_t i) { return bounds[i]; });
+	}
+
+	void refit(const vec3<T>* vertices, const size_t* triangles)
+	{
+		refit_from([&](size_t i) { return triangle_bounds(vertices, triangles, i); });
+	}
+
+	//Appends the primitives of the leaves overlapping box to out, a superset of the primitives overlapping it
+	void query(const aabb3<T>& box, std::vector<size_t>& out) const
+	{
+		if (nodes.empty() || !nodes[0].bounds.intersects(box))
+		{
+			return;
+		}
+		uint32_t stack[BVH_MAX_DEPTH];
+		size_t top = 0;
+		uint32_t index = 0;
+		for (;;)
+		{
+			const bvh_node<T>& node = nodes[index];
+			if (node.is_leaf())
+			{
+				for (uint32_t k = node.offset; k < node.offset + node.count; k++)
+				{
+					out.push_back(indices[k]);
+				}
+			}
+			else
+			{
+				bool hit_first = nodes[index + 1].bounds.intersects(box);
+				bool hit_second = nodes[node.offset].bounds.intersects(box);
+				if (hit_first)
+				{
+					if (hit_second) { stack[top++] = node.offset; }
+					index++;
+					continue;
+				}
+				if (hit_second)
+				{
+					index = node.offset;
+					continue;
+				}
+			}
+			if (top == 0)
+			{
+				return;
+			}
+			index = stack[--top];
+		}
+	}
+
+	/*
+		traverse_ray / traverse_ray_leaves
+		- visit the leaves the ray origin + t * direction, 0 <= t <= t_max enters, the nearer child first
+		- traverse_ray calls func(primitive, t_max) for every primitive of those leaves, traverse_ray_leaves calls
+		  func(offset, count, t_max) once per leaf with its range in the leaf ordering of primitive()
+		- func returns the new t_max: a closer hit returns its distance so farther nodes are skipped,
+		  returning t_max visits every candidate
+	*/
+	template<class F>
+	void traverse_ray(vec3<T> origin, vec3<T> direction, T t_max, F func) const
+	{
+		traverse_ray_leaves(origin, direction, t_max, [&](size_t offset, size_t count, T leaf_t_max)
+		{
+			for (size_t k = offset; k < offset + count; k++)
+			{
+				leaf_t_max = func(static_cast<size_t>(indices[k]), leaf_t_max);
+			}
+			return leaf_t_max;
+		});
+	}
+
+	template<class F>
+	void traverse_ray_leaves(vec3<T> origin, vec3<T> direction, T t_max, F func) const
+	{
+		if (nodes.empty())
+		{
+			return;
+		}
+		vec3<T> inverse_direction(static_cast<T>(1.0) / direction.x, static_cast<T>(1.0) / direction.y, static_cast<T>(1.0) / direction.z);
+		std::tuple<bool, T> root = nodes[0].bounds.intersect_ray(origin, inverse_direction, 0, t_max);
+		if (!std::get<0>(root))
+		{
+			return;
+		}
+		uint32_t stack[BVH_MAX_DEPTH];
+		T stack_enter[BVH_MAX_DEPTH];
+		size_t top = 0;
+		uint32_t index = 0;
+		for (;;)
+		{
+			const bvh_node<T>& node = nodes[index];
+			if (node.is_leaf())
+			{
+				t_max = func(static_cast<size_t>(node.offset), static_cast<size_t>(node.count), t_max);
+			}
+			else
+			{
+				std::tuple<bool, T> first = nodes[index + 1].bounds.intersect_ray(origin, inverse_direction, 0, t_max);
+				std::tuple<bool, T> second = nodes[node.offset].bounds.intersect_ray(origin, inverse_direction, 0, t_max);
+				if (std::get<0>(first) && std::get<0>(second))
+				{
+					bool is_first_near = std::get<1>(first) <= std::get<1>(second);
+					stack[top] = is_first_near ? node.offset : index + 1;
+					stack_enter[top++] = is_first_near ? std::get<1>(second) : std::get<1>(first);
+					index = is_first_near ? index + 1 : node.offset;
+					continue;
+				}
+				if (std::get<0>(first) || std::get<0>(second))
+				{
+					index = std::get<0>(first) ? index + 1 : node.offset;
+					continue;
+				}
+			}
+			//Nodes pushed before a closer hit was found may now lie beyond t_max
+			do
+			{
+				if (top == 0)
+				{
+					return;
+				}
+				top--;
+			} while (stack_enter[top] > t_max);
+			index = stack[top];
+		}
+	}
+
+private:
+	static aabb3<T> triangle_bounds(const vec3<T>* vertices, const size_t* triangles, size_t i)
+	{
+		aabb3<T> box;
+		for (size_t k = 0; k < 3; k++)
+		{
+			box.expand(vertices[triangles != nullptr ? triangles[i * 3 + k] : i * 3 + k]);
+		}
+		return box;
+	}
+
+	template<class F>
+	void build_from(size_t count, size_t leaf_size, F primitive_bounds)
+	{
+		if (count > static_cast<size_t>(UINT32_MAX)) { throw std::length_error("bvh primitive count too large!"); }
+		nodes.clear();
+		indices.resize(count);
+		max_depth = 0;
+		if (count == 0)
+		{
+			return;
+		}
+
+		build_state state;
+		state.primitives.resize(count);
+		//Nodes above PARALLEL_GRAIN primitives are always split by build_top, so a leaf never holds more
+		state.leaf_size = leaf_size > 0 ? (leaf_size < PARALLEL_GRAIN ? leaf_size : PARALLEL_GRAIN) : 1;
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				aabb3<T> bounds = primitive_bounds(i);
+				state.primitives[i] = { bounds, bounds.center(), static_cast<uint32_t>(i) };
+			}
+		});
+
+		//Top levels split in place, a node of at most PARALLEL_GRAIN primitives becomes a subtree job
+		struct job
+		{
+			size_t begin, end, depth;
+			std::vector<bvh_node<T>> nodes;
+			size_t max_depth;
+		};
+		std::vector<job> jobs;
+		std::vector<bvh_node<T>> top;
+		std::vector<uint8_t> is_job;
+		build_top(state, top, is_job, jobs, 0, count, 0);
+		parallel_for(jobs.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				jobs[i].max_depth = build_subtree(state, jobs[i].nodes, jobs[i].begin, jobs[i].end, jobs[i].depth);
+			}
+		});
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				indices[i] = state.primitives[i].index;
+			}
+		});
+
+		//Each job placeholder of the top nodes expands to its subtree
+		std::vector<size_t> positions(top.size());
+		size_t size = 0;
+		for (size_t i = 0; i < top.size(); i++)
+		{
+			positions[i] = size;
+			size += is_job[i] != 0 ? jobs[top[i].offset].nodes.size() : 1;
+		}
+		nodes.resize(size);
+		for (size_t i = 0; i < top.size(); i++)
+		{
+			if (is_job[i] == 0)
+			{
+				nodes[positions[i]] = top[i];
+				nodes[positions[i]].offset = static_cast<uint32_t>(positions[top[i].offset]);
+				continue;
+			}
+			job& subtree = jobs[top[i].offset];
+			max_depth = subtree.max_depth > max_depth ? subtree.max_depth : max_depth;
+			for (size_t k = 0; k < subtree.nodes.size(); k++)
+			{
+				bvh_node<T> node = subtree.nodes[k];
+				if (!node.is_leaf())
+				{
+					node.offset += static_cast<uint32_t>(positions[i]);
+				}
+				nodes[positions[i] + k] = node;
+			}
+		}
+	}
+
+	template<class Job>
+	void build_top(build_state& state, std::vector<bvh_node<T>>& top, std::vector<uint8_t>& is_job, std::vector<Job>& jobs, size_t begin, size_t end, size_t depth)
+	{
+		size_t index = top.size();
+		top.push_back(bvh_node<T>());
+		is_job.push_back(1);
+		top[index].offset = static_cast<uint32_t>(jobs.size());
+		if (end - begin <= PARALLEL_GRAIN)
+		{
+			jobs.push_back(Job{ begin, end, depth, std::vector<bvh_node<T>>(), 0 });
+			return;
+		}
+		aabb3<T> bounds, centroid_bounds;
+		range_bounds(state, begin, end, bounds, centroid_bounds, true);
+		size_t middle = split(state, begin, end, centroid_bounds, depth, true);
+		if (middle == begin || middle == end)
+		{
+			//No split, the subtree job makes the node a leaf
+			jobs.push_back(Job{ begin, end, depth, std::vector<bvh_node<T>>(), 0 });
+			return;
+		}
+		is_job[index] = 0;
+		top[index].bounds = bounds;
+		top[index].count = 0;
+		build_top(state, top, is_job, jobs, begin, middle, depth + 1);
+		top[index].offset = static_cast<uint32_t>(top.size());
+		build_top(state, top, is_job, jobs, middle, end, depth + 1);
+	}
+
+	//Returns the depth of the deepest node
+	size_t build_subtree(build_state& state, std::vector<bvh_node<T>>& out, size_t begin, size_t end, size_t depth)
+	{
+		size_t index = out.size();
+		out.push_back(bvh_node<T>());
+		aabb3<T> bounds, centroid_bounds;
+		range_bounds(state, begin, end, bounds, centroid_bounds, false);
+		out[index].bounds = bounds;
+		size_t middle = split(state, begin, end, centroid_bounds, depth, false);
+		if (middle == begin)
+		{
+			out[index].offset = static_cast<uint32_t>(begin);
+			out[index].count = static_cast<uint32_t>(end - begin);
+			return depth;
+		}
+		out[index].count = 0;
+		size_t first_depth = build_subtree(state, out, begin, middle, depth + 1);
+		out[index].offset = static_cast<uint32_t>(out.size());
+		size_t second_depth = build_subtree(state, out, middle, end, depth + 1);
+		return first_depth > second_depth ? first_depth : second_depth;
+	}
+
+	void range_bounds(const build_state& state, size_t begin, size_t end, aabb3<T>& bounds, aabb3<T>& centroid_bounds, bool is_parallel)
+	{
+		if (!is_parallel)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				bounds.expand(state.primitives[i].bounds);
+				centroid_bounds.expand(state.primitives[i].centroid);
+			}
+			return;
+		}
+		size_t chunks = (end - begin + PARALLEL_MATRIX_GRAIN - 1) / PARALLEL_MATRIX_GRAIN;
+		std::vector<aabb3<T>> chunk_bounds(chunks), chunk_centroids(chunks);
+		parallel_for(end - begin, PARALLEL_MATRIX_GRAIN, [&](size_t chunk_begin, size_t chunk_end)
+		{
+			size_t chunk = chunk_begin / PARALLEL_MATRIX_GRAIN;
+			range_bounds(state, begin + chunk_begin, begin + chunk_end, chunk_bounds[chunk], chunk_centroids[chunk], false);
+		});
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+		{
+			bounds.expand(chunk_bounds[chunk]);
+			centroid_bounds.expand(chunk_centroids[chunk]);
+		}
+	}
+
+	/*
+		split
+		- partitions [begin, end) and returns the start of the second child, or begin for a leaf
+		- the SAH cost of a split is 1 + (area(first) * count(first) + area(second) * count(second)) / area(node),
+		  a node of at most leaf_size primitives becomes a leaf when no split costs less than its count
+	*/
+	size_t split(build_state& state, size_t begin, size_t end, const aabb3<T>& centroid_bounds, size_t depth, bool is_parallel)
+	{
+		size_t count = end - begin;
+		if (count <= 1)
+		{
+			return begin;
+		}
+		vec3<T> extent = centroid_bounds.size();
+		size_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		if (extent.unchecked(axis) <= 0)
+		{
+			//Every centroid is the same point, no plane separates them
+			return count <= state.leaf_size ? begin : begin + count / 2;
+		}
+		if (depth >= BVH_MAX_DEPTH / 2)
+		{
+			return split_median(state, begin, end, axis);
+		}
+
+		//Nodes of few primitives use fewer bins
+		size_t bin_count = count < BVH_BINS ? count : BVH_BINS;
+		bin bins[3][BVH_BINS];
+		bin_centroids(state, begin, end, centroid_bounds, bin_count, bins, is_parallel);
+
+		T best_cost = std::numeric_limits<T>::infinity();
+		size_t best_axis = 0, best_bin = 0;
+		for (size_t a = 0; a < 3; a++)
+		{
+			if (extent.unchecked(a) <= 0)
+			{
+				continue;
+			}
+			//Area and count of bins [k, bin_count) for the second child of the split before bin k
+			T second_area[BVH_BINS];
+			size_t second_count[BVH_BINS];
+			aabb3<T> box;
+			size_t sum = 0;
+			for (size_t k = bin_count - 1; k > 0; k--)
+			{
+				box.expand(bins[a][k].bounds);
+				sum += bins[a][k].count;
+				second_area[k] = box.surface_area();
+				second_count[k] = sum;
+			}
+			box = aabb3<T>();
+			sum = 0;
+			for (size_t k = 1; k < bin_count; k++)
+			{
+				box.expand(bins[a][k - 1].bounds);
+				sum += bins[a][k - 1].count;
+				if (sum == 0 || second_count[k] == 0)
+				{
+					continue;
+				}
+				T cost = box.surface_area() * static_cast<T>(sum) + second_area[k] * static_cast<T>(second_count[k]);
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = a;
+					best_bin = k;
+				}
+			}
+		}
+
+		aabb3<T> node_bounds;
+		for (size_t k = 0; k < bin_count; k++)
+		{
+			node_bounds.expand(bins[0][k].bounds);
+		}
+		T node_area = node_bounds.surface_area();
+		bool is_split_cheaper = node_area > 0 && 1 + best_cost / node_area < static_cast<T>(count);
+		if (best_cost == std::numeric_limits<T>::infinity() || (!is_split_cheaper && count <= state.leaf_size))
+		{
+			return best_cost == std::numeric_limits<T>::infinity() && count > state.leaf_size ? split_median(state, begin, end, axis) : begin;
+		}
+
+		T low = centroid_bounds.min.unchecked(best_axis), scale = bin_scale(extent.unchecked(best_axis), bin_count);
+		auto middle = std::partition(state.primitives.begin() + begin, state.primitives.begin() + end, [&](const build_primitive& primitive)
+		{
+			return bin_index(primitive.centroid.unchecked(best_axis), low, scale, bin_count) < best_bin;
+		});
+		return static_cast<size_t>(middle - state.primitives.begin());
+	}
+
+	size_t split_median(build_state& state, size_t begin, size_t end, size_t axis)
+	{
+		size_t middle = begin + (end - begin) / 2;
+		std::nth_element(state.primitives.begin() + begin, state.primitives.begin() + middle, state.primitives.begin() + end,
+			[&](const build_primitive& primitive1, const build_primitive& primitive2)
+		{
+			return primitive1.centroid.unchecked(axis) < primitive2.centroid.unchecked(axis);
+		});
+		return middle;
+	}
+
+	static T bin_scale(T extent, size_t bin_count)
+	{
+		return static_cast<T>(bin_count) * (1 - static_cast<T>(1e-4)) / extent;
+	}
+
+	static size_t bin_index(T centroid, T low, T scale, size_t bin_count)
+	{
+		size_t index = static_cast<size_t>((centroid - low) * scale);
+		return index < bin_count ? index : bin_count - 1;
+	}
+
+	void bin_centroids(const build_state& state, size_t begin, size_t end, const aabb3<T>& centroid_bounds, size_t bin_count, bin (&bins)[3][BVH_BINS], bool is_parallel)
+	{
+		vec3<T> extent = centroid_bounds.size();
+		T scales[3];
+		for (size_t a = 0; a < 3; a++)
+		{
+			scales[a] = extent.unchecked(a) > 0 ? bin_scale(extent.unchecked(a), bin_count) : 0;
+		}
+		if (!is_parallel)
+		{
+			bin_range(state, begin, end, centroid_bounds.min, scales, bin_count, &bins[0][0]);
+			return;
+		}
+		size_t chunks = (end - begin + PARALLEL_MATRIX_GRAIN - 1) / PARALLEL_MATRIX_GRAIN;
+		std::vector<bin> chunk_bins(chunks * 3 * BVH_BINS);
+		parallel_for(end - begin, PARALLEL_MATRIX_GRAIN, [&](size_t chunk_begin, size_t chunk_end)
+		{
+			bin_range(state, begin + chunk_begin, begin + chunk_end, centroid_bounds.min, scales, bin_count, chunk_bins.data() + chunk_begin / PARALLEL_MATRIX_GRAIN * 3 * BVH_BINS);
+		});
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+		{
+			for (size_t k = 0; k < 3 * BVH_BINS; k++)
+			{
+				const bin& local = chunk_bins[chunk * 3 * BVH_BINS + k];
+				bins[k / BVH_BINS][k % BVH_BINS].bounds.expand(local.bounds);
+				bins[k / BVH_BINS][k % BVH_BINS].count += local.count;
+			}
+		}
+	}
+
+	//bins holds the BVH_BINS bins of x, then of y, then of z
+	void bin_range(const build_state& state, size_t begin, size_t end, vec3<T> low, const T* scales, size_t bin_count, bin* bins)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const build_primitive& primitive = state.primitives[i];
+			for (size_t a = 0; a < 3; a++)
+			{
+				bin& target = bins[a * BVH_BINS + bin_index(primitive.centroid.unchecked(a), low.unchecked(a), scales[a], bin_count)];
+				target.bounds.expand(primitive.bounds);
+				target.count++;
+			}
+		}
+	}
+
+	//Leaves are refit in parallel, interior nodes from the last to the first as children come after their parent
+	template<class F>
+	void refit_from(F primitive_bounds)
+	{
+		parallel_for(nodes.size(), PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				bvh_node<T>& node = nodes[i];
+				if (!node.is_leaf())
+				{
+					continue;
+				}
+				aabb3<T> box;
+				for (uint32_t k = node.offset; k < node.offset + node.count; k++)
+				{
+					box.expand(primitive_bounds(indices[k]));
+				}
+				node.bounds = box;
+			}
+		});
+		for (size_t i = nodes.size(); i-- > 0;)
+		{
+			if (!nodes[i].is_leaf())
+			{
+				nodes[i].bounds = merge(nodes[i + 1].bounds, nodes[nodes[i].offset].bounds);
+			}
+		}
+	}
+};
+
+#endif // !__BVH__
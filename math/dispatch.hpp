@@ -0,0 +1,431 @@
+#pragma once
+
+#ifndef __DISPATCH__
+#define __DISPATCH__
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "kernels.hpp"
+#include "parallel.hpp"
+
+#if defined(MATH_SSE2)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+/*
+	simd_tier
+	- ordered, a tier implies every tier before it
+	- the environment variable MATH_SIMD_TIER (scalar, sse2, sse41, avx2, avx512) caps the detected tier
+*/
+enum class simd_tier
+{
+	scalar = 0,
+	sse2 = 1,
+	sse41 = 2,
+	avx2 = 3,
+	avx512 = 4
+};
+
+struct cpu_features
+{
+	bool sse2 = false;
+	bool sse41 = false;
+	bool avx = false;
+	bool avx2 = false;
+	bool fma = false;
+	bool avx512f = false;
+};
+
+struct batch_kernel_table
+{
+	simd_tier tier;
+	void(*transform_vec4f)(const float* in, float* out, size_t count, const float* mat, bool is_row_vector);
+	void(*transform_vec3f)(const char* in, size_t in_stride, char* out, size_t out_stride, size_t count, const float* basis, float w, bool perspective_divide);
+	void(*normalize_vec4f)(float* data, size_t count);
+	void(*dot_vec4f)(const float* vecs1, const float* vecs2, float* out, size_t count);
+	void(*multiply_mat4x4f)(const float* mats1, const float* mats2, float* out, size_t count);
+	void(*multiply_left_mat4x4f)(const float* left, const float* mats, float* out, size_t count);
+	void(*multiply_right_mat4x4f)(const float* mats, const float* right, float* out, size_t count);
+	size_t(*inverse_mat4x4f)(const float* mats, float* out, size_t begin, size_t end, float threshold, uint64_t* singular_mask);
+	void(*det_mat4x4f)(const float* mats, float* out, size_t begin, size_t end);
+	size_t(*inverse_mat3x3f)(const float* mats, float* out, size_t begin, size_t end, float threshold, uint64_t* singular_mask);
+	void(*det_mat3x3f)(const float* mats, float* out, size_t begin, size_t end);
+	void(*multiply_quatf)(const float* quats1, const float* quats2, float* out, size_t count);
+	void(*rotate_quatf)(const float* quats, size_t quat_step, const float* vecs, float* out, size_t count);
+	void(*normalize_quatf)(float* quats, size_t count);
+	void(*nlerp_quatf)(const float* quats1, const float* quats2, const float* t, size_t t_step, float* out, size_t count);
+	void(*to_mat4x4_quatf)(const float* quats, float* out, size_t count, bool is_row_vector);
+	void(*rsqrtf)(const float* in, float* out, size_t count);
+	void(*fast_length_soaf)(const float* const* components, size_t dimension, float* out, size_t count);
+	void(*fast_normalize_soaf)(float* const* components, size_t dimension, size_t count);
+	void(*elementary_sincosf)(const float* radians, float* sin_out, float* cos_out, size_t count, elementary_accuracy accuracy);
+	void(*elementary_atan2f)(const float* y, const float* x, float* out, size_t count, elementary_accuracy accuracy);
+	void(*elementary_acosf)(const float* in, float* out, size_t count, elementary_accuracy accuracy);
+	size_t(*cull_spheresf)(const float* planes, const float* const* spheres, size_t begin, size_t end, uint64_t* visible_mask);
+	size_t(*cull_boxesf)(const float* planes, const float* const* boxes, size_t begin, size_t end, uint64_t* visible_mask);
+	void(*intersect_trianglesf)(const float* ray, const float* const* triangles, size_t begin, size_t end, float t_min, float* hit, size_t* primitive);
+	void(*intersect_raysf)(const float* const* rays, size_t begin, size_t end, const float* triangle, size_t triangle_index, float t_min, float* const* hits, size_t* primitives);
+	void(*reduce_boundsf)(const float* const* components, size_t count, float* out);
+	void(*reduce_momentsf)(const float* const* components, size_t count, const float* center, float* out);
+};
+
+inline cpu_features detect_cpu_features()
+{
+	cpu_features features;
+#if defined(MATH_SSE2)
+	unsigned int regs1[4] = { 0, 0, 0, 0 };
+	unsigned int regs7[4] = { 0, 0, 0, 0 };
+	unsigned int max_leaf = 0;
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	max_leaf = static_cast<unsigned int>(info[0]);
+	__cpuidex(info, 1, 0);
+	for (size_t i = 0; i < 4; i++) { regs1[i] = static_cast<unsigned int>(info[i]); }
+	if (max_leaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		for (size_t i = 0; i < 4; i++) { regs7[i] = static_cast<unsigned int>(info[i]); }
+	}
+#else
+	max_leaf = __get_cpuid_max(0, nullptr);
+	__cpuid_count(1, 0, regs1[0], regs1[1], regs1[2], regs1[3]);
+	if (max_leaf >= 7)
+	{
+		__cpuid_count(7, 0, regs7[0], regs7[1], regs7[2], regs7[3]);
+	}
+#endif
+
+	//The OS must also save the wider registers on context switch (XCR0)
+	unsigned long long xcr0 = 0;
+	bool osxsave = (regs1[2] & (1u << 27)) != 0;
+	if (osxsave)
+	{
+#if defined(_MSC_VER)
+		xcr0 = _xgetbv(0);
+#else
+		unsigned int eax = 0, edx = 0;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+	bool os_avx = (xcr0 & 0x06) == 0x06;
+	bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+	features.sse2 = (regs1[3] & (1u << 26)) != 0;
+	features.sse41 = (regs1[2] & (1u << 19)) != 0;
+	features.avx = os_avx && (regs1[2] & (1u << 28)) != 0;
+	features.fma = features.avx && (regs1[2] & (1u << 12)) != 0;
+	features.avx2 = features.avx && (regs7[1] & (1u << 5)) != 0;
+	features.avx512f = os_avx512 && (regs7[1] & (1u << 16)) != 0;
+#endif
+	return features;
+}
+
+inline simd_tier best_simd_tier(const cpu_features& features)
+{
+#if defined(MATH_SSE2)
+	if (features.avx512f && features.avx2 && features.fma) { return simd_tier::avx512; }
+	if (features.avx2 && features.fma) { return simd_tier::avx2; }
+	if (features.sse41) { return simd_tier::sse41; }
+	if (features.sse2) { return simd_tier::sse2; }
+#endif
+	return simd_tier::scalar;
+}
+
+inline const char* to_string(simd_tier tier)
+{
+	switch (tier)
+	{
+	case simd_tier::sse2: return "sse2";
+	case simd_tier::sse41: return "sse41";
+	case simd_tier::avx2: return "avx2";
+	case simd_tier::avx512: return "avx512";
+	default: return "scalar";
+	}
+}
+
+inline std::tuple<bool, simd_tier> parse_simd_tier(const std::string& text)
+{
+	for (int i = static_cast<int>(simd_tier::scalar); i <= static_cast<int>(simd_tier::avx512); i++)
+	{
+		if (text == to_string(static_cast<simd_tier>(i)))
+		{
+			return { true, static_cast<simd_tier>(i) };
+		}
+	}
+	return { false, simd_tier::scalar };
+}
+
+//Returns the requested tier from MATH_SIMD_TIER, or the fallback if it is unset or unknown
+inline simd_tier environment_simd_tier(simd_tier fallback)
+{
+	std::string text;
+#if defined(_MSC_VER)
+	char* buffer = nullptr;
+	size_t size = 0;
+	if (_dupenv_s(&buffer, &size, "MATH_SIMD_TIER") == 0 && buffer != nullptr)
+	{
+		text = buffer;
+		free(buffer);
+	}
+#else
+	const char* buffer = std::getenv("MATH_SIMD_TIER");
+	if (buffer != nullptr)
+	{
+		text = buffer;
+	}
+#endif
+	auto parsed = parse_simd_tier(text);
+	return ret0(parsed) ? ret1(parsed) : fallback;
+}
+
+/*
+	make_batch_kernel_table
+	- binds the kernels of the given tier, clamped to what this CPU and build support
+*/
+inline batch_kernel_table make_batch_kernel_table(simd_tier tier)
+{
+	simd_tier supported = best_simd_tier(detect_cpu_features());
+	if (tier > supported)
+	{
+		tier = supported;
+	}
+
+	batch_kernel_table table;
+	table.tier = tier;
+	table.transform_vec4f = kernel_transform_vec4f_scalar;
+	table.transform_vec3f = kernel_transform_vec3f_scalar;
+	table.normalize_vec4f = kernel_normalize_vec4f_scalar;
+	table.dot_vec4f = kernel_dot_vec4f_scalar;
+	table.multiply_mat4x4f = kernel_multiply_mat4x4f_scalar;
+	table.multiply_left_mat4x4f = kernel_multiply_left_mat4x4f_scalar;
+	table.multiply_right_mat4x4f = kernel_multiply_right_mat4x4f_scalar;
+	table.inverse_mat4x4f = kernel_inverse_mat4x4_scalar<float>;
+	table.det_mat4x4f = kernel_det_mat4x4_scalar<float>;
+	table.inverse_mat3x3f = kernel_inverse_mat3x3_scalar<float>;
+	table.det_mat3x3f = kernel_det_mat3x3_scalar<float>;
+	table.multiply_quatf = kernel_multiply_quat_scalar<float>;
+	table.rotate_quatf = kernel_rotate_quat_scalar<float>;
+	table.normalize_quatf = kernel_normalize_quat_scalar<float>;
+	table.nlerp_quatf = kernel_nlerp_quat_scalar<float>;
+	table.to_mat4x4_quatf = kernel_to_mat4x4_quat_scalar<float>;
+	table.rsqrtf = kernel_rsqrtf_scalar;
+	table.fast_length_soaf = kernel_fast_length_soaf_scalar;
+	table.fast_normalize_soaf = kernel_fast_normalize_soaf_scalar;
+	table.elementary_sincosf = kernel_sincosf_scalar;
+	table.elementary_atan2f = kernel_atan2f_scalar;
+	table.elementary_acosf = kernel_acosf_scalar;
+	table.cull_spheresf = kernel_cull_spheres_scalar<float>;
+	table.cull_boxesf = kernel_cull_boxes_scalar<float>;
+	table.intersect_trianglesf = kernel_intersect_triangles_scalar<float>;
+	table.intersect_raysf = kernel_intersect_rays_scalar<float>;
+	table.reduce_boundsf = kernel_reduce_bounds_scalar<float>;
+	table.reduce_momentsf = kernel_reduce_moments_scalar<float>;
+#if defined(MATH_SSE2)
+	if (tier >= simd_tier::sse2)
+	{
+		table.transform_vec4f = kernel_transform_vec4f_sse2;
+		table.transform_vec3f = kernel_transform_vec3f_sse2;
+		table.normalize_vec4f = kernel_normalize_vec4f_sse2;
+		table.dot_vec4f = kernel_dot_vec4f_sse2;
+		table.multiply_mat4x4f = kernel_multiply_mat4x4f_sse2;
+		table.multiply_left_mat4x4f = kernel_multiply_left_mat4x4f_sse2;
+		table.multiply_right_mat4x4f = kernel_multiply_right_mat4x4f_sse2;
+		table.inverse_mat4x4f = kernel_inverse_mat4x4f_sse2;
+		table.det_mat4x4f = kernel_det_mat4x4f_sse2;
+		table.inverse_mat3x3f = kernel_inverse_mat3x3f_sse2;
+		table.det_mat3x3f = kernel_det_mat3x3f_sse2;
+		table.multiply_quatf = kernel_multiply_quatf_sse2;
+		table.rotate_quatf = kernel_rotate_quatf_sse2;
+		table.normalize_quatf = kernel_normalize_quatf_sse2;
+		table.nlerp_quatf = kernel_nlerp_quatf_sse2;
+		table.to_mat4x4_quatf = kernel_to_mat4x4_quatf_sse2;
+		table.rsqrtf = kernel_rsqrtf_sse2;
+		table.fast_length_soaf = kernel_fast_length_soaf_sse2;
+		table.fast_normalize_soaf = kernel_fast_normalize_soaf_sse2;
+		table.elementary_sincosf = kernel_sincosf_sse2;
+		table.elementary_atan2f = kernel_atan2f_sse2;
+		table.elementary_acosf = kernel_acosf_sse2;
+		table.cull_spheresf = kernel_cull_spheresf_sse2;
+		table.cull_boxesf = kernel_cull_boxesf_sse2;
+		table.intersect_trianglesf = kernel_intersect_trianglesf_sse2;
+		table.intersect_raysf = kernel_intersect_raysf_sse2;
+		table.reduce_boundsf = kernel_reduce_boundsf_sse2;
+		table.reduce_momentsf = kernel_reduce_momentsf_sse2;
+	}
+	if (tier >= simd_tier::sse41)
+	{
+		table.normalize_vec4f = kernel_normalize_vec4f_sse41;
+		table.dot_vec4f = kernel_dot_vec4f_sse41;
+	}
+	if (tier >= simd_tier::avx2)
+	{
+		table.transform_vec4f = kernel_transform_vec4f_avx2;
+		table.transform_vec3f = kernel_transform_vec3f_avx2;
+		table.normalize_vec4f = kernel_normalize_vec4f_avx2;
+		table.dot_vec4f = kernel_dot_vec4f_avx2;
+		table.multiply_mat4x4f = kernel_multiply_mat4x4f_avx2;
+		table.multiply_left_mat4x4f = kernel_multiply_left_mat4x4f_avx2;
+		table.multiply_right_mat4x4f = kernel_multiply_right_mat4x4f_avx2;
+		table.inverse_mat4x4f = kernel_inverse_mat4x4f_avx2;
+		table.det_mat4x4f = kernel_det_mat4x4f_avx2;
+		table.inverse_mat3x3f = kernel_inverse_mat3x3f_avx2;
+		table.det_mat3x3f = kernel_det_mat3x3f_avx2;
+		table.multiply_quatf = kernel_multiply_quatf_avx2;
+		table.rotate_quatf = kernel_rotate_quatf_avx2;
+		table.normalize_quatf = kernel_normalize_quatf_avx2;
+		table.nlerp_quatf = kernel_nlerp_quatf_avx2;
+		table.to_mat4x4_quatf = kernel_to_mat4x4_quatf_avx2;
+		table.rsqrtf = kernel_rsqrtf_avx2;
+		table.fast_length_soaf = kernel_fast_length_soaf_avx2;
+		table.fast_normalize_soaf = kernel_fast_normalize_soaf_avx2;
+		table.elementary_sincosf = kernel_sincosf_avx2;
+		table.elementary_atan2f = kernel_atan2f_avx2;
+		table.elementary_acosf = kernel_acosf_avx2;
+		table.cull_spheresf = kernel_cull_spheresf_avx2;
+		table.cull_boxesf = kernel_cull_boxesf_avx2;
+		table.intersect_trianglesf = kernel_intersect_trianglesf_avx2;
+		table.intersect_raysf = kernel_intersect_raysf_avx2;
+		table.reduce_boundsf = kernel_reduce_boundsf_avx2;
+		table.reduce_momentsf = kernel_reduce_momentsf_avx2;
+	}
+	if (tier >= simd_tier::avx512)
+	{
+		table.transform_vec4f = kernel_transform_vec4f_avx512;
+		table.multiply_mat4x4f = kernel_multiply_mat4x4f_avx512;
+		table.multiply_left_mat4x4f = kernel_multiply_left_mat4x4f_avx512;
+		table.multiply_right_mat4x4f = kernel_multiply_right_mat4x4f_avx512;
+		table.intersect_trianglesf = kernel_intersect_trianglesf_avx512;
+		table.intersect_raysf = kernel_intersect_raysf_avx512;
+		table.reduce_boundsf = kernel_reduce_boundsf_avx512;
+		table.reduce_momentsf = kernel_reduce_momentsf_avx512;
+	}
+#endif
+	return table;
+}
+
+inline batch_kernel_table& mutable_batch_kernels()
+{
+	static batch_kernel_table table = make_batch_kernel_table(environment_simd_tier(simd_tier::avx512));
+	return table;
+}
+
+//Kernel table bound on first use from the detected CPU features and MATH_SIMD_TIER
+inline const batch_kernel_table& batch_kernels()
+{
+	return mutable_batch_kernels();
+}
+
+//Rebinds every batch entry point to the given tier (clamped), not safe while batch calls are in flight
+inline simd_tier force_simd_tier(simd_tier tier)
+{
+	mutable_batch_kernels() = make_batch_kernel_table(tier);
+	return mutable_batch_kernels().tier;
+}
+
+inline simd_tier active_simd_tier()
+{
+	return batch_kernels().tier;
+}
+
+/*
+	batch_transform / batch_normalize / batch_dot / batch_multiply
+	- vec4 and pairwise mat4x4 operations over arrays, float arrays run on the dispatched kernels
+	- arrays above PARALLEL_GRAIN (PARALLEL_MATRIX_GRAIN for matrices) are split across threads
+*/
+template<class T>
+inline void batch_transform(const vec4<T>* vecs, vec4<T>* out, size_t count, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = transform(vecs[i], mat, is_row_vector);
+		}
+	});
+}
+
+inline void batch_transform(const vec4<float>* vecs, vec4<float>* out, size_t count, const mat4x4<float>& mat, bool is_row_vector = true)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().transform_vec4f(&vecs[begin].x, &out[begin].x, end - begin, mat.ptr(), is_row_vector);
+	});
+}
+
+template<class T>
+inline void batch_normalize(vec4<T>* vecs, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			vecs[i].normalize();
+		}
+	});
+}
+
+inline void batch_normalize(vec4<float>* vecs, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().normalize_vec4f(&vecs[begin].x, end - begin);
+	});
+}
+
+template<class T>
+inline void batch_dot(const vec4<T>* vecs1, const vec4<T>* vecs2, T* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = vecs1[i].dot(vecs2[i]);
+		}
+	});
+}
+
+inline void batch_dot(const vec4<float>* vecs1, const vec4<float>* vecs2, float* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().dot_vec4f(&vecs1[begin].x, &vecs2[begin].x, out + begin, end - begin);
+	});
+}
+
+template<class T>
+inline void batch_multiply(const mat4x4<T>* mats1, const mat4x4<T>* mats2, mat4x4<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = mats1[i] * mats2[i];
+		}
+	});
+}
+
+inline void batch_multiply(const mat4x4<float>* mats1, const mat4x4<float>* mats2, mat4x4<float>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().multiply_mat4x4f(mats1[begin].ptr(), mats2[begin].ptr(), out[begin].ptr(), end - begin);
+	});
+}
+
+//The quat and view overloads of these names are found through their arguments
+MATH_EXECUTION_OVERLOAD(batch_transform)
+MATH_EXECUTION_OVERLOAD(batch_normalize)
+MATH_EXECUTION_OVERLOAD(batch_dot)
+MATH_EXECUTION_OVERLOAD(batch_multiply)
+
+#endif // !__DISPATCH__
@@ -0,0 +1,229 @@
+#pragma once
+
+#ifndef __ELEMENTARY__
+#define __ELEMENTARY__
+
+#include "angle.hpp"
+#include "parallel.hpp"
+#include "batch.hpp"
+#include "quat.hpp"
+
+//Elements the batch rotation builders stage on the stack at a time
+#define ELEMENTARY_CHUNK 256
+
+/*
+	sincos / batch_sincos / batch_atan2 / batch_acos
+	- float runs the polynomial kernels, 4 (SSE) or 8 (AVX2) values at a time, with the error bounds of elementary_accuracy
+	- other types call std::sin / std::cos / std::atan2 / std::acos and ignore accuracy
+	- batch functions split arrays above PARALLEL_GRAIN across threads, out arrays may be the input arrays
+*/
+template<class T>
+inline std::tuple<T, T> sincos(T radian, elementary_accuracy = elementary_accuracy::precise)
+{
+	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
+	return { std::sin(radian), std::cos(radian) };
+}
+
+template<>
+inline std::tuple<float, float> sincos(float radian, elementary_accuracy accuracy)
+{
+	float sin_value = 0.0f, cos_value = 0.0f;
+	if (accuracy == elementary_accuracy::precise) { kernel_sincos_lanes<true>(radian, sin_value, cos_value); }
+	else { kernel_sincos_lanes<false>(radian, sin_value, cos_value); }
+	return { sin_value, cos_value };
+}
+
+template<class T>
+inline void batch_sincos(const T* radians, T* sin_out, T* cos_out, size_t count, elementary_accuracy = elementary_accuracy::precise)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			T radian = radians[i];
+			sin_out[i] = std::sin(radian);
+			cos_out[i] = std::cos(radian);
+		}
+	});
+}
+
+inline void batch_sincos(const float* radians, float* sin_out, float* cos_out, size_t count, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().elementary_sincosf(radians + begin, sin_out + begin, cos_out + begin, end - begin, accuracy);
+	});
+}
+
+template<class T>
+inline void batch_atan2(const T* y, const T* x, T* out, size_t count, elementary_accuracy = elementary_accuracy::precise)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = std::atan2(y[i], x[i]);
+		}
+	});
+}
+
+inline void batch_atan2(const float* y, const float* x, float* out, size_t count, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().elementary_atan2f(y + begin, x + begin, out + begin, end - begin, accuracy);
+	});
+}
+
+template<class T>
+inline void batch_acos(const T* in, T* out, size_t count, elementary_accuracy = elementary_accuracy::precise)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = std::acos(in[i]);
+		}
+	});
+}
+
+inline void batch_acos(const float* in, float* out, size_t count, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().elementary_acosf(in + begin, out + begin, end - begin, accuracy);
+	});
+}
+
+template<class T>
+inline void batch_radian_to_degree(const T* radians, T* out, size_t count)
+{
+	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
+	const T scale = static_cast<T>(180.0 / PI);
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = radians[i] * scale;
+		}
+	});
+}
+
+template<class T>
+inline void batch_degree_to_radian(const T* degrees, T* out, size_t count)
+{
+	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
+	const T scale = static_cast<T>(PI / 180.0);
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = degrees[i] * scale;
+		}
+	});
+}
+
+/*
+	batch_axis_angle / batch_rotate
+	- quat(radians[i], axis) and rotate(radians[i], axis, is_row_vector) over arrays, with one shared axis or one axis per angle
+	- float takes the half-angle sin / cos from the sincos kernel and builds the matrices with the quat kernels,
+	  ELEMENTARY_CHUNK elements at a time, arrays above PARALLEL_MATRIX_GRAIN are split across threads
+*/
+template<class T>
+inline void batch_axis_angle_run(const T* radians, const vec3<T>* axes, size_t axis_step, quat<T>* out, size_t count, elementary_accuracy)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = quat<T>(radians[i], axes[i * axis_step]);
+		}
+	});
+}
+
+inline void batch_axis_angle_chunk(const float* radians, const vec3<float>* axes, size_t axis_step, quat<float>* out, size_t count, elementary_accuracy accuracy)
+{
+	float half[ELEMENTARY_CHUNK], sin_half[ELEMENTARY_CHUNK], cos_half[ELEMENTARY_CHUNK];
+	for (size_t i = 0; i < count; i++)
+	{
+		half[i] = radians[i] * 0.5f;
+	}
+	batch_kernels().elementary_sincosf(half, sin_half, cos_half, count, accuracy);
+	vec3<float> shared_axis = axis_step == 0 ? axes[0].normal() : vec3<float>();
+	for (size_t i = 0; i < count; i++)
+	{
+		vec3<float> axis = axis_step == 0 ? shared_axis : axes[i].normal();
+		out[i] = quat<float>(axis.x * sin_half[i], axis.y * sin_half[i], axis.z * sin_half[i], cos_half[i]);
+	}
+}
+
+inline void batch_axis_angle_run(const float* radians, const vec3<float>* axes, size_t axis_step, quat<float>* out, size_t count, elementary_accuracy accuracy)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i += ELEMENTARY_CHUNK)
+		{
+			size_t size = end - i < ELEMENTARY_CHUNK ? end - i : ELEMENTARY_CHUNK;
+			batch_axis_angle_chunk(radians + i, axes + i * axis_step, axis_step, out + i, size, accuracy);
+		}
+	});
+}
+
+template<class T>
+inline void batch_axis_angle(const T* radians, vec3<T> axis, quat<T>* out, size_t count, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	batch_axis_angle_run(radians, &axis, 0, out, count, accuracy);
+}
+
+template<class T>
+inline void batch_axis_angle(const T* radians, const vec3<T>* axes, quat<T>* out, size_t count, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	batch_axis_angle_run(radians, axes, 1, out, count, accuracy);
+}
+
+template<class T>
+inline void batch_rotate_run(const T* radians, const vec3<T>* axes, size_t axis_step, mat4x4<T>* out, size_t count, bool is_row_vector, elementary_accuracy)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = rotate(radians[i], axes[i * axis_step], is_row_vector);
+		}
+	});
+}
+
+inline void batch_rotate_run(const float* radians, const vec3<float>* axes, size_t axis_step, mat4x4<float>* out, size_t count, bool is_row_vector, elementary_accuracy accuracy)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		quat<float> quats[ELEMENTARY_CHUNK];
+		for (size_t i = begin; i < end; i += ELEMENTARY_CHUNK)
+		{
+			size_t size = end - i < ELEMENTARY_CHUNK ? end - i : ELEMENTARY_CHUNK;
+			batch_axis_angle_chunk(radians + i, axes + i * axis_step, axis_step, quats, size, accuracy);
+			batch_kernels().to_mat4x4_quatf(&quats->x, out[i].ptr(), size, is_row_vector);
+		}
+	});
+}
+
+template<class T>
+inline void batch_rotate(const T* radians, vec3<T> axis, mat4x4<T>* out, size_t count, bool is_row_vector = true, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	batch_rotate_run(radians, &axis, 0, out, count, is_row_vector, accuracy);
+}
+
+template<class T>
+inline void batch_rotate(const T* radians, const vec3<T>* axes, mat4x4<T>* out, size_t count, bool is_row_vector = true, elementary_accuracy accuracy = elementary_accuracy::precise)
+{
+	batch_rotate_run(radians, axes, 1, out, count, is_row_vector, accuracy);
+}
+
+MATH_EXECUTION_OVERLOAD(batch_sincos)
+MATH_EXECUTION_OVERLOAD(batch_atan2)
+MATH_EXECUTION_OVERLOAD(batch_acos)
+MATH_EXECUTION_OVERLOAD(batch_axis_angle)
+MATH_EXECUTION_OVERLOAD(batch_radian_to_degree)
+MATH_EXECUTION_OVERLOAD(batch_degree_to_radian)
+
+#endif // !__ELEMENTARY__
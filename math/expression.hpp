@@ -0,0 +1,584 @@
+#pragma once
+
+#ifndef __EXPRESSION__
+#define __EXPRESSION__
+
+#include <stdint.h>
+
+#include "soa.hpp"
+
+/*
+	expression templates
+	- lazy(...) turns soa containers, soa_array columns, array-of-structs spans and vec3/vec4 values into expression leaves
+	- + - * / and unary - on an expression build a tree instead of a temporary container, scalars and vec values broadcast
+	- the tree is evaluated in one fused loop when it is assigned, compound-assigned or converted to a container
+	- every lane is fully evaluated before it is stored, so the target may also appear in the expression
+	- leaves point into their operands, evaluate an expression before its operands are destroyed
+	- define MATH_EXPRESSION_TEMPLATES before including soa.hpp to make the soa container operators lazy without lazy()
+*/
+
+//Size of a leaf that broadcasts to any number of lanes
+#define EXPRESSION_ANY_SIZE SIZE_MAX
+
+struct expr_node
+{
+};
+
+template<class T, size_t D>
+struct expr_container;
+
+template<class T>
+struct expr_container<T, 1>
+{
+	using type = soa_array<T>;
+};
+
+template<class T>
+struct expr_container<T, 3>
+{
+	using type = vec3_soa<T>;
+};
+
+template<class T>
+struct expr_container<T, 4>
+{
+	using type = vec4_soa<T>;
+};
+
+template<class E>
+struct expr_base : expr_node
+{
+	//Evaluates into a new soa_array, vec3_soa or vec4_soa
+	template<class C, class D = E, class = typename std::enable_if<std::is_same<C, typename expr_container<typename D::value_type, D::dimension>::type>::value>::type>
+	operator C() const
+	{
+		const D& expr = static_cast<const D&>(*this);
+		if (expr.size() == EXPRESSION_ANY_SIZE) { throw std::invalid_argument("expression has no container operand to take its size from!"); }
+		C ret(expr.size());
+		assign(ret, expr);
+		return ret;
+	}
+};
+
+//Scalar (D = 1) or vec3/vec4 value repeated on every lane
+template<class T, size_t D>
+struct expr_constant : expr_base<expr_constant<T, D>>
+{
+	using value_type = T;
+	static const size_t dimension = D;
+
+	std::array<T, D> values;
+
+	size_t size() const
+	{
+		return EXPRESSION_ANY_SIZE;
+	}
+
+	T eval(size_t component, size_t) const
+	{
+		return values[component];
+	}
+};
+
+//soa_array (D = 1), vec3_soa or vec4_soa read in place
+template<class T, size_t D>
+struct expr_columns : expr_base<expr_columns<T, D>>
+{
+	using value_type = T;
+	static const size_t dimension = D;
+
+	const T* columns[D];
+	size_t count;
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	T eval(size_t component, size_t index) const
+	{
+		return columns[component][index];
+	}
+};
+
+//Packed array of vec3/vec4
+template<class T, size_t D>
+struct expr_aos : expr_base<expr_aos<T, D>>
+{
+	using value_type = T;
+	static const size_t dimension = D;
+
+	const T* elements;
+	size_t count;
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	T eval(size_t component, size_t index) const
+	{
+		return elements[index * D + component];
+	}
+};
+
+struct expr_add
+{
+	template<class T>
+	static T apply(T a, T b)
+	{
+		return a + b;
+	}
+};
+
+struct expr_sub
+{
+	template<class T>
+	static T apply(T a, T b)
+	{
+		return a - b;
+	}
+};
+
+struct expr_mul
+{
+	template<class T>
+	static T apply(T a, T b)
+	{
+		return a * b;
+	}
+};
+
+struct expr_div
+{
+	template<class T>
+	static T apply(T a, T b)
+	{
+		return a / b;
+	}
+};
+
+/*
+	expr_binary
+	- operands of dimension 1 broadcast over the components of the other operand
+	- operands must have the same size unless one of them broadcasts
+*/
+template<class Op, class L, class R>
+struct expr_binary : expr_base<expr_binary<Op, L, R>>
+{
+	static_assert(std::is_same<typename L::value_type, typename R::value_type>::value, "Operands of an expression must have the same value type!");
+	static_assert(L::dimension == R::dimension || L::dimension == 1 || R::dimension == 1, "Operands of an expression must have the same dimension!");
+
+	using value_type = typename L::value_type;
+	static const size_t dimension = L::dimension == 1 ? R::dimension : L::dimension;
+
+	L left;
+	R right;
+	size_t count;
+
+	expr_binary(const L& left, const R& right) : left(left), right(right), count(left.size())
+	{
+		if (count == EXPRESSION_ANY_SIZE)
+		{
+			count = right.size();
+		}
+		else if (right.size() != EXPRESSION_ANY_SIZE)
+		{
+			check_soa_size(count, right.size());
+		}
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	value_type eval(size_t component, size_t index) const
+	{
+		return Op::apply(left.eval(L::dimension == 1 ? 0 : component, index), right.eval(R::dimension == 1 ? 0 : component, index));
+	}
+};
+
+template<class E>
+struct expr_negate : expr_base<expr_negate<E>>
+{
+	using value_type = typename E::value_type;
+	static const size_t dimension = E::dimension;
+
+	E operand;
+
+	explicit expr_negate(const E& operand) : operand(operand)
+	{
+	}
+
+	size_t size() const
+	{
+		return operand.size();
+	}
+
+	value_type eval(size_t component, size_t index) const
+	{
+		return -operand.eval(component, index);
+	}
+};
+
+template<class T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+inline expr_constant<T, 1> lazy(T t)
+{
+	return { {}, { t } };
+}
+
+template<class T>
+inline expr_constant<T, 3> lazy(vec3<T> vec)
+{
+	return { {}, { vec.x, vec.y, vec.z } };
+}
+
+template<class T>
+inline expr_constant<T, 4> lazy(vec4<T> vec)
+{
+	return { {}, { vec.x, vec.y, vec.z, vec.w } };
+}
+
+template<class T>
+inline expr_columns<T, 1> lazy(const soa_array<T>& arr)
+{
+	return { {}, { arr.data() }, arr.size() };
+}
+
+template<class T>
+inline expr_columns<T, 3> lazy(const vec3_soa<T>& vecs)
+{
+	return { {}, { vecs.x.data(), vecs.y.data(), vecs.z.data() }, vecs.size() };
+}
+
+template<class T>
+inline expr_columns<T, 4> lazy(const vec4_soa<T>& vecs)
+{
+	return { {}, { vecs.x.data(), vecs.y.data(), vecs.z.data(), vecs.w.data() }, vecs.size() };
+}
+
+template<class T>
+inline expr_aos<T, 3> lazy(const vec3<T>* vecs, size_t count)
+{
+	static_assert(sizeof(vec3<T>) == 3 * sizeof(T), "vec3<T> must be tightly packed!");
+	return { {}, &vecs->x, count };
+}
+
+template<class T>
+inline expr_aos<T, 4> lazy(const vec4<T>* vecs, size_t count)
+{
+	static_assert(sizeof(vec4<T>) == 4 * sizeof(T), "vec4<T> must be tightly packed!");
+	return { {}, &vecs->x, count };
+}
+
+template<class E, class = typename std::enable_if<std::is_base_of<expr_node, E>::value>::type>
+inline const E& lazy(const E& expr)
+{
+	return expr;
+}
+
+/*
+	is_expr_operand / is_expr_trigger
+	- an operand is anything lazy() accepts with a single argument, except plain scalars
+	- a binary operator builds a tree when one operand triggers it: an expression, or with MATH_EXPRESSION_TEMPLATES a soa container
+*/
+template<class X>
+struct is_expr_operand : std::is_base_of<expr_node, X>
+{
+};
+
+template<class T>
+struct is_expr_operand<vec3<T>> : std::true_type
+{
+};
+
+template<class T>
+struct is_expr_operand<vec4<T>> : std::true_type
+{
+};
+
+template<class T>
+struct is_expr_operand<soa_array<T>> : std::true_type
+{
+};
+
+template<class T>
+struct is_expr_operand<vec3_soa<T>> : std::true_type
+{
+};
+
+template<class T>
+struct is_expr_operand<vec4_soa<T>> : std::true_type
+{
+};
+
+template<class X>
+struct is_expr_container : std::false_type
+{
+};
+
+template<class T>
+struct is_expr_container<soa_array<T>> : std::true_type
+{
+};
+
+template<class T>
+struct is_expr_container<vec3_soa<T>> : std::true_type
+{
+};
+
+template<class T>
+struct is_expr_container<vec4_soa<T>> : std::true_type
+{
+};
+
+#ifdef MATH_EXPRESSION_TEMPLATES
+template<class X>
+struct is_expr_trigger : std::integral_constant<bool, std::is_base_of<expr_node, X>::value || is_expr_container<X>::value>
+{
+};
+#else
+template<class X>
+struct is_expr_trigger : std::is_base_of<expr_node, X>
+{
+};
+#endif
+
+template<class L, class R>
+using enable_expr_binary = typename std::enable_if<is_expr_operand<L>::value && is_expr_operand<R>::value && (is_expr_trigger<L>::value || is_expr_trigger<R>::value), int>::type;
+
+template<class E, class S>
+using enable_expr_scalar = typename std::enable_if<is_expr_trigger<E>::value && std::is_arithmetic<S>::value, int>::type;
+
+template<class E>
+using expr_of = typename std::decay<decltype(lazy(std::declval<const E&>()))>::type;
+
+template<class E>
+using expr_scalar_of = expr_constant<typename expr_of<E>::value_type, 1>;
+
+template<class L, class R, enable_expr_binary<L, R> = 0>
+inline expr_binary<expr_add, expr_of<L>, expr_of<R>> operator+(const L& left, const R& right)
+{
+	return { lazy(left), lazy(right) };
+}
+
+template<class E, class S, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_add, expr_of<E>, expr_scalar_of<E>> operator+(const E& expr, S t)
+{
+	return { lazy(expr), lazy(static_cast<typename expr_of<E>::value_type>(t)) };
+}
+
+template<class S, class E, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_add, expr_scalar_of<E>, expr_of<E>> operator+(S t, const E& expr)
+{
+	return { lazy(static_cast<typename expr_of<E>::value_type>(t)), lazy(expr) };
+}
+
+template<class L, class R, enable_expr_binary<L, R> = 0>
+inline expr_binary<expr_sub, expr_of<L>, expr_of<R>> operator-(const L& left, const R& right)
+{
+	return { lazy(left), lazy(right) };
+}
+
+template<class E, class S, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_sub, expr_of<E>, expr_scalar_of<E>> operator-(const E& expr, S t)
+{
+	return { lazy(expr), lazy(static_cast<typename expr_of<E>::value_type>(t)) };
+}
+
+template<class S, class E, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_sub, expr_scalar_of<E>, expr_of<E>> operator-(S t, const E& expr)
+{
+	return { lazy(static_cast<typename expr_of<E>::value_type>(t)), lazy(expr) };
+}
+
+template<class L, class R, enable_expr_binary<L, R> = 0>
+inline expr_binary<expr_mul, expr_of<L>, expr_of<R>> operator*(const L& left, const R& right)
+{
+	return { lazy(left), lazy(right) };
+}
+
+template<class E, class S, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_mul, expr_of<E>, expr_scalar_of<E>> operator*(const E& expr, S t)
+{
+	return { lazy(expr), lazy(static_cast<typename expr_of<E>::value_type>(t)) };
+}
+
+template<class S, class E, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_mul, expr_scalar_of<E>, expr_of<E>> operator*(S t, const E& expr)
+{
+	return { lazy(static_cast<typename expr_of<E>::value_type>(t)), lazy(expr) };
+}
+
+template<class L, class R, enable_expr_binary<L, R> = 0>
+inline expr_binary<expr_div, expr_of<L>, expr_of<R>> operator/(const L& left, const R& right)
+{
+	return { lazy(left), lazy(right) };
+}
+
+template<class E, class S, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_div, expr_of<E>, expr_scalar_of<E>> operator/(const E& expr, S t)
+{
+	return { lazy(expr), lazy(static_cast<typename expr_of<E>::value_type>(t)) };
+}
+
+template<class S, class E, enable_expr_scalar<E, S> = 0>
+inline expr_binary<expr_div, expr_scalar_of<E>, expr_of<E>> operator/(S t, const E& expr)
+{
+	return { lazy(static_cast<typename expr_of<E>::value_type>(t)), lazy(expr) };
+}
+
+template<class E, typename std::enable_if<is_expr_trigger<E>::value, int>::type = 0>
+inline expr_negate<expr_of<E>> operator-(const E& expr)
+{
+	return expr_negate<expr_of<E>>(lazy(expr));
+}
+
+/*
+	expr_store
+	- the fused loop, writes lane index of every component to columns[component][index]
+	- lanes are independent, targets above PARALLEL_GRAIN lanes are split across threads
+*/
+template<class T, size_t D, class E>
+inline void expr_store(T* const* columns, size_t count, const E& expr)
+{
+	static_assert(std::is_same<T, typename E::value_type>::value, "Expression and target must have the same value type!");
+	static_assert(E::dimension == D || E::dimension == 1, "Expression and target must have the same dimension!");
+	if (expr.size() != EXPRESSION_ANY_SIZE)
+	{
+		check_soa_size(count, expr.size());
+	}
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			T lane[D];
+			for (size_t c = 0; c < D; c++)
+			{
+				lane[c] = expr.eval(E::dimension == 1 ? 0 : c, i);
+			}
+			for (size_t c = 0; c < D; c++)
+			{
+				columns[c][i] = lane[c];
+			}
+		}
+	});
+}
+
+/*
+	assign
+	- evaluates expr into out, a target of another size is resized to the size of expr first
+*/
+template<class T, class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void assign(soa_array<T>& out, const E& expr)
+{
+	if (expr.size() != EXPRESSION_ANY_SIZE && expr.size() != out.size())
+	{
+		out = soa_array<T>(expr.size());
+	}
+	T* columns[1] = { out.data() };
+	expr_store<T, 1>(columns, out.size(), expr);
+}
+
+template<class T, class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void assign(vec3_soa<T>& out, const E& expr)
+{
+	if (expr.size() != EXPRESSION_ANY_SIZE && expr.size() != out.size())
+	{
+		out = vec3_soa<T>(expr.size());
+	}
+	T* columns[3] = { out.x.data(), out.y.data(), out.z.data() };
+	expr_store<T, 3>(columns, out.size(), expr);
+}
+
+template<class T, class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void assign(vec4_soa<T>& out, const E& expr)
+{
+	if (expr.size() != EXPRESSION_ANY_SIZE && expr.size() != out.size())
+	{
+		out = vec4_soa<T>(expr.size());
+	}
+	T* columns[4] = { out.x.data(), out.y.data(), out.z.data(), out.w.data() };
+	expr_store<T, 4>(columns, out.size(), expr);
+}
+
+//Array-of-structs targets are not resized, count must match the size of expr
+template<class T, class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void assign(vec3<T>* out, size_t count, const E& expr)
+{
+	static_assert(std::is_same<T, typename E::value_type>::value, "Expression and target must have the same value type!");
+	static_assert(E::dimension == 3 || E::dimension == 1, "Expression and target must have the same dimension!");
+	if (expr.size() != EXPRESSION_ANY_SIZE)
+	{
+		check_soa_size(count, expr.size());
+	}
+	const size_t d = E::dimension == 1 ? 0 : 1;
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = vec3<T>(expr.eval(0, i), expr.eval(d, i), expr.eval(d * 2, i));
+		}
+	});
+}
+
+template<class T, class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void assign(vec4<T>* out, size_t count, const E& expr)
+{
+	static_assert(std::is_same<T, typename E::value_type>::value, "Expression and target must have the same value type!");
+	static_assert(E::dimension == 4 || E::dimension == 1, "Expression and target must have the same dimension!");
+	if (expr.size() != EXPRESSION_ANY_SIZE)
+	{
+		check_soa_size(count, expr.size());
+	}
+	const size_t d = E::dimension == 1 ? 0 : 1;
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = vec4<T>(expr.eval(0, i), expr.eval(d, i), expr.eval(d * 2, i), expr.eval(d * 3, i));
+		}
+	});
+}
+
+//Evaluates expr into a new container, see also the conversion in expr_base
+template<class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline typename expr_container<typename E::value_type, E::dimension>::type evaluate(const E& expr)
+{
+	return expr;
+}
+
+//The compound assignments take the policy of an execution_scope
+MATH_EXECUTION_OVERLOAD(assign)
+MATH_EXECUTION_OVERLOAD(evaluate)
+
+/*
+	compound assignment
+	- out op= expr runs as out = out op expr in the same fused loop
+*/
+template<class C, class E, typename std::enable_if<is_expr_container<C>::value && std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void operator+=(C& out, const E& expr)
+{
+	assign(out, lazy(out) + expr);
+}
+
+template<class C, class E, typename std::enable_if<is_expr_container<C>::value && std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void operator-=(C& out, const E& expr)
+{
+	assign(out, lazy(out) - expr);
+}
+
+template<class C, class E, typename std::enable_if<is_expr_container<C>::value && std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void operator*=(C& out, const E& expr)
+{
+	assign(out, lazy(out) * expr);
+}
+
+template<class C, class E, typename std::enable_if<is_expr_container<C>::value && std::is_base_of<expr_node, E>::value, int>::type = 0>
+inline void operator/=(C& out, const E& expr)
+{
+	assign(out, lazy(out) / expr);
+}
+
+#endif // !__EXPRESSION__
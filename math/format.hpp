@@ -0,0 +1,218 @@
+#pragma once
+
+#ifndef __FORMAT__
+#define __FORMAT__
+
+#include <charconv>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <stdio.h>
+#include <tuple>
+
+#include "vector.hpp"
+#include "matrix.hpp"
+
+//Shortest text that parses back to the same value
+#define FORMAT_SHORTEST -1
+//Stack buffer the streaming writers format into before handing the text to the sink
+#define FORMAT_BUFFER 16384
+
+/*
+	format_options
+	- precision is the number of digits after the decimal point, FORMAT_SHORTEST for the round-trip form
+	- matrices are written row by row, or column by column when is_output_row_major is false
+	- is_plain writes bare components separated by spaces ("1 2 3", as parse_vecs reads them)
+	  instead of the to_string form ("vec3(1, 2, 3)")
+*/
+struct format_options
+{
+	int precision = FORMAT_SHORTEST;
+	bool is_output_row_major = true;
+	bool is_plain = false;
+};
+
+//std::to_chars for float and double with a precision needs Visual Studio 2019 16.4 (_MSC_VER 1924),
+//the v142 toolset the project builds with (see simd.hpp) covers it
+#if defined(_MSC_VER) && _MSC_VER < 1924
+#error "format.hpp needs the v142 toolset (Visual Studio 2019 16.4) or later for std::to_chars"
+#endif
+
+template<class T>
+inline std::to_chars_result format_component(char* first, char* last, T t, int precision)
+{
+	if (precision < 0)
+	{
+		return std::to_chars(first, last, t);
+	}
+	return std::to_chars(first, last, t, std::chars_format::fixed, precision);
+}
+
+inline std::to_chars_result format_literal(char* first, char* last, const char* text, size_t size)
+{
+	if (static_cast<size_t>(last - first) < size)
+	{
+		return { last, std::errc::value_too_large };
+	}
+	memcpy(first, text, size);
+	return { first + size, std::errc() };
+}
+
+template<class T, size_t N>
+inline std::to_chars_result format_components(char* first, char* last, const char* name, const T (&values)[N], const format_options& options)
+{
+	std::to_chars_result result = { first, std::errc() };
+	if (!options.is_plain)
+	{
+		result = format_literal(result.ptr, last, name, strlen(name));
+		if (result.ec != std::errc()) { return result; }
+		result = format_literal(result.ptr, last, "(", 1);
+		if (result.ec != std::errc()) { return result; }
+	}
+	for (size_t i = 0; i < N; i++)
+	{
+		if (i > 0)
+		{
+			result = options.is_plain ? format_literal(result.ptr, last, " ", 1) : format_literal(result.ptr, last, ", ", 2);
+			if (result.ec != std::errc()) { return result; }
+		}
+		result = format_component(result.ptr, last, values[i], options.precision);
+		if (result.ec != std::errc()) { return result; }
+	}
+	if (!options.is_plain)
+	{
+		result = format_literal(result.ptr, last, ")", 1);
+	}
+	return result;
+}
+
+/*
+	to_chars
+	- writes one vector or matrix into [first, last) with std::to_chars, nothing is allocated
+	- like std::to_chars, ec is std::errc::value_too_large when the text does not fit, the range is then unspecified
+*/
+template<class T>
+inline std::to_chars_result to_chars(char* first, char* last, vec2<T> vec, const format_options& options = format_options())
+{
+	T values[] = { vec.x, vec.y };
+	return format_components(first, last, "vec2", values, options);
+}
+
+template<class T>
+inline std::to_chars_result to_chars(char* first, char* last, vec3<T> vec, const format_options& options = format_options())
+{
+	T values[] = { vec.x, vec.y, vec.z };
+	return format_components(first, last, "vec3", values, options);
+}
+
+template<class T>
+inline std::to_chars_result to_chars(char* first, char* last, vec4<T> vec, const format_options& options = format_options())
+{
+	T values[] = { vec.x, vec.y, vec.z, vec.w };
+	return format_components(first, last, "vec4", values, options);
+}
+
+template<class T>
+inline std::to_chars_result to_chars(char* first, char* last, const mat3x3<T>& mat, const format_options& options = format_options())
+{
+	T values[9];
+	for (size_t row = 0; row < 3; row++)
+	{
+		for (size_t col = 0; col < 3; col++)
+		{
+			values[options.is_output_row_major ? row * 3 + col : col * 3 + row] = mat.unchecked(row, col);
+		}
+	}
+	return format_components(first, last, "mat3x3", values, options);
+}
+
+template<class T>
+inline std::to_chars_result to_chars(char* first, char* last, const mat4x4<T>& mat, const format_options& options = format_options())
+{
+	T values[16];
+	for (size_t row = 0; row < 4; row++)
+	{
+		for (size_t col = 0; col < 4; col++)
+		{
+			values[options.is_output_row_major ? row * 4 + col : col * 4 + row] = mat.unchecked(row, col);
+		}
+	}
+	return format_components(first, last, "mat4x4", values, options);
+}
+
+/*
+	format_array
+	- writes values[0, count) one per line into [first, last), stopping before the first value that does not fit
+	- returns the number of values written and the end of the text
+*/
+template<class V>
+inline std::tuple<size_t, char*> format_array(char* first, char* last, const V* values, size_t count, const format_options& options = format_options())
+{
+	char* ptr = first;
+	for (size_t i = 0; i < count; i++)
+	{
+		std::to_chars_result result = to_chars(ptr, last, values[i], options);
+		if (result.ec != std::errc() || result.ptr == last)
+		{
+			return { i, ptr };
+		}
+		*result.ptr = '\n';
+		ptr = result.ptr + 1;
+	}
+	return { count, ptr };
+}
+
+/*
+	format_array with a sink
+	- formats into a FORMAT_BUFFER sized stack buffer and calls sink(const char* data, size_t size) each time it fills,
+	  so there is no heap allocation however many values are written
+	- make_sink(FILE*) and make_sink(std::ostream&) build sinks that write to a file or a stream
+	- throws std::length_error if a single value does not fit FORMAT_BUFFER, the sinks throw std::runtime_error when
+	  the file or stream fails
+*/
+template<class V, class Sink>
+inline void format_array(const V* values, size_t count, Sink sink, const format_options& options = format_options())
+{
+	char buffer[FORMAT_BUFFER];
+	size_t done = 0;
+	while (done < count)
+	{
+		std::tuple<size_t, char*> written = format_array(buffer, buffer + FORMAT_BUFFER, values + done, count - done, options);
+		if (std::get<0>(written) == 0) { throw std::length_error("formatted value does not fit the format buffer!"); }
+		sink(static_cast<const char*>(buffer), static_cast<size_t>(std::get<1>(written) - buffer));
+		done += std::get<0>(written);
+	}
+}
+
+struct file_sink
+{
+	FILE* file;
+
+	void operator()(const char* data, size_t size) const
+	{
+		if (fwrite(data, 1, size, file) != size) { throw std::runtime_error("failed to write the file!"); }
+	}
+};
+
+struct stream_sink
+{
+	std::ostream* out;
+
+	void operator()(const char* data, size_t size) const
+	{
+		out->write(data, static_cast<std::streamsize>(size));
+		if (out->fail()) { throw std::runtime_error("failed to write the stream!"); }
+	}
+};
+
+inline file_sink make_sink(FILE* file)
+{
+	return { file };
+}
+
+inline stream_sink make_sink(std::ostream& out)
+{
+	return { &out };
+}
+
+#endif // !__FORMAT__
@@ -0,0 +1,197 @@
+#pragma once
+
+#ifndef __FRUSTUM__
+#define __FRUSTUM__
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+#include "batch.hpp"
+#include "soa.hpp"
+
+template<class T>
+class frustum;
+
+using frustumf = frustum<float>;
+using frustumd = frustum<double>;
+using frustumld = frustum<long double>;
+
+/*
+	frustum
+	- the six planes left, right, bottom, top, near, far of a view-projection matrix, each stored as (a, b, c, d)
+	  with a unit normal (a, b, c) pointing inwards, a point is inside when a * x + b * y + c * z + d >= 0
+	- is_row_vector follows the convention of the matrix (clip = v * M or clip = M * v),
+	  is_zero_to_one_depth selects a 0 <= z <= w clip volume (Direct3D) instead of -w <= z <= w (OpenGL)
+	- default constructed as the clip volume of the identity matrix
+*/
+template<class T>
+class frustum
+{
+public:
+	vec4<T> planes[6];
+
+public:
+	frustum() : frustum(mat4x4<T>::identity)
+	{
+	}
+
+	explicit frustum(const mat4x4<T>& view_projection, bool is_row_vector = true, bool is_zero_to_one_depth = true)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of frustum must be a floating-point type!");
+		//Clip coordinate k is the dot product of the point with column k (row vectors) or row k (column vectors)
+		vec4<T> clip[4];
+		for (size_t k = 0; k < 4; k++)
+		{
+			clip[k] = is_row_vector ?
+				vec4<T>(view_projection.unchecked(0, k), view_projection.unchecked(1, k), view_projection.unchecked(2, k), view_projection.unchecked(3, k)) :
+				vec4<T>(view_projection.unchecked(k, 0), view_projection.unchecked(k, 1), view_projection.unchecked(k, 2), view_projection.unchecked(k, 3));
+		}
+		planes[0] = clip[3] + clip[0];
+		planes[1] = clip[3] - clip[0];
+		planes[2] = clip[3] + clip[1];
+		planes[3] = clip[3] - clip[1];
+		planes[4] = is_zero_to_one_depth ? clip[2] : clip[3] + clip[2];
+		planes[5] = clip[3] - clip[2];
+		for (vec4<T>& plane : planes)
+		{
+			T length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			if (length > FLOATING_POINT_THRESHOLD)
+			{
+				plane = plane / length;
+			}
+		}
+	}
+
+public:
+	const T* ptr() const
+	{
+		return &planes[0].x;
+	}
+
+	T distance(size_t index, vec3<T> point) const
+	{
+		MATH_CHECK_INDEX(index >= 6, "frustum plane index out of range!");
+		const vec4<T>& plane = planes[index];
+		return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+	}
+
+	bool contains(vec3<T> point) const
+	{
+		for (size_t k = 0; k < 6; k++)
+		{
+			if (distance(k, point) < 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//False only when the volume is entirely outside one plane, a volume near a corner may pass without touching the frustum
+	bool intersects_sphere(vec3<T> center, T radius) const
+	{
+		for (size_t k = 0; k < 6; k++)
+		{
+			if (distance(k, center) + radius < 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool intersects_aabb(vec3<T> min, vec3<T> max) const
+	{
+		vec3<T> center((min.x + max.x) * static_cast<T>(0.5), (min.y + max.y) * static_cast<T>(0.5), (min.z + max.z) * static_cast<T>(0.5));
+		vec3<T> extent((max.x - min.x) * static_cast<T>(0.5), (max.y - min.y) * static_cast<T>(0.5), (max.z - min.z) * static_cast<T>(0.5));
+		for (size_t k = 0; k < 6; k++)
+		{
+			const vec4<T>& plane = planes[k];
+			T radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+			if (distance(k, center) + radius < 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/*
+	cull_spheres / cull_aabbs
+	- test SoA arrays of bounding spheres (centers, radii) or boxes (mins, maxs) against the frustum with the same
+	  conservative test as intersects_sphere / intersects_aabb, returns the number of visible volumes
+	- bit i % 64 of visible_mask[i / 64] is set when volume i is visible, visible_mask must hold (count + 63) / 64 words
+	  and is cleared first, the std::vector overloads write the visible indices in increasing order instead
+	- float arrays run 4 (SSE) or 8 (AVX2) volumes at a time, arrays above PARALLEL_MATRIX_GRAIN are split across threads
+	- throws std::invalid_argument when the soa containers differ in size
+*/
+template<class T, class Kernel>
+inline size_t cull_parallel(const frustum<T>& view, const T* const* volumes, size_t count, uint64_t* visible_mask, Kernel kernel)
+{
+	for (size_t i = 0; i < (count + 63) / 64; i++)
+	{
+		visible_mask[i] = 0;
+	}
+	//PARALLEL_MATRIX_GRAIN is a multiple of 64, chunks never share a mask word
+	std::atomic<size_t> visible(0);
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		visible += kernel(view.ptr(), volumes, begin, end, visible_mask);
+	});
+	return visible;
+}
+
+template<class T>
+inline size_t cull_spheres(const frustum<T>& view, const vec3_soa<T>& centers, const soa_array<T>& radii, uint64_t* visible_mask)
+{
+	check_soa_size(centers.size(), radii.size());
+	const T* spheres[] = { centers.x.data(), centers.y.data(), centers.z.data(), radii.data() };
+	return cull_parallel(view, spheres, centers.size(), visible_mask, kernel_cull_spheres_scalar<T>);
+}
+
+inline size_t cull_spheres(const frustum<float>& view, const vec3_soa<float>& centers, const soa_array<float>& radii, uint64_t* visible_mask)
+{
+	check_soa_size(centers.size(), radii.size());
+	const float* spheres[] = { centers.x.data(), centers.y.data(), centers.z.data(), radii.data() };
+	return cull_parallel(view, spheres, centers.size(), visible_mask, batch_kernels().cull_spheresf);
+}
+
+template<class T>
+inline size_t cull_spheres(const frustum<T>& view, const vec3_soa<T>& centers, const soa_array<T>& radii, std::vector<size_t>& visible)
+{
+	std::vector<uint64_t> visible_mask((centers.size() + 63) / 64);
+	cull_spheres(view, centers, radii, visible_mask.data());
+	mask_indices(visible_mask.data(), centers.size(), visible);
+	return visible.size();
+}
+
+template<class T>
+inline size_t cull_aabbs(const frustum<T>& view, const vec3_soa<T>& mins, const vec3_soa<T>& maxs, uint64_t* visible_mask)
+{
+	check_soa_size(mins.size(), maxs.size());
+	const T* boxes[] = { mins.x.data(), mins.y.data(), mins.z.data(), maxs.x.data(), maxs.y.data(), maxs.z.data() };
+	return cull_parallel(view, boxes, mins.size(), visible_mask, kernel_cull_boxes_scalar<T>);
+}
+
+inline size_t cull_aabbs(const frustum<float>& view, const vec3_soa<float>& mins, const vec3_soa<float>& maxs, uint64_t* visible_mask)
+{
+	check_soa_size(mins.size(), maxs.size());
+	const float* boxes[] = { mins.x.data(), mins.y.data(), mins.z.data(), maxs.x.data(), maxs.y.data(), maxs.z.data() };
+	return cull_parallel(view, boxes, mins.size(), visible_mask, batch_kernels().cull_boxesf);
+}
+
+template<class T>
+inline size_t cull_aabbs(const frustum<T>& view, const vec3_soa<T>& mins, const vec3_soa<T>& maxs, std::vector<size_t>& visible)
+{
+	std::vector<uint64_t> visible_mask((mins.size() + 63) / 64);
+	cull_aabbs(view, mins, maxs, visible_mask.data());
+	mask_indices(visible_mask.data(), mins.size(), visible);
+	return visible.size();
+}
+
+MATH_EXECUTION_OVERLOAD(cull_spheres)
+MATH_EXECUTION_OVERLOAD(cull_aabbs)
+
+#endif // !__FRUSTUM__
@@ -0,0 +1,324 @@
+#pragma once
+
+#ifndef __GRID__
+#define __GRID__
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "parallel.hpp"
+#include "batch.hpp"
+
+template<class V>
+class hash_grid;
+
+using hash_grid2f = hash_grid<vec2<float>>;
+using hash_grid2d = hash_grid<vec2<double>>;
+using hash_grid2ld = hash_grid<vec2<long double>>;
+
+using hash_grid3f = hash_grid<vec3<float>>;
+using hash_grid3d = hash_grid<vec3<double>>;
+using hash_grid3ld = hash_grid<vec3<long double>>;
+
+template<class V>
+struct hash_grid_traits;
+
+template<class T>
+struct hash_grid_traits<vec2<T>>
+{
+	using value_type = T;
+	static const size_t dimension = 2;
+};
+
+template<class T>
+struct hash_grid_traits<vec3<T>>
+{
+	using value_type = T;
+	static const size_t dimension = 3;
+};
+
+/*
+	hash_grid
+	- a uniform grid over vec2 or vec3 positions for neighbour search, position p lies in cell floor(p / cell_size),
+	  cells are hashed into a table of the next power of two above the position count
+	- build is a parallel counting sort of the positions by hash bucket: the positions of bucket b are stored together
+	  in point(cell_start[b]) to point(cell_start[b + 1] - 1), rebuilding every step is cheaper than a tree
+	- the hash keeps cells along x in consecutive buckets, a query scans one contiguous run of positions per row of
+	  cells its radius overlaps, several cells may share a bucket, each position is reported once from its own cell
+	- queries in grid order, point(0) to point(size() - 1), touch the same buckets one after another
+	- throws std::invalid_argument for a cell size that is not positive, std::length_error above 2^32 - 1 positions
+*/
+template<class V>
+class hash_grid
+{
+public:
+	using value_type = typename hash_grid_traits<V>::value_type;
+	static const size_t dimension = hash_grid_traits<V>::dimension;
+
+private:
+	using T = value_type;
+
+	T size_of_cell;
+	T inverse_cell_size;
+	std::vector<V> positions;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> cell_start;
+	//Bucket and rank within its bucket of each input position, kept between builds
+	std::vector<uint32_t> buckets;
+	std::vector<uint32_t> ranks;
+	std::vector<std::atomic<uint32_t>> bucket_counts;
+
+public:
+	explicit hash_grid(T cell_size = 1) : size_of_cell(cell_size), inverse_cell_size(static_cast<T>(1.0) / cell_size), cell_start(2, 0)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of hash_grid must be a floating-point type!");
+		if (!(cell_size > 0)) { throw std::invalid_argument("hash_grid cell size must be positive!"); }
+	}
+
+public:
+	size_t size() const
+	{
+		return positions.size();
+	}
+
+	T cell_size() const
+	{
+		return size_of_cell;
+	}
+
+	size_t bucket_count() const
+	{
+		return cell_start.size() - 1;
+	}
+
+	//Position at position index of the grid ordering and its index in the built array
+	V point(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= positions.size(), "hash_grid point index out of range!");
+		return positions[index];
+	}
+
+	size_t primitive(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= indices.size(), "hash_grid point index out of range!");
+		return indices[index];
+	}
+
+	//Cell coordinates of position
+	void cell(V position, int64_t (&out)[dimension]) const
+	{
+		V scaled = floor(position * inverse_cell_size);
+		for (size_t k = 0; k < dimension; k++)
+		{
+			out[k] = static_cast<int64_t>(scaled.unchecked(k));
+		}
+	}
+
+	//Cells along x are consecutive buckets, a row of cells is one contiguous run of positions
+	size_t bucket(const int64_t (&cell)[dimension]) const
+	{
+		const uint64_t primes[] = { 73856093ULL, 19349663ULL, 83492791ULL };
+		uint64_t hash = 0;
+		for (size_t k = 1; k < dimension; k++)
+		{
+			hash ^= static_cast<uint64_t>(cell[k]) * primes[k];
+		}
+		//Fold the high bits in, the table index keeps only the low ones
+		hash ^= hash >> 29;
+		return static_cast<size_t>((hash + static_cast<uint64_t>(cell[0])) & static_cast<uint64_t>(bucket_count() - 1));
+	}
+
+	void build(const V* points, size_t count)
+	{
+		if (count > static_cast<size_t>(UINT32_MAX)) { throw std::length_error("hash_grid point count too large!"); }
+		size_t table_size = 1;
+		while (table_size < count)
+		{
+			table_size *= 2;
+		}
+		if (bucket_counts.size() != table_size)
+		{
+			bucket_counts = std::vector<std::atomic<uint32_t>>(table_size);
+		}
+		cell_start.resize(table_size + 1);
+		positions.resize(count);
+		indices.resize(count);
+		buckets.resize(count);
+		ranks.resize(count);
+
+		parallel_for(table_size, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t b = begin; b < end; b++)
+			{
+				bucket_counts[b].store(0, std::memory_order_relaxed);
+			}
+		});
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			int64_t coordinates[dimension];
+			for (size_t i = begin; i < end; i++)
+			{
+				cell(points[i], coordinates);
+				buckets[i] = static_cast<uint32_t>(bucket(coordinates));
+				ranks[i] = bucket_counts[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		//Exclusive scan of the counts, chunk totals first so that the chunks scan in parallel
+		size_t chunks = (table_size + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+		std::vector<uint32_t> chunk_start(chunks + 1, 0);
+		parallel_for(table_size, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			uint32_t sum = 0;
+			for (size_t b = begin; b < end; b++)
+			{
+				sum += bucket_counts[b].load(std::memory_order_relaxed);
+			}
+			chunk_start[begin / PARALLEL_GRAIN + 1] = sum;
+		});
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+		{
+			chunk_start[chunk + 1] += chunk_start[chunk];
+		}
+		parallel_for(table_size, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			uint32_t sum = chunk_start[begin / PARALLEL_GRAIN];
+			for (size_t b = begin; b < end; b++)
+			{
+				cell_start[b] = sum;
+				sum += bucket_counts[b].load(std::memory_order_relaxed);
+			}
+		});
+		cell_start[table_size] = static_cast<uint32_t>(count);
+
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				size_t slot = cell_start[buckets[i]] + ranks[i];
+				positions[slot] = points[i];
+				indices[slot] = static_cast<uint32_t>(i);
+			}
+		});
+	}
+
+	/*
+		for_each_neighbor / within
+		- for_each_neighbor calls func(index, sqr_distance) for every position at most radius from point,
+		  within appends their indices to out, in no particular order, and returns how many were appended
+		- the batch overload writes the positions near query i to indices[offsets[i], offsets[i + 1]), offsets holds
+		  count + 1 entries, the overload without points queries every position of the grid, in grid order, which
+		  includes the position itself, queries above PARALLEL_MATRIX_GRAIN are split across threads
+		- a radius of up to cell_size scans at most 3^(dimension - 1) rows of at most 3 cells
+	*/
+	template<class F>
+	void for_each_neighbor(V point, T radius, F func) const
+	{
+		if (positions.empty())
+		{
+			return;
+		}
+		int64_t low[dimension], high[dimension], current[dimension], own[dimension];
+		cell(point - V(radius), low);
+		cell(point + V(radius), high);
+		T sqr_radius = radius * radius;
+		for (size_t k = 0; k < dimension; k++)
+		{
+			current[k] = low[k];
+		}
+		//One row of cells along x at a time, it wraps around the end of the table at most once
+		uint64_t row_width = static_cast<uint64_t>(high[0] - low[0]) + 1;
+		size_t width = row_width < bucket_count() ? static_cast<size_t>(row_width) : bucket_count();
+		for (;;)
+		{
+			size_t first = bucket(current);
+			size_t last = first + width;
+			for (size_t part = 0; part < 2; part++)
+			{
+				size_t begin = part == 0 ? first : 0;
+				size_t end = part == 0 ? (last < bucket_count() ? last : bucket_count()) : (last > bucket_count() ? last - bucket_count() : 0);
+				for (size_t i = cell_start[begin]; i < cell_start[end]; i++)
+				{
+					T sqr_distance = sqr_length(positions[i] - point);
+					if (sqr_distance > sqr_radius)
+					{
+						continue;
+					}
+					cell(positions[i], own);
+					if (own[0] >= low[0] && own[0] <= high[0] && std::equal(own + 1, own + dimension, current + 1))
+					{
+						func(static_cast<size_t>(indices[i]), sqr_distance);
+					}
+				}
+			}
+			size_t k = 1;
+			while (k < dimension && current[k] == high[k])
+			{
+				current[k] = low[k];
+				k++;
+			}
+			if (k == dimension)
+			{
+				return;
+			}
+			current[k]++;
+		}
+	}
+
+	size_t within(V point, T radius, std::vector<size_t>& out) const
+	{
+		size_t size = out.size();
+		for_each_neighbor(point, radius, [&](size_t index, T) { out.push_back(index); });
+		return out.size() - size;
+	}
+
+	void within(const V* points, size_t count, T radius, std::vector<size_t>& offsets, std::vector<size_t>& indices) const
+	{
+		within_batch(count, radius, offsets, indices, [&](size_t i) { return points[i]; }, [](size_t i) { return i; });
+	}
+
+	void within(T radius, std::vector<size_t>& offsets, std::vector<size_t>& indices) const
+	{
+		within_batch(size(), radius, offsets, indices, [&](size_t i) { return positions[i]; }, [&](size_t i) { return static_cast<size_t>(this->indices[i]); });
+	}
+
+private:
+	//Query i is the position query_point(i), its results go to slot query_slot(i) of offsets
+	template<class P, class S>
+	void within_batch(size_t count, T radius, std::vector<size_t>& offsets, std::vector<size_t>& indices, P query_point, S query_slot) const
+	{
+		size_t chunks = (count + PARALLEL_MATRIX_GRAIN - 1) / PARALLEL_MATRIX_GRAIN;
+		std::vector<std::vector<size_t>> chunk_indices(chunks);
+		offsets.assign(count + 1, 0);
+		parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+		{
+			std::vector<size_t>& local = chunk_indices[begin / PARALLEL_MATRIX_GRAIN];
+			for (size_t i = begin; i < end; i++)
+			{
+				offsets[query_slot(i) + 1] = within(query_point(i), radius, local);
+			}
+		});
+		for (size_t i = 0; i < count; i++)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+		indices.resize(offsets[count]);
+		parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+		{
+			const std::vector<size_t>& local = chunk_indices[begin / PARALLEL_MATRIX_GRAIN];
+			size_t source = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				size_t slot = query_slot(i);
+				size_t length = offsets[slot + 1] - offsets[slot];
+				std::copy(local.begin() + source, local.begin() + source + length, indices.begin() + offsets[slot]);
+				source += length;
+			}
+		});
+	}
+};
+
+#endif // !__GRID__
@@ -0,0 +1,206 @@
+#pragma once
+
+#ifndef __HIERARCHY__
+#define __HIERARCHY__
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#include "batch.hpp"
+
+//Parent index of a root node
+#define HIERARCHY_ROOT static_cast<size_t>(-1)
+
+template<class T>
+class transform_hierarchy;
+
+using transform_hierarchyf = transform_hierarchy<float>;
+using transform_hierarchyd = transform_hierarchy<double>;
+using transform_hierarchyld = transform_hierarchy<long double>;
+
+/*
+	compose_local
+	- the local matrix that scales, then rotates around axis, then translates, built from scale / rotate / translate
+*/
+template<class T>
+inline mat4x4<T> compose_local(vec3<T> translation, T radian, vec3<T> axis, vec3<T> scaling, bool is_row_vector = true)
+{
+	if (is_row_vector)
+	{
+		return scale(scaling) * rotate(radian, axis, true) * translate(translation, true);
+	}
+	return translate(translation, false) * rotate(radian, axis, false) * scale(scaling);
+}
+
+/*
+	transform_hierarchy
+	- nodes are stored in breadth-first order: every node comes after its parent and the nodes of one depth are contiguous,
+	  add() throws std::invalid_argument for a node that would break the order
+	- world is local * parent world for row vectors, parent world * local for column vectors, roots have world = local
+	- set_local only marks the node dirty, update() recomputes the worlds of dirty nodes and of everything below them,
+	  one depth level at a time, each level as a parallel batch
+	- world() returns the value of the last update()
+*/
+template<class T>
+class transform_hierarchy
+{
+private:
+	std::vector<size_t> parents;
+	std::vector<mat4x4<T>> locals;
+	std::vector<mat4x4<T>> worlds;
+	//Written concurrently for distinct nodes, so not std::vector<bool>
+	std::vector<uint8_t> dirty;
+	//Nodes of depth d are [levels[d], levels[d + 1])
+	std::vector<size_t> levels;
+	size_t first_dirty_level;
+	bool is_row_vector;
+
+public:
+	explicit transform_hierarchy(bool is_row_vector = true) : levels{ 0 }, first_dirty_level(0), is_row_vector(is_row_vector)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of transform_hierarchy must be a floating-point type!");
+	}
+
+public:
+	size_t size() const
+	{
+		return parents.size();
+	}
+
+	size_t depth_count() const
+	{
+		return levels.size() - 1;
+	}
+
+	void reserve(size_t size)
+	{
+		parents.reserve(size);
+		locals.reserve(size);
+		worlds.reserve(size);
+		dirty.reserve(size);
+	}
+
+	size_t add(size_t parent, const mat4x4<T>& local = mat4x4<T>::identity)
+	{
+		size_t depth = 0;
+		if (parent != HIERARCHY_ROOT)
+		{
+			if (parent >= size()) { throw std::invalid_argument("parent of the node does not exist!"); }
+			depth = this->depth(parent) + 1;
+		}
+		if (depth + 1 < depth_count()) { throw std::invalid_argument("nodes must be added in breadth-first order!"); }
+
+		if (depth == depth_count())
+		{
+			levels.push_back(size());
+		}
+		levels.back()++;
+		parents.push_back(parent);
+		locals.push_back(local);
+		worlds.push_back(local);
+		dirty.push_back(1);
+		first_dirty_level = depth < first_dirty_level ? depth : first_dirty_level;
+		return size() - 1;
+	}
+
+	size_t parent(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= size(), "transform_hierarchy index out of range!");
+		return parents[index];
+	}
+
+	size_t depth(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= size(), "transform_hierarchy index out of range!");
+		return static_cast<size_t>(std::upper_bound(levels.begin() + 1, levels.end(), index) - levels.begin()) - 1;
+	}
+
+	const mat4x4<T>& local(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= size(), "transform_hierarchy index out of range!");
+		return locals[index];
+	}
+
+	const mat4x4<T>& world(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= size(), "transform_hierarchy index out of range!");
+		return worlds[index];
+	}
+
+	bool is_dirty(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= size(), "transform_hierarchy index out of range!");
+		return dirty[index] != 0;
+	}
+
+	void set_local(size_t index, const mat4x4<T>& local)
+	{
+		MATH_CHECK_INDEX(index >= size(), "transform_hierarchy index out of range!");
+		locals[index] = local;
+		if (dirty[index] == 0)
+		{
+			dirty[index] = 1;
+			size_t depth = this->depth(index);
+			first_dirty_level = depth < first_dirty_level ? depth : first_dirty_level;
+		}
+	}
+
+	void set_local(size_t index, vec3<T> translation, T radian, vec3<T> axis, vec3<T> scaling = vec3<T>(1.0, 1.0, 1.0))
+	{
+		set_local(index, compose_local(translation, radian, axis, scaling, is_row_vector));
+	}
+
+	/*
+		update
+		- levels above the first dirty one are skipped, a node below is recomputed if it or its parent is dirty,
+		  its parent is one level up and already final
+		- returns the number of recomputed world matrices
+	*/
+	size_t update()
+	{
+		size_t depth_count = this->depth_count();
+		if (first_dirty_level >= depth_count)
+		{
+			return 0;
+		}
+
+		std::atomic<size_t> updated(0);
+		for (size_t depth = first_dirty_level; depth < depth_count; depth++)
+		{
+			size_t first = levels[depth];
+			parallel_for(levels[depth + 1] - first, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+			{
+				size_t chunk_updated = 0;
+				for (size_t i = first + begin; i < first + end; i++)
+				{
+					size_t parent = parents[i];
+					if (parent != HIERARCHY_ROOT && dirty[parent] != 0)
+					{
+						dirty[i] = 1;
+					}
+					if (dirty[i] == 0)
+					{
+						continue;
+					}
+					if (parent == HIERARCHY_ROOT)
+					{
+						worlds[i] = locals[i];
+					}
+					else
+					{
+						worlds[i] = is_row_vector ? locals[i] * worlds[parent] : worlds[parent] * locals[i];
+					}
+					chunk_updated++;
+				}
+				updated.fetch_add(chunk_updated);
+			});
+		}
+
+		std::fill(dirty.begin() + levels[first_dirty_level], dirty.end(), static_cast<uint8_t>(0));
+		first_dirty_level = depth_count;
+		return updated.load();
+	}
+};
+
+#endif // !__HIERARCHY__
@@ -0,0 +1,355 @@
+#pragma once
+
+#ifndef __KDTREE__
+#define __KDTREE__
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "aabb.hpp"
+#include "parallel.hpp"
+#include "batch.hpp"
+
+#define KDTREE_LEAF_SIZE 16
+//Index of a kdtree_neighbor that was not found
+#define KDTREE_NO_POINT static_cast<size_t>(-1)
+//Deeper than any tree of at most 2^32 - 1 points
+#define KDTREE_MAX_DEPTH 64
+
+template<class T>
+class kdtree;
+
+using kdtreef = kdtree<float>;
+using kdtreed = kdtree<double>;
+using kdtreeld = kdtree<long double>;
+
+template<class T>
+struct kdtree_neighbor
+{
+	size_t index;
+	T sqr_distance;
+};
+
+/*
+	kdtree
+	- a static k-d tree over a point cloud, answers k-nearest-neighbour and radius queries by sqr_length distance
+	- implicit layout: the points are reordered so that the node of range [begin, end) is its median
+	  begin + (end - begin) / 2, with children [begin, median) and [median + 1, end), ranges of at most leaf_size
+	  points are leaves, no child links are stored
+	- each node splits at the median along the longest axis of its cell, levels above PARALLEL_GRAIN points split their
+	  nodes across threads, the subtrees below are built in parallel
+	- queries keep their state on the stack: nearest keeps a bounded max-heap in the caller's out array and allocates nothing
+	- throws std::length_error above 2^32 - 1 points
+*/
+template<class T>
+class kdtree
+{
+private:
+	struct entry
+	{
+		vec3<T> point;
+		uint32_t index;
+	};
+
+	struct build_range
+	{
+		size_t begin, end;
+		aabb3<T> cell;
+	};
+
+	//A node still to visit with the distance from the query to its cell, per axis and squared in total
+	struct pending
+	{
+		size_t begin, end;
+		vec3<T> offset;
+		T sqr_distance;
+	};
+
+	std::vector<entry> entries;
+	std::vector<uint8_t> axes;
+	size_t leaf_size;
+
+public:
+	kdtree() : leaf_size(KDTREE_LEAF_SIZE)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of kdtree must be a floating-point type!");
+	}
+
+public:
+	size_t size() const
+	{
+		return entries.size();
+	}
+
+	size_t depth() const
+	{
+		size_t depth = 0;
+		for (size_t count = entries.size(); count > leaf_size; count /= 2)
+		{
+			depth++;
+		}
+		return depth;
+	}
+
+	//Point at position index of the tree ordering and its index in the built array
+	vec3<T> point(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= entries.size(), "kdtree point index out of range!");
+		return entries[index].point;
+	}
+
+	size_t primitive(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= entries.size(), "kdtree point index out of range!");
+		return entries[index].index;
+	}
+
+	void build(const vec3<T>* points, size_t count, size_t leaf_size = KDTREE_LEAF_SIZE)
+	{
+		if (count > static_cast<size_t>(UINT32_MAX)) { throw std::length_error("kdtree point count too large!"); }
+		this->leaf_size = leaf_size > 0 ? leaf_size : 1;
+		entries.resize(count);
+		axes.assign(count, 0);
+		if (count == 0)
+		{
+			return;
+		}
+
+		size_t chunks = (count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+		std::vector<aabb3<T>> chunk_cells(chunks);
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			aabb3<T>& cell = chunk_cells[begin / PARALLEL_GRAIN];
+			for (size_t i = begin; i < end; i++)
+			{
+				entries[i] = { points[i], static_cast<uint32_t>(i) };
+				cell.expand(points[i]);
+			}
+		});
+		aabb3<T> root;
+		for (const aabb3<T>& cell : chunk_cells)
+		{
+			root.expand(cell);
+		}
+
+		//Levels above PARALLEL_GRAIN points split their nodes in parallel, smaller nodes become subtree jobs
+		std::vector<build_range> level(1, build_range{ 0, count, root }), next, jobs;
+		while (!level.empty())
+		{
+			next.assign(level.size() * 2, build_range{ 0, 0, aabb3<T>() });
+			parallel_for(level.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					split(level[i], next[i * 2], next[i * 2 + 1]);
+				}
+			});
+			level.clear();
+			for (const build_range& range : next)
+			{
+				if (range.end - range.begin > PARALLEL_GRAIN)
+				{
+					level.push_back(range);
+				}
+				else if (range.end - range.begin > this->leaf_size)
+				{
+					jobs.push_back(range);
+				}
+			}
+		}
+		parallel_for(jobs.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				build_subtree(jobs[i]);
+			}
+		});
+	}
+
+	/*
+		nearest
+		- the k points closest to point with a distance below max_distance, written to out in increasing distance,
+		  returns how many were found, the remaining entries of out[0, k) are { KDTREE_NO_POINT, infinity }
+		- the batch overload answers query i into out[i * k, i * k + k), queries above PARALLEL_MATRIX_GRAIN are
+		  split across threads
+	*/
+	size_t nearest(vec3<T> point, size_t k, kdtree_neighbor<T>* out, T max_distance = std::numeric_limits<T>::infinity()) const
+	{
+		auto is_closer = [](const kdtree_neighbor<T>& neighbor1, const kdtree_neighbor<T>& neighbor2) { return neighbor1.sqr_distance < neighbor2.sqr_distance; };
+		size_t found = 0;
+		T sqr_radius = max_distance * max_distance;
+		if (k > 0)
+		{
+			search(point, sqr_radius, [&](const entry& candidate)
+			{
+				T sqr_distance = sqr_length(candidate.point - point);
+				if (sqr_distance >= sqr_radius)
+				{
+					return;
+				}
+				if (found == k)
+				{
+					std::pop_heap(out, out + found, is_closer);
+					found--;
+				}
+				out[found++] = { static_cast<size_t>(candidate.index), sqr_distance };
+				std::push_heap(out, out + found, is_closer);
+				if (found == k)
+				{
+					sqr_radius = out[0].sqr_distance;
+				}
+			});
+		}
+		std::sort_heap(out, out + found, is_closer);
+		for (size_t i = found; i < k; i++)
+		{
+			out[i] = { KDTREE_NO_POINT, std::numeric_limits<T>::infinity() };
+		}
+		return found;
+	}
+
+	void nearest(const vec3<T>* points, size_t count, size_t k, kdtree_neighbor<T>* out, T max_distance = std::numeric_limits<T>::infinity()) const
+	{
+		parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				nearest(points[i], k, out + i * k, max_distance);
+			}
+		});
+	}
+
+	/*
+		within
+		- appends the indices of the points at most radius from point to out, in no particular order,
+		  returns how many were appended
+		- the batch overload writes the points of query i to indices[offsets[i], offsets[i + 1]), offsets holds count + 1
+		  entries, queries above PARALLEL_MATRIX_GRAIN are split across threads
+	*/
+	size_t within(vec3<T> point, T radius, std::vector<size_t>& out) const
+	{
+		size_t size = out.size();
+		T sqr_radius = radius * radius;
+		search(point, sqr_radius, [&](const entry& candidate)
+		{
+			if (sqr_length(candidate.point - point) <= sqr_radius)
+			{
+				out.push_back(candidate.index);
+			}
+		});
+		return out.size() - size;
+	}
+
+	void within(const vec3<T>* points, size_t count, T radius, std::vector<size_t>& offsets, std::vector<size_t>& indices) const
+	{
+		size_t chunks = (count + PARALLEL_MATRIX_GRAIN - 1) / PARALLEL_MATRIX_GRAIN;
+		std::vector<std::vector<size_t>> chunk_indices(chunks);
+		offsets.assign(count + 1, 0);
+		parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+		{
+			std::vector<size_t>& local = chunk_indices[begin / PARALLEL_MATRIX_GRAIN];
+			for (size_t i = begin; i < end; i++)
+			{
+				offsets[i + 1] = within(points[i], radius, local);
+			}
+		});
+		for (size_t i = 0; i < count; i++)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+		indices.resize(offsets[count]);
+		parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t)
+		{
+			const std::vector<size_t>& local = chunk_indices[begin / PARALLEL_MATRIX_GRAIN];
+			std::copy(local.begin(), local.end(), indices.begin() + offsets[begin]);
+		});
+	}
+
+private:
+	void split(const build_range& range, build_range& first, build_range& second)
+	{
+		size_t middle = range.begin + (range.end - range.begin) / 2;
+		vec3<T> extent = range.cell.size();
+		size_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		std::nth_element(entries.begin() + range.begin, entries.begin() + middle, entries.begin() + range.end,
+			[axis](const entry& entry1, const entry& entry2) { return entry1.point.unchecked(axis) < entry2.point.unchecked(axis); });
+		axes[middle] = static_cast<uint8_t>(axis);
+		T position = entries[middle].point.unchecked(axis);
+		first = { range.begin, middle, range.cell };
+		first.cell.max.unchecked(axis) = position;
+		second = { middle + 1, range.end, range.cell };
+		second.cell.min.unchecked(axis) = position;
+	}
+
+	void build_subtree(const build_range& range)
+	{
+		if (range.end - range.begin <= leaf_size)
+		{
+			return;
+		}
+		build_range first, second;
+		split(range, first, second);
+		build_subtree(first);
+		build_subtree(second);
+	}
+
+	//Calls visit(entry) for every point of the nodes whose cell lies within sqr_radius of point, visit may shrink sqr_radius
+	template<class F>
+	void search(vec3<T> point, T& sqr_radius, F visit) const
+	{
+		pending stack[KDTREE_MAX_DEPTH];
+		size_t top = 0;
+		pending current = { 0, entries.size(), vec3<T>(), 0 };
+		for (;;)
+		{
+			if (current.end - current.begin <= leaf_size)
+			{
+				for (size_t i = current.begin; i < current.end; i++)
+				{
+					visit(entries[i]);
+				}
+			}
+			else
+			{
+				size_t middle = current.begin + (current.end - current.begin) / 2;
+				const entry& median = entries[middle];
+				visit(median);
+				size_t axis = axes[middle];
+				T difference = point.unchecked(axis) - median.point.unchecked(axis);
+				//The far cell is at least as far as the near one with its offset along axis replaced by the plane distance
+				pending beyond = current;
+				beyond.sqr_distance += difference * difference - current.offset.unchecked(axis) * current.offset.unchecked(axis);
+				beyond.offset.unchecked(axis) = difference;
+				if (difference < 0)
+				{
+					beyond.begin = middle + 1;
+					current.end = middle;
+				}
+				else
+				{
+					beyond.end = middle;
+					current.begin = middle + 1;
+				}
+				if (beyond.sqr_distance <= sqr_radius)
+				{
+					stack[top++] = beyond;
+				}
+				continue;
+			}
+			do
+			{
+				if (top == 0)
+				{
+					return;
+				}
+				top--;
+			} while (stack[top].sqr_distance > sqr_radius);
+			current = stack[top];
+		}
+	}
+};
+
+#endif // !__KDTREE__
@@ -0,0 +1,2361 @@
+#pragma once
+
+#ifndef __KERNELS__
+#define __KERNELS__
+
+#include <cmath>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "simd.hpp"
+
+/*
+	kernels
+	- raw float batch kernels, one variant per instruction set tier
+	- vec4 arrays are 4 packed floats per element, mat4x4 arrays are 16 packed row-major floats per element
+	- out may alias the input of the same element (in place)
+	- never call the tiered variants directly, go through batch_kernels() in dispatch.hpp
+*/
+
+inline void kernel_transform_vec4f_scalar(const float* in, float* out, size_t count, const float* mat, bool is_row_vector)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		float x = in[i * 4 + 0], y = in[i * 4 + 1], z = in[i * 4 + 2], w = in[i * 4 + 3];
+		for (size_t j = 0; j < 4; j++)
+		{
+			out[i * 4 + j] = is_row_vector ?
+				x * mat[j] + y * mat[4 + j] + z * mat[8 + j] + w * mat[12 + j] :
+				mat[j * 4] * x + mat[j * 4 + 1] * y + mat[j * 4 + 2] * z + mat[j * 4 + 3] * w;
+		}
+	}
+}
+
+/*
+	kernel_transform_vec3f
+	- out = x * basis[0..3] + y * basis[4..7] + z * basis[8..11] + w * basis[12..15], basis rows as in a row-vector matrix
+	- reads and writes 3 floats per element, strides are in bytes
+	- with perspective_divide the xyz result is divided by its transformed w
+*/
+inline void kernel_transform_vec3f_scalar(const char* in, size_t in_stride, char* out, size_t out_stride, size_t count, const float* basis, float w, bool perspective_divide)
+{
+	float c0 = basis[12] * w, c1 = basis[13] * w, c2 = basis[14] * w, c3 = basis[15] * w;
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* v = reinterpret_cast<const float*>(in + i * in_stride);
+		float* r = reinterpret_cast<float*>(out + i * out_stride);
+		float x = v[0], y = v[1], z = v[2];
+		float rx = x * basis[0] + y * basis[4] + z * basis[8] + c0;
+		float ry = x * basis[1] + y * basis[5] + z * basis[9] + c1;
+		float rz = x * basis[2] + y * basis[6] + z * basis[10] + c2;
+		if (perspective_divide)
+		{
+			float rw = x * basis[3] + y * basis[7] + z * basis[11] + c3;
+			rx /= rw; ry /= rw; rz /= rw;
+		}
+		r[0] = rx; r[1] = ry; r[2] = rz;
+	}
+}
+
+inline void kernel_normalize_vec4f_scalar(float* data, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		float* v = data + i * 4;
+		float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+		v[0] /= length; v[1] /= length; v[2] /= length; v[3] /= length;
+	}
+}
+
+inline void kernel_dot_vec4f_scalar(const float* vecs1, const float* vecs2, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = vecs1 + i * 4;
+		const float* b = vecs2 + i * 4;
+		out[i] = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+	}
+}
+
+//a_step / b_step are the floats between consecutive matrices, 0 repeats one shared matrix
+inline void kernel_multiply_mat4x4f_strided_scalar(const float* mats1, size_t a_step, const float* mats2, size_t b_step, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = mats1 + i * a_step;
+		const float* b = mats2 + i * b_step;
+		float ret[16];
+		for (size_t row = 0; row < 4; row++)
+		{
+			for (size_t col = 0; col < 4; col++)
+			{
+				ret[row * 4 + col] = a[row * 4] * b[col] + a[row * 4 + 1] * b[4 + col] + a[row * 4 + 2] * b[8 + col] + a[row * 4 + 3] * b[12 + col];
+			}
+		}
+		for (size_t j = 0; j < 16; j++)
+		{
+			out[i * 16 + j] = ret[j];
+		}
+	}
+}
+
+inline void kernel_multiply_mat4x4f_scalar(const float* mats1, const float* mats2, float* out, size_t count)
+{
+	kernel_multiply_mat4x4f_strided_scalar(mats1, 16, mats2, 16, out, count);
+}
+
+//out[i] = left * mats[i]
+inline void kernel_multiply_left_mat4x4f_scalar(const float* left, const float* mats, float* out, size_t count)
+{
+	kernel_multiply_mat4x4f_strided_scalar(left, 0, mats, 16, out, count);
+}
+
+//out[i] = mats[i] * right
+inline void kernel_multiply_right_mat4x4f_scalar(const float* mats, const float* right, float* out, size_t count)
+{
+	kernel_multiply_mat4x4f_strided_scalar(mats, 16, right, 0, out, count);
+}
+
+/*
+	kernel_inverse_mat4x4_lanes / kernel_inverse_mat3x3_lanes
+	- the cofactor schemes of mat4x4::inverse and mat3x3::inverse, written once for any lane type L
+	- L is a scalar (one problem) or simd_lanes4f / simd_lanes8f (one problem per lane)
+	- e and d are the row-major elements, d is only meaningful where det is not singular
+*/
+template<class L>
+inline void kernel_inverse_mat4x4_lanes(const L* e, L* d, L& det)
+{
+	L v0 = e[8] * e[13] - e[9] * e[12];
+	L v1 = e[8] * e[14] - e[10] * e[12];
+	L v2 = e[8] * e[15] - e[11] * e[12];
+	L v3 = e[9] * e[14] - e[10] * e[13];
+	L v4 = e[9] * e[15] - e[11] * e[13];
+	L v5 = e[10] * e[15] - e[11] * e[14];
+
+	L t00 = (v5 * e[5] - v4 * e[6] + v3 * e[7]);
+	L t10 = -(v5 * e[4] - v2 * e[6] + v1 * e[7]);
+	L t20 = (v4 * e[4] - v2 * e[5] + v0 * e[7]);
+	L t30 = -(v3 * e[4] - v1 * e[5] + v0 * e[6]);
+
+	det = t00 * e[0] + t10 * e[1] + t20 * e[2] + t30 * e[3];
+	L det_inv = L(1.0) / det;
+
+	d[0] = t00 * det_inv;
+	d[4] = t10 * det_inv;
+	d[8] = t20 * det_inv;
+	d[12] = t30 * det_inv;
+
+	d[1] = -(v5 * e[1] - v4 * e[2] + v3 * e[3]) * det_inv;
+	d[5] = (v5 * e[0] - v2 * e[2] + v1 * e[3]) * det_inv;
+	d[9] = -(v4 * e[0] - v2 * e[1] + v0 * e[3]) * det_inv;
+	d[13] = (v3 * e[0] - v1 * e[1] + v0 * e[2]) * det_inv;
+
+	v0 = e[4] * e[13] - e[5] * e[12];
+	v1 = e[4] * e[14] - e[6] * e[12];
+	v2 = e[4] * e[15] - e[7] * e[12];
+	v3 = e[5] * e[14] - e[6] * e[13];
+	v4 = e[5] * e[15] - e[7] * e[13];
+	v5 = e[6] * e[15] - e[7] * e[14];
+
+	d[2] = (v5 * e[1] - v4 * e[2] + v3 * e[3]) * det_inv;
+	d[6] = -(v5 * e[0] - v2 * e[2] + v1 * e[3]) * det_inv;
+	d[10] = (v4 * e[0] - v2 * e[1] + v0 * e[3]) * det_inv;
+	d[14] = -(v3 * e[0] - v1 * e[1] + v0 * e[2]) * det_inv;
+
+	v0 = e[9] * e[4] - e[8] * e[5];
+	v1 = e[10] * e[4] - e[8] * e[6];
+	v2 = e[11] * e[4] - e[8] * e[7];
+	v3 = e[10] * e[5] - e[9] * e[6];
+	v4 = e[11] * e[5] - e[9] * e[7];
+	v5 = e[11] * e[6] - e[10] * e[7];
+
+	d[3] = -(v5 * e[1] - v4 * e[2] + v3 * e[3]) * det_inv;
+	d[7] = (v5 * e[0] - v2 * e[2] + v1 * e[3]) * det_inv;
+	d[11] = -(v4 * e[0] - v2 * e[1] + v0 * e[3]) * det_inv;
+	d[15] = (v3 * e[0] - v1 * e[1] + v0 * e[2]) * det_inv;
+}
+
+template<class L>
+inline void kernel_det_mat4x4_lanes(const L* e, L& det)
+{
+	L v0 = e[8] * e[13] - e[9] * e[12];
+	L v1 = e[8] * e[14] - e[10] * e[12];
+	L v2 = e[8] * e[15] - e[11] * e[12];
+	L v3 = e[9] * e[14] - e[10] * e[13];
+	L v4 = e[9] * e[15] - e[11] * e[13];
+	L v5 = e[10] * e[15] - e[11] * e[14];
+
+	L t00 = (v5 * e[5] - v4 * e[6] + v3 * e[7]);
+	L t10 = -(v5 * e[4] - v2 * e[6] + v1 * e[7]);
+	L t20 = (v4 * e[4] - v2 * e[5] + v0 * e[7]);
+	L t30 = -(v3 * e[4] - v1 * e[5] + v0 * e[6]);
+
+	det = t00 * e[0] + t10 * e[1] + t20 * e[2] + t30 * e[3];
+}
+
+template<class L>
+inline void kernel_inverse_mat3x3_lanes(const L* e, L* d, L& det)
+{
+	L i00 = e[4] * e[8] - e[5] * e[7];
+	L i01 = e[2] * e[7] - e[1] * e[8];
+	L i02 = e[1] * e[5] - e[2] * e[4];
+	L i10 = e[5] * e[6] - e[3] * e[8];
+	L i11 = e[0] * e[8] - e[2] * e[6];
+	L i12 = e[2] * e[3] - e[0] * e[5];
+	L i20 = e[3] * e[7] - e[4] * e[6];
+	L i21 = e[1] * e[6] - e[0] * e[7];
+	L i22 = e[0] * e[4] - e[1] * e[3];
+
+	det = e[0] * i00 + e[1] * i10 + e[2] * i20;
+	L det_inv = L(1.0) / det;
+
+	d[0] = i00 * det_inv; d[1] = i01 * det_inv; d[2] = i02 * det_inv;
+	d[3] = i10 * det_inv; d[4] = i11 * det_inv; d[5] = i12 * det_inv;
+	d[6] = i20 * det_inv; d[7] = i21 * det_inv; d[8] = i22 * det_inv;
+}
+
+template<class L>
+inline void kernel_det_mat3x3_lanes(const L* e, L& det)
+{
+	det = e[0] * (e[4] * e[8] - e[5] * e[7]) + e[1] * (e[5] * e[6] - e[3] * e[8]) + e[2] * (e[3] * e[7] - e[4] * e[6]);
+}
+
+template<class T>
+inline unsigned int lanes_abs_le_mask(T t, T threshold)
+{
+	return (t >= 0 ? t : -t) <= threshold ? 1u : 0u;
+}
+
+/*
+	kernel_mark_singular
+	- lane_mask bit j flags matrix index + j as singular
+	- the flagged outputs become identity (as inverse() returns) and their bits are set in singular_mask
+*/
+template<class T>
+inline size_t kernel_mark_singular(unsigned int lane_mask, size_t index, T* out, size_t dimension, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	for (size_t j = 0; lane_mask != 0; j++, lane_mask >>= 1)
+	{
+		if ((lane_mask & 1u) == 0)
+		{
+			continue;
+		}
+		T* mat = out + (index + j) * dimension * dimension;
+		for (size_t k = 0; k < dimension * dimension; k++)
+		{
+			mat[k] = k % (dimension + 1) == 0 ? static_cast<T>(1.0) : static_cast<T>(0.0);
+		}
+		if (singular_mask != nullptr)
+		{
+			singular_mask[(index + j) / 64] |= static_cast<uint64_t>(1) << ((index + j) % 64);
+		}
+		singular++;
+	}
+	return singular;
+}
+
+/*
+	kernel_inverse / kernel_det
+	- process the matrices [begin, end) of mats (16 or 9 packed row-major values each)
+	- inverse returns the number of singular matrices and ORs their bits into singular_mask (indexed from mats)
+*/
+template<class T>
+inline size_t kernel_inverse_mat4x4_scalar(const T* mats, T* out, size_t begin, size_t end, T threshold, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		T d[16], det;
+		kernel_inverse_mat4x4_lanes(mats + i * 16, d, det);
+		for (size_t k = 0; k < 16; k++)
+		{
+			out[i * 16 + k] = d[k];
+		}
+		singular += kernel_mark_singular(lanes_abs_le_mask(det, threshold), i, out, 4, singular_mask);
+	}
+	return singular;
+}
+
+template<class T>
+inline void kernel_det_mat4x4_scalar(const T* mats, T* out, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		kernel_det_mat4x4_lanes(mats + i * 16, out[i]);
+	}
+}
+
+template<class T>
+inline size_t kernel_inverse_mat3x3_scalar(const T* mats, T* out, size_t begin, size_t end, T threshold, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		T d[9], det;
+		kernel_inverse_mat3x3_lanes(mats + i * 9, d, det);
+		for (size_t k = 0; k < 9; k++)
+		{
+			out[i * 9 + k] = d[k];
+		}
+		singular += kernel_mark_singular(lanes_abs_le_mask(det, threshold), i, out, 3, singular_mask);
+	}
+	return singular;
+}
+
+template<class T>
+inline void kernel_det_mat3x3_scalar(const T* mats, T* out, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		kernel_det_mat3x3_lanes(mats + i * 9, out[i]);
+	}
+}
+
+template<class T>
+inline T lanes_sqrt(T t)
+{
+	return std::sqrt(t);
+}
+
+//1 or -1 with the sign of t
+template<class T>
+inline T lanes_sign(T t)
+{
+	return t < 0 ? static_cast<T>(-1.0) : static_cast<T>(1.0);
+}
+
+template<class T>
+inline T lanes_max(T t1, T t2)
+{
+	return t1 > t2 ? t1 : t2;
+}
+
+//Exact for scalars, the SIMD lane types use the hardware estimate plus one Newton-Raphson step
+template<class T>
+inline T lanes_rsqrt(T t)
+{
+	return static_cast<T>(1.0) / std::sqrt(t);
+}
+
+template<class T>
+inline T lanes_min(T t1, T t2)
+{
+	return t1 < t2 ? t1 : t2;
+}
+
+template<class T>
+inline T lanes_abs(T t)
+{
+	return std::abs(t);
+}
+
+//Nearest integer, ties to even
+template<class T>
+inline T lanes_round(T t)
+{
+	return std::nearbyint(t);
+}
+
+//if_true where t1 < t2, if_false elsewhere
+template<class T>
+inline T lanes_select_lt(T t1, T t2, T if_true, T if_false)
+{
+	return t1 < t2 ? if_true : if_false;
+}
+
+template<class T>
+inline unsigned int lanes_lt_mask(T t1, T t2)
+{
+	return t1 < t2 ? 1u : 0u;
+}
+
+template<class T>
+inline unsigned int lanes_le_mask(T t1, T t2)
+{
+	return t1 <= t2 ? 1u : 0u;
+}
+
+/*
+	kernel_*_quat_lanes
+	- the quat operations of quat.hpp written once for any lane type L, q[0..3] are x, y, z, w
+	- rotate applies the rotation of rotate(radian, axis) in matrix.hpp, rotation writes its 9 row-major
+	  row-vector matrix elements
+*/
+template<class L>
+constexpr void kernel_multiply_quat_lanes(const L* a, const L* b, L* r)
+{
+	r[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+	r[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+	r[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+	r[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+}
+
+template<class L>
+constexpr void kernel_rotate_quat_lanes(const L* q, const L* v, L* r)
+{
+	L two(2.0);
+	L t0 = two * (v[1] * q[2] - v[2] * q[1]);
+	L t1 = two * (v[2] * q[0] - v[0] * q[2]);
+	L t2 = two * (v[0] * q[1] - v[1] * q[0]);
+	r[0] = v[0] + q[3] * t0 + (t1 * q[2] - t2 * q[1]);
+	r[1] = v[1] + q[3] * t1 + (t2 * q[0] - t0 * q[2]);
+	r[2] = v[2] + q[3] * t2 + (t0 * q[1] - t1 * q[0]);
+}
+
+template<class L>
+inline void kernel_normalize_quat_lanes(L* q)
+{
+	L length_inv = L(1.0) / lanes_sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	q[0] = q[0] * length_inv; q[1] = q[1] * length_inv; q[2] = q[2] * length_inv; q[3] = q[3] * length_inv;
+}
+
+//Takes the shorter arc, b is negated when the quats are more than 90 degrees apart
+template<class L>
+inline void kernel_nlerp_quat_lanes(const L* a, const L* b, L t, L* r)
+{
+	L sign = lanes_sign(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+	for (size_t k = 0; k < 4; k++)
+	{
+		r[k] = a[k] + (b[k] * sign - a[k]) * t;
+	}
+	kernel_normalize_quat_lanes(r);
+}
+
+template<class L>
+constexpr void kernel_rotation_quat_lanes(const L* q, L* m)
+{
+	L one(1.0), two(2.0);
+	L x2 = q[0] * q[0], y2 = q[1] * q[1], z2 = q[2] * q[2];
+	L xy = q[0] * q[1], xz = q[0] * q[2], yz = q[1] * q[2];
+	L xw = q[0] * q[3], yw = q[1] * q[3], zw = q[2] * q[3];
+	m[0] = one - two * (y2 + z2); m[1] = two * (xy - zw); m[2] = two * (xz + yw);
+	m[3] = two * (xy + zw); m[4] = one - two * (x2 + z2); m[5] = two * (yz - xw);
+	m[6] = two * (xz - yw); m[7] = two * (yz + xw); m[8] = one - two * (x2 + y2);
+}
+
+//Writes a rotation from kernel_rotation_quat_lanes as a 4x4 matrix of either convention
+template<class T>
+constexpr void kernel_store_rotation_mat4x4(const T* m, T* out, bool is_row_vector)
+{
+	for (size_t row = 0; row < 3; row++)
+	{
+		for (size_t col = 0; col < 3; col++)
+		{
+			out[row * 4 + col] = is_row_vector ? m[row * 3 + col] : m[col * 3 + row];
+		}
+		out[row * 4 + 3] = 0.0;
+		out[12 + row] = 0.0;
+	}
+	out[15] = 1.0;
+}
+
+/*
+	kernel_*_quat scalar
+	- quats are 4 packed values, vectors 3, t_step / quat_step are 0 to repeat one value or 1 / 4 to walk an array
+	- out may be the same array as an input
+*/
+template<class T>
+inline void kernel_multiply_quat_scalar(const T* quats1, const T* quats2, T* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		T r[4];
+		kernel_multiply_quat_lanes(quats1 + i * 4, quats2 + i * 4, r);
+		out[i * 4] = r[0]; out[i * 4 + 1] = r[1]; out[i * 4 + 2] = r[2]; out[i * 4 + 3] = r[3];
+	}
+}
+
+template<class T>
+inline void kernel_rotate_quat_scalar(const T* quats, size_t quat_step, const T* vecs, T* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		T r[3];
+		kernel_rotate_quat_lanes(quats + i * quat_step, vecs + i * 3, r);
+		out[i * 3] = r[0]; out[i * 3 + 1] = r[1]; out[i * 3 + 2] = r[2];
+	}
+}
+
+template<class T>
+inline void kernel_normalize_quat_scalar(T* quats, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		kernel_normalize_quat_lanes(quats + i * 4);
+	}
+}
+
+template<class T>
+inline void kernel_nlerp_quat_scalar(const T* quats1, const T* quats2, const T* t, size_t t_step, T* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		T r[4];
+		kernel_nlerp_quat_lanes(quats1 + i * 4, quats2 + i * 4, t[i * t_step], r);
+		out[i * 4] = r[0]; out[i * 4 + 1] = r[1]; out[i * 4 + 2] = r[2]; out[i * 4 + 3] = r[3];
+	}
+}
+
+template<class T>
+inline void kernel_to_mat4x4_quat_scalar(const T* quats, T* out, size_t count, bool is_row_vector)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		T m[9];
+		kernel_rotation_quat_lanes(quats + i * 4, m);
+		kernel_store_rotation_mat4x4(m, out + i * 16, is_row_vector);
+	}
+}
+
+/*
+	kernel_*_soaf
+	- rsqrt, fast length and fast normalize over float arrays, SoA vectors are passed as dimension (3 or 4) component pointers
+	- the length of a zero vector is 0, it is computed as s * rsqrt(max(s, FLT_MIN))
+*/
+template<class L>
+inline L kernel_sqr_length_soa_lanes(const L* c, size_t dimension)
+{
+	L sum = c[0] * c[0];
+	for (size_t k = 1; k < dimension; k++)
+	{
+		sum = sum + c[k] * c[k];
+	}
+	return sum;
+}
+
+template<class L>
+inline L kernel_fast_length_lanes(L sqr_length)
+{
+	return sqr_length * lanes_rsqrt(lanes_max(sqr_length, L(std::numeric_limits<float>::min())));
+}
+
+inline void kernel_rsqrtf_scalar(const float* in, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = lanes_rsqrt(in[i]);
+	}
+}
+
+inline void kernel_fast_length_soaf_scalar(const float* const* components, size_t dimension, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		float c[4] = {};
+		for (size_t k = 0; k < dimension; k++) { c[k] = components[k][i]; }
+		out[i] = kernel_fast_length_lanes(kernel_sqr_length_soa_lanes(c, dimension));
+	}
+}
+
+inline void kernel_fast_normalize_soaf_scalar(float* const* components, size_t dimension, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		float c[4] = {};
+		for (size_t k = 0; k < dimension; k++) { c[k] = components[k][i]; }
+		float length_inv = lanes_rsqrt(kernel_sqr_length_soa_lanes(c, dimension));
+		for (size_t k = 0; k < dimension; k++) { components[k][i] = c[k] * length_inv; }
+	}
+}
+
+/*
+	elementary_accuracy
+	- precise: Cephes-style polynomials, sincos within 1e-7, atan2 and acos within 3.5e-7 absolute error (about one float ulp at pi)
+	- fast: shorter polynomials, sincos within 4e-5, atan2 within 1.5e-5 and acos within 7e-5 absolute error
+*/
+enum class elementary_accuracy
+{
+	fast = 0,
+	precise = 1
+};
+
+/*
+	kernel_*_elementary_lanes
+	- float sin / cos, atan2 and acos written once for any lane type L, branches are lane selects
+	- sincos reduces by k * pi / 2 in three parts (Cody-Waite), the bounds hold for |radian| <= 8192
+*/
+template<bool is_precise, class L>
+inline void kernel_sincos_lanes(L radian, L& sin_value, L& cos_value)
+{
+	L k = lanes_round(radian * L(0.636619772367581343f));
+	L r = radian - k * L(1.5703125f);
+	r = r - k * L(4.837512969970703125e-4f);
+	r = r - k * L(7.54978995489188216e-8f);
+	L r2 = r * r;
+
+	L sin_r, cos_r;
+	if constexpr (is_precise)
+	{
+		sin_r = r + r * r2 * ((L(-1.9515295891e-4f) * r2 + L(8.3321608736e-3f)) * r2 + L(-1.6666654611e-1f));
+		cos_r = L(1.0f) - L(0.5f) * r2 + r2 * r2 * ((L(2.443315711809948e-5f) * r2 + L(-1.388731625493765e-3f)) * r2 + L(4.166664568298827e-2f));
+	}
+	else
+	{
+		sin_r = r + r * r2 * (L(8.3333333e-3f) * r2 + L(-1.6666667e-1f));
+		cos_r = L(1.0f) + r2 * ((L(-1.3888889e-3f) * r2 + L(4.1666668e-2f)) * r2 + L(-0.5f));
+	}
+
+	//k mod 4 picks the quadrant: odd quadrants swap sin and cos, sin is negative in 2 and 3, cos in 1 and 2
+	L quadrant = k - L(4.0f) * lanes_round(k * L(0.25f) - L(0.375f));
+	L odd = quadrant - L(2.0f) * lanes_round(quadrant * L(0.5f) - L(0.25f));
+	L swapped_sin = lanes_select_lt(L(0.5f), odd, cos_r, sin_r);
+	L swapped_cos = lanes_select_lt(L(0.5f), odd, sin_r, cos_r);
+	sin_value = lanes_select_lt(L(1.5f), quadrant, -swapped_sin, swapped_sin);
+	cos_value = lanes_select_lt(lanes_abs(quadrant - L(1.5f)), L(1.0f), -swapped_cos, swapped_cos);
+}
+
+//atan2(0, 0) is 0, the inputs must be finite
+template<bool is_precise, class L>
+inline L kernel_atan2_lanes(L y, L x)
+{
+	L abs_y = lanes_abs(y);
+	L abs_x = lanes_abs(x);
+	L t = lanes_min(abs_y, abs_x) / lanes_max(lanes_max(abs_y, abs_x), L(std::numeric_limits<float>::min()));
+
+	L r;
+	if constexpr (is_precise)
+	{
+		//Above tan(pi / 8), atan(t) = pi / 4 + atan((t - 1) / (t + 1))
+		L reduced = lanes_select_lt(L(0.414213562f), t, (t - L(1.0f)) / (t + L(1.0f)), t);
+		L offset = lanes_select_lt(L(0.414213562f), t, L(0.785398163f), L(0.0f));
+		L z = reduced * reduced;
+		r = offset + reduced + reduced * z * (((L(8.05374449538e-2f) * z + L(-1.38776856032e-1f)) * z + L(1.99777106478e-1f)) * z + L(-3.33329491539e-1f));
+	}
+	else
+	{
+		L z = t * t;
+		r = t * ((((L(0.0208351f) * z + L(-0.0851330f)) * z + L(0.1801410f)) * z + L(-0.3302995f)) * z + L(0.9998660f));
+	}
+
+	r = lanes_select_lt(abs_x, abs_y, L(1.57079633f) - r, r);
+	r = lanes_select_lt(x, L(0.0f), L(3.14159265f) - r, r);
+	return lanes_select_lt(y, L(0.0f), -r, r);
+}
+
+//NaN outside [-1, 1] like std::acos
+template<bool is_precise, class L>
+inline L kernel_acos_lanes(L t)
+{
+	L abs_t = lanes_abs(t);
+	L r;
+	if constexpr (is_precise)
+	{
+		//acos(a) = 2 * asin(sqrt((1 - a) / 2)) above 0.5, pi / 2 - asin(a) below
+		L a = lanes_select_lt(L(0.5f), abs_t, lanes_sqrt((L(1.0f) - abs_t) * L(0.5f)), abs_t);
+		L z = a * a;
+		L asin_a = a + a * z * ((((L(4.2163199048e-2f) * z + L(2.4181311049e-2f)) * z + L(4.5470025998e-2f)) * z + L(7.4953002686e-2f)) * z + L(1.6666752422e-1f));
+		r = lanes_select_lt(L(0.5f), abs_t, L(2.0f) * asin_a, L(1.57079633f) - asin_a);
+	}
+	else
+	{
+		r = lanes_sqrt(L(1.0f) - abs_t) * (((L(-0.0187293f) * abs_t + L(0.0742610f)) * abs_t + L(-0.2121144f)) * abs_t + L(1.5707288f));
+	}
+	return lanes_select_lt(t, L(0.0f), L(3.14159265f) - r, r);
+}
+
+template<bool is_precise>
+inline void kernel_sincosf_scalar_run(const float* radians, float* sin_out, float* cos_out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		kernel_sincos_lanes<is_precise>(radians[i], sin_out[i], cos_out[i]);
+	}
+}
+
+template<bool is_precise>
+inline void kernel_atan2f_scalar_run(const float* y, const float* x, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = kernel_atan2_lanes<is_precise>(y[i], x[i]);
+	}
+}
+
+template<bool is_precise>
+inline void kernel_acosf_scalar_run(const float* in, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = kernel_acos_lanes<is_precise>(in[i]);
+	}
+}
+
+inline void kernel_sincosf_scalar(const float* radians, float* sin_out, float* cos_out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_sincosf_scalar_run<true>(radians, sin_out, cos_out, count); }
+	else { kernel_sincosf_scalar_run<false>(radians, sin_out, cos_out, count); }
+}
+
+inline void kernel_atan2f_scalar(const float* y, const float* x, float* out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_atan2f_scalar_run<true>(y, x, out, count); }
+	else { kernel_atan2f_scalar_run<false>(y, x, out, count); }
+}
+
+inline void kernel_acosf_scalar(const float* in, float* out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_acosf_scalar_run<true>(in, out, count); }
+	else { kernel_acosf_scalar_run<false>(in, out, count); }
+}
+
+/*
+	kernel_cull_*
+	- planes are the 24 values (a, b, c, d) of the six frustum planes, a point is inside when a * x + b * y + c * z + d >= 0
+	- spheres are 4 component arrays (center x, y, z, radius), boxes 6 (min x, y, z, max x, y, z)
+	- a volume is culled when it lies entirely on the negative side of one plane, the test is conservative:
+	  a volume near a frustum corner may be reported visible
+	- the visible bits of [begin, end) are or'ed into visible_mask, returns the visible count
+*/
+inline size_t kernel_bit_count(uint64_t word)
+{
+	word = word - ((word >> 1) & 0x5555555555555555ull);
+	word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<size_t>((word * 0x0101010101010101ull) >> 56);
+}
+
+inline size_t kernel_mark_visible(unsigned int lane_mask, size_t index, uint64_t* visible_mask)
+{
+	visible_mask[index / 64] |= static_cast<uint64_t>(lane_mask) << (index % 64);
+	return kernel_bit_count(lane_mask);
+}
+
+//Smallest signed distance of the sphere to the six planes
+template<class L>
+inline L kernel_cull_sphere_lanes(const L* planes, L x, L y, L z, L radius)
+{
+	L distance = planes[0] * x + planes[1] * y + planes[2] * z + planes[3];
+	for (size_t k = 4; k < 24; k += 4)
+	{
+		distance = lanes_min(distance, planes[k] * x + planes[k + 1] * y + planes[k + 2] * z + planes[k + 3]);
+	}
+	return distance + radius;
+}
+
+//Smallest signed distance of the box to the six planes, from its center and its extent projected on |normal|
+template<class L>
+inline L kernel_cull_box_lanes(const L* planes, const L* abs_normals, const L* box)
+{
+	L half(0.5f);
+	L cx = (box[0] + box[3]) * half, cy = (box[1] + box[4]) * half, cz = (box[2] + box[5]) * half;
+	L ex = (box[3] - box[0]) * half, ey = (box[4] - box[1]) * half, ez = (box[5] - box[2]) * half;
+	L distance = planes[0] * cx + planes[1] * cy + planes[2] * cz + planes[3] + abs_normals[0] * ex + abs_normals[1] * ey + abs_normals[2] * ez;
+	for (size_t k = 1; k < 6; k++)
+	{
+		const L* p = planes + k * 4;
+		const L* n = abs_normals + k * 3;
+		distance = lanes_min(distance, p[0] * cx + p[1] * cy + p[2] * cz + p[3] + n[0] * ex + n[1] * ey + n[2] * ez);
+	}
+	return distance;
+}
+
+template<class L, class T>
+inline void kernel_broadcast_planes(const T* planes, L* lanes, L* abs_normals)
+{
+	for (size_t k = 0; k < 6; k++)
+	{
+		for (size_t c = 0; c < 4; c++)
+		{
+			lanes[k * 4 + c] = L(planes[k * 4 + c]);
+		}
+		for (size_t c = 0; c < 3; c++)
+		{
+			abs_normals[k * 3 + c] = L(lanes_abs(planes[k * 4 + c]));
+		}
+	}
+}
+
+template<class T>
+inline size_t kernel_cull_spheres_scalar(const T* planes, const T* const* spheres, size_t begin, size_t end, uint64_t* visible_mask)
+{
+	size_t visible = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		T distance = kernel_cull_sphere_lanes(planes, spheres[0][i], spheres[1][i], spheres[2][i], spheres[3][i]);
+		visible += kernel_mark_visible(lanes_lt_mask(distance, static_cast<T>(0.0)) ^ 1u, i, visible_mask);
+	}
+	return visible;
+}
+
+template<class T>
+inline size_t kernel_cull_boxes_scalar(const T* planes, const T* const* boxes, size_t begin, size_t end, uint64_t* visible_mask)
+{
+	T lanes[24], abs_normals[18];
+	kernel_broadcast_planes(planes, lanes, abs_normals);
+	size_t visible = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		T box[6];
+		for (size_t k = 0; k < 6; k++) { box[k] = boxes[k][i]; }
+		T distance = kernel_cull_box_lanes(lanes, abs_normals, box);
+		visible += kernel_mark_visible(lanes_lt_mask(distance, static_cast<T>(0.0)) ^ 1u, i, visible_mask);
+	}
+	return visible;
+}
+
+/*
+	kernel_intersect_*
+	- Moller-Trumbore, a ray is origin x, y, z and direction x, y, z, a triangle is its first vertex v0 and its
+	  edges e1 = v1 - v0, e2 = v2 - v0, arrays of triangles are passed as 9 component arrays in that order
+	- a hit is t_min < t < t_max with barycentrics u, v >= 0, u + v <= 1 at the point v0 + u * e1 + v * e2,
+	  triangles parallel to the ray (det = 0) are missed
+	- triangles: the closest hit of one ray over triangles [begin, end), hit is (t, u, v) with t as t_max on entry,
+	  a closer hit replaces it and writes its triangle index to primitive
+	- rays: one triangle against rays [begin, end) given as 6 component arrays, hits are the (t, u, v) arrays of
+	  the rays and primitives receives index for every ray that moved to a closer hit
+*/
+template<class L>
+inline unsigned int kernel_intersect_triangle_lanes(const L* ray, const L* triangle, L t_min, L t_max, L& t, L& u, L& v)
+{
+	//p = direction x e2, q = (origin - v0) x e1
+	L px = ray[4] * triangle[8] - ray[5] * triangle[7];
+	L py = ray[5] * triangle[6] - ray[3] * triangle[8];
+	L pz = ray[3] * triangle[7] - ray[4] * triangle[6];
+	L det = triangle[3] * px + triangle[4] * py + triangle[5] * pz;
+	L det_inv = L(1.0f) / det;
+	L sx = ray[0] - triangle[0], sy = ray[1] - triangle[1], sz = ray[2] - triangle[2];
+	u = (sx * px + sy * py + sz * pz) * det_inv;
+	L qx = sy * triangle[5] - sz * triangle[4];
+	L qy = sz * triangle[3] - sx * triangle[5];
+	L qz = sx * triangle[4] - sy * triangle[3];
+	v = (ray[3] * qx + ray[4] * qy + ray[5] * qz) * det_inv;
+	t = (triangle[6] * qx + triangle[7] * qy + triangle[8] * qz) * det_inv;
+	//Written as positive tests, the NaN lanes of det = 0 fail them all
+	L zero(0.0f);
+	return lanes_lt_mask(zero, lanes_abs(det)) & lanes_le_mask(zero, u) & lanes_le_mask(zero, v) & lanes_le_mask(u + v, L(1.0f)) &
+		lanes_lt_mask(t_min, t) & lanes_lt_mask(t, t_max);
+}
+
+//Keeps the closest of the lanes in lane_mask, t, u and v hold the lanes of triangles index to index + width - 1
+template<class T>
+inline void kernel_closest_hit(unsigned int lane_mask, size_t index, const T* t, const T* u, const T* v, T* hit, size_t* primitive)
+{
+	for (size_t j = 0; lane_mask != 0; j++, lane_mask >>= 1)
+	{
+		if ((lane_mask & 1u) != 0 && t[j] < hit[0])
+		{
+			hit[0] = t[j]; hit[1] = u[j]; hit[2] = v[j];
+			*primitive = index + j;
+		}
+	}
+}
+
+//Writes the lanes in lane_mask to the hits of rays index to index + width - 1
+template<class T>
+inline void kernel_store_hits(unsigned int lane_mask, size_t index, size_t triangle_index, const T* t, const T* u, const T* v, T* const* hits, size_t* primitives)
+{
+	for (size_t j = 0; lane_mask != 0; j++, lane_mask >>= 1)
+	{
+		if ((lane_mask & 1u) != 0)
+		{
+			hits[0][index + j] = t[j]; hits[1][index + j] = u[j]; hits[2][index + j] = v[j];
+			primitives[index + j] = triangle_index;
+		}
+	}
+}
+
+template<class T>
+inline void kernel_intersect_triangles_scalar(const T* ray, const T* const* triangles, size_t begin, size_t end, T t_min, T* hit, size_t* primitive)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		T triangle[9], t, u, v;
+		for (size_t k = 0; k < 9; k++) { triangle[k] = triangles[k][i]; }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(ray, triangle, t_min, hit[0], t, u, v);
+		kernel_closest_hit(lane_mask, i, &t, &u, &v, hit, primitive);
+	}
+}
+
+template<class T>
+inline void kernel_intersect_rays_scalar(const T* const* rays, size_t begin, size_t end, const T* triangle, size_t triangle_index, T t_min, T* const* hits, size_t* primitives)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		T ray[6], t, u, v;
+		for (size_t k = 0; k < 6; k++) { ray[k] = rays[k][i]; }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(ray, triangle, t_min, hits[0][i], t, u, v);
+		kernel_store_hits(lane_mask, i, triangle_index, &t, &u, &v, hits, primitives);
+	}
+}
+
+/*
+	kernel_reduce_*
+	- bounds: out = the sums, minimums and maximums of x, y and z over count points given as component arrays
+	- moments: out = the sums of the deviations d = p - center, then of dx * dx, dy * dy, dz * dz, dx * dy, dy * dz, dz * dx
+	- every lane accumulates its own share of the points and the lanes are merged at the end, meant for short blocks
+	  so that plain sums stay accurate, count 0 gives the identity (sums 0, minimums +inf, maximums -inf)
+*/
+template<class L>
+inline void kernel_reduce_bounds_identity(L* acc)
+{
+	for (size_t k = 0; k < 3; k++)
+	{
+		acc[k] = L(0.0f);
+		acc[k + 3] = L(std::numeric_limits<float>::infinity());
+		acc[k + 6] = L(-std::numeric_limits<float>::infinity());
+	}
+}
+
+template<class L>
+inline void kernel_reduce_bounds_lanes(const L* c, L* acc)
+{
+	for (size_t k = 0; k < 3; k++)
+	{
+		acc[k] = acc[k] + c[k];
+		acc[k + 3] = lanes_min(acc[k + 3], c[k]);
+		acc[k + 6] = lanes_max(acc[k + 6], c[k]);
+	}
+}
+
+template<class L>
+inline void kernel_reduce_moments_lanes(const L* c, const L* center, L* acc)
+{
+	L d[3];
+	for (size_t k = 0; k < 3; k++)
+	{
+		d[k] = c[k] - center[k];
+		acc[k] = acc[k] + d[k];
+		acc[k + 3] = acc[k + 3] + d[k] * d[k];
+	}
+	for (size_t k = 0; k < 3; k++)
+	{
+		acc[k + 6] = acc[k + 6] + d[k] * d[(k + 1) % 3];
+	}
+}
+
+//Merges the bounds or moments of partial into out
+template<class T>
+inline void kernel_reduce_bounds_merge(const T* partial, T* out)
+{
+	for (size_t k = 0; k < 3; k++)
+	{
+		out[k] += partial[k];
+		out[k + 3] = lanes_min(out[k + 3], partial[k + 3]);
+		out[k + 6] = lanes_max(out[k + 6], partial[k + 6]);
+	}
+}
+
+template<class T>
+inline void kernel_reduce_moments_merge(const T* partial, T* out)
+{
+	for (size_t k = 0; k < 9; k++)
+	{
+		out[k] += partial[k];
+	}
+}
+
+//Merges the 9 accumulators of width lanes, stored as lanes[k * width + lane], into out one lane at a time
+template<class T, class Merge>
+inline void kernel_reduce_merge_lanes(const T* lanes, size_t width, T* out, Merge merge)
+{
+	for (size_t lane = 0; lane < width; lane++)
+	{
+		T partial[9];
+		for (size_t k = 0; k < 9; k++) { partial[k] = lanes[k * width + lane]; }
+		merge(partial, out);
+	}
+}
+
+template<class T>
+inline void kernel_reduce_bounds_scalar(const T* const* components, size_t count, T* out)
+{
+	kernel_reduce_bounds_identity(out);
+	for (size_t i = 0; i < count; i++)
+	{
+		T c[] = { components[0][i], components[1][i], components[2][i] };
+		kernel_reduce_bounds_lanes(c, out);
+	}
+}
+
+template<class T>
+inline void kernel_reduce_moments_scalar(const T* const* components, size_t count, const T* center, T* out)
+{
+	for (size_t k = 0; k < 9; k++) { out[k] = 0; }
+	for (size_t i = 0; i < count; i++)
+	{
+		T c[] = { components[0][i], components[1][i], components[2][i] };
+		kernel_reduce_moments_lanes(c, center, out);
+	}
+}
+
+#ifdef MATH_SSE2
+
+//Loads the matrix rows so that out = v.x * r0 + v.y * r1 + v.z * r2 + v.w * r3 for both conventions
+inline void kernel_load_transform_rows(const float* mat, bool is_row_vector, __m128& r0, __m128& r1, __m128& r2, __m128& r3)
+{
+	r0 = _mm_loadu_ps(mat);
+	r1 = _mm_loadu_ps(mat + 4);
+	r2 = _mm_loadu_ps(mat + 8);
+	r3 = _mm_loadu_ps(mat + 12);
+	if (!is_row_vector)
+	{
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	}
+}
+
+inline void kernel_transform_vec4f_sse2(const float* in, float* out, size_t count, const float* mat, bool is_row_vector)
+{
+	__m128 r0, r1, r2, r3;
+	kernel_load_transform_rows(mat, is_row_vector, r0, r1, r2, r3);
+	for (size_t i = 0; i < count; i++)
+	{
+		__m128 v = _mm_loadu_ps(in + i * 4);
+		__m128 sum = _mm_mul_ps(simd_splat_ps<0>(v), r0);
+		sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<1>(v), r1));
+		sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<2>(v), r2));
+		sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<3>(v), r3));
+		_mm_storeu_ps(out + i * 4, sum);
+	}
+}
+
+inline void kernel_store_vec3f(float* ptr, __m128 v)
+{
+	_mm_storel_pi(reinterpret_cast<__m64*>(ptr), v);
+	_mm_store_ss(ptr + 2, _mm_movehl_ps(v, v));
+}
+
+inline void kernel_transform_vec3f_sse2(const char* in, size_t in_stride, char* out, size_t out_stride, size_t count, const float* basis, float w, bool perspective_divide)
+{
+	__m128 r0 = _mm_loadu_ps(basis);
+	__m128 r1 = _mm_loadu_ps(basis + 4);
+	__m128 r2 = _mm_loadu_ps(basis + 8);
+	__m128 r3 = _mm_mul_ps(_mm_loadu_ps(basis + 12), _mm_set1_ps(w));
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* v = reinterpret_cast<const float*>(in + i * in_stride);
+		__m128 sum = _mm_add_ps(r3, _mm_mul_ps(_mm_load1_ps(v), r0));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(v + 1), r1));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(v + 2), r2));
+		if (perspective_divide)
+		{
+			sum = _mm_div_ps(sum, simd_splat_ps<3>(sum));
+		}
+		kernel_store_vec3f(reinterpret_cast<float*>(out + i * out_stride), sum);
+	}
+}
+
+inline void kernel_normalize_vec4f_sse2(float* data, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		__m128 v = _mm_loadu_ps(data + i * 4);
+		_mm_storeu_ps(data + i * 4, _mm_div_ps(v, _mm_sqrt_ps(simd_dot_ps(v, v))));
+	}
+}
+
+inline void kernel_dot_vec4f_sse2(const float* vecs1, const float* vecs2, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		//Transpose four products so that the four sums come out in one register
+		__m128 p0 = _mm_mul_ps(_mm_loadu_ps(vecs1 + i * 4), _mm_loadu_ps(vecs2 + i * 4));
+		__m128 p1 = _mm_mul_ps(_mm_loadu_ps(vecs1 + i * 4 + 4), _mm_loadu_ps(vecs2 + i * 4 + 4));
+		__m128 p2 = _mm_mul_ps(_mm_loadu_ps(vecs1 + i * 4 + 8), _mm_loadu_ps(vecs2 + i * 4 + 8));
+		__m128 p3 = _mm_mul_ps(_mm_loadu_ps(vecs1 + i * 4 + 12), _mm_loadu_ps(vecs2 + i * 4 + 12));
+		_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3)));
+	}
+	kernel_dot_vec4f_scalar(vecs1 + i * 4, vecs2 + i * 4, out + i, count - i);
+}
+
+inline void kernel_multiply_mat4x4f_sse2(const float* mats1, const float* mats2, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = mats1 + i * 16;
+		const float* b = mats2 + i * 16;
+		__m128 b0 = _mm_loadu_ps(b);
+		__m128 b1 = _mm_loadu_ps(b + 4);
+		__m128 b2 = _mm_loadu_ps(b + 8);
+		__m128 b3 = _mm_loadu_ps(b + 12);
+		for (size_t row = 0; row < 4; row++)
+		{
+			__m128 a_row = _mm_loadu_ps(a + row * 4);
+			__m128 sum = _mm_mul_ps(simd_splat_ps<0>(a_row), b0);
+			sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<1>(a_row), b1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<2>(a_row), b2));
+			sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<3>(a_row), b3));
+			_mm_storeu_ps(out + i * 16 + row * 4, sum);
+		}
+	}
+}
+
+inline void kernel_multiply_left_mat4x4f_sse2(const float* left, const float* mats, float* out, size_t count)
+{
+	//The 16 broadcast coefficients of the shared matrix stay in registers for the whole batch
+	__m128 l[16];
+	for (size_t k = 0; k < 16; k++)
+	{
+		l[k] = _mm_set1_ps(left[k]);
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* b = mats + i * 16;
+		__m128 b0 = _mm_loadu_ps(b);
+		__m128 b1 = _mm_loadu_ps(b + 4);
+		__m128 b2 = _mm_loadu_ps(b + 8);
+		__m128 b3 = _mm_loadu_ps(b + 12);
+		for (size_t row = 0; row < 4; row++)
+		{
+			__m128 sum = _mm_mul_ps(l[row * 4], b0);
+			sum = _mm_add_ps(sum, _mm_mul_ps(l[row * 4 + 1], b1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(l[row * 4 + 2], b2));
+			sum = _mm_add_ps(sum, _mm_mul_ps(l[row * 4 + 3], b3));
+			_mm_storeu_ps(out + i * 16 + row * 4, sum);
+		}
+	}
+}
+
+inline void kernel_multiply_right_mat4x4f_sse2(const float* mats, const float* right, float* out, size_t count)
+{
+	__m128 b0 = _mm_loadu_ps(right);
+	__m128 b1 = _mm_loadu_ps(right + 4);
+	__m128 b2 = _mm_loadu_ps(right + 8);
+	__m128 b3 = _mm_loadu_ps(right + 12);
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = mats + i * 16;
+		for (size_t row = 0; row < 4; row++)
+		{
+			__m128 a_row = _mm_loadu_ps(a + row * 4);
+			__m128 sum = _mm_mul_ps(simd_splat_ps<0>(a_row), b0);
+			sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<1>(a_row), b1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<2>(a_row), b2));
+			sum = _mm_add_ps(sum, _mm_mul_ps(simd_splat_ps<3>(a_row), b3));
+			_mm_storeu_ps(out + i * 16 + row * 4, sum);
+		}
+	}
+}
+
+//Four consecutive 4x4 matrices to 16 registers, lane j of e[k] is element k of matrix j
+inline void kernel_gather_mat4x4f_sse2(const float* mats, __m128* e)
+{
+	for (size_t row = 0; row < 4; row++)
+	{
+		__m128 m0 = _mm_loadu_ps(mats + row * 4);
+		__m128 m1 = _mm_loadu_ps(mats + 16 + row * 4);
+		__m128 m2 = _mm_loadu_ps(mats + 32 + row * 4);
+		__m128 m3 = _mm_loadu_ps(mats + 48 + row * 4);
+		_MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+		e[row * 4] = m0; e[row * 4 + 1] = m1; e[row * 4 + 2] = m2; e[row * 4 + 3] = m3;
+	}
+}
+
+inline void kernel_scatter_mat4x4f_sse2(const __m128* d, float* out)
+{
+	for (size_t row = 0; row < 4; row++)
+	{
+		__m128 m0 = d[row * 4], m1 = d[row * 4 + 1], m2 = d[row * 4 + 2], m3 = d[row * 4 + 3];
+		_MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+		_mm_storeu_ps(out + row * 4, m0);
+		_mm_storeu_ps(out + 16 + row * 4, m1);
+		_mm_storeu_ps(out + 32 + row * 4, m2);
+		_mm_storeu_ps(out + 48 + row * 4, m3);
+	}
+}
+
+inline size_t kernel_inverse_mat4x4f_sse2(const float* mats, float* out, size_t begin, size_t end, float threshold, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 e[16];
+		simd_lanes4f l[16], d[16], det;
+		kernel_gather_mat4x4f_sse2(mats + i * 16, e);
+		for (size_t k = 0; k < 16; k++) { l[k] = e[k]; }
+		kernel_inverse_mat4x4_lanes(l, d, det);
+		for (size_t k = 0; k < 16; k++) { e[k] = d[k].v; }
+		kernel_scatter_mat4x4f_sse2(e, out + i * 16);
+		singular += kernel_mark_singular(lanes_abs_le_mask(det, threshold), i, out, 4, singular_mask);
+	}
+	return singular + kernel_inverse_mat4x4_scalar(mats, out, i, end, threshold, singular_mask);
+}
+
+inline void kernel_det_mat4x4f_sse2(const float* mats, float* out, size_t begin, size_t end)
+{
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 e[16];
+		simd_lanes4f l[16], det;
+		kernel_gather_mat4x4f_sse2(mats + i * 16, e);
+		for (size_t k = 0; k < 16; k++) { l[k] = e[k]; }
+		kernel_det_mat4x4_lanes(l, det);
+		_mm_storeu_ps(out + i, det.v);
+	}
+	kernel_det_mat4x4_scalar(mats, out, i, end);
+}
+
+inline void kernel_gather_mat3x3f_sse2(const float* mats, simd_lanes4f* e)
+{
+	for (size_t k = 0; k < 9; k++)
+	{
+		e[k] = _mm_setr_ps(mats[k], mats[9 + k], mats[18 + k], mats[27 + k]);
+	}
+}
+
+inline size_t kernel_inverse_mat3x3f_sse2(const float* mats, float* out, size_t begin, size_t end, float threshold, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		simd_lanes4f e[9], d[9], det;
+		kernel_gather_mat3x3f_sse2(mats + i * 9, e);
+		kernel_inverse_mat3x3_lanes(e, d, det);
+		float lanes[4];
+		for (size_t k = 0; k < 9; k++)
+		{
+			_mm_storeu_ps(lanes, d[k].v);
+			for (size_t j = 0; j < 4; j++)
+			{
+				out[(i + j) * 9 + k] = lanes[j];
+			}
+		}
+		singular += kernel_mark_singular(lanes_abs_le_mask(det, threshold), i, out, 3, singular_mask);
+	}
+	return singular + kernel_inverse_mat3x3_scalar(mats, out, i, end, threshold, singular_mask);
+}
+
+inline void kernel_det_mat3x3f_sse2(const float* mats, float* out, size_t begin, size_t end)
+{
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		simd_lanes4f e[9], det;
+		kernel_gather_mat3x3f_sse2(mats + i * 9, e);
+		kernel_det_mat3x3_lanes(e, det);
+		_mm_storeu_ps(out + i, det.v);
+	}
+	kernel_det_mat3x3_scalar(mats, out, i, end);
+}
+
+//Four consecutive quats to x, y, z, w lanes
+inline void kernel_gather_quatf_sse2(const float* quats, simd_lanes4f* q)
+{
+	__m128 q0 = _mm_loadu_ps(quats), q1 = _mm_loadu_ps(quats + 4), q2 = _mm_loadu_ps(quats + 8), q3 = _mm_loadu_ps(quats + 12);
+	_MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+	q[0] = q0; q[1] = q1; q[2] = q2; q[3] = q3;
+}
+
+inline void kernel_scatter_quatf_sse2(const simd_lanes4f* q, float* out)
+{
+	__m128 q0 = q[0].v, q1 = q[1].v, q2 = q[2].v, q3 = q[3].v;
+	_MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+	_mm_storeu_ps(out, q0); _mm_storeu_ps(out + 4, q1); _mm_storeu_ps(out + 8, q2); _mm_storeu_ps(out + 12, q3);
+}
+
+inline void kernel_multiply_quatf_sse2(const float* quats1, const float* quats2, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f a[4], b[4], r[4];
+		kernel_gather_quatf_sse2(quats1 + i * 4, a);
+		kernel_gather_quatf_sse2(quats2 + i * 4, b);
+		kernel_multiply_quat_lanes(a, b, r);
+		kernel_scatter_quatf_sse2(r, out + i * 4);
+	}
+	kernel_multiply_quat_scalar(quats1 + i * 4, quats2 + i * 4, out + i * 4, count - i);
+}
+
+inline void kernel_rotate_quatf_sse2(const float* quats, size_t quat_step, const float* vecs, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f q[4], v[3], r[3];
+		if (quat_step == 0)
+		{
+			for (size_t k = 0; k < 4; k++) { q[k] = simd_lanes4f(quats[k]); }
+		}
+		else
+		{
+			kernel_gather_quatf_sse2(quats + i * 4, q);
+		}
+		const float* p = vecs + i * 3;
+		for (size_t k = 0; k < 3; k++) { v[k] = _mm_setr_ps(p[k], p[3 + k], p[6 + k], p[9 + k]); }
+		kernel_rotate_quat_lanes(q, v, r);
+		float lanes[3][4];
+		for (size_t k = 0; k < 3; k++) { _mm_storeu_ps(lanes[k], r[k].v); }
+		for (size_t j = 0; j < 4; j++)
+		{
+			out[(i + j) * 3] = lanes[0][j]; out[(i + j) * 3 + 1] = lanes[1][j]; out[(i + j) * 3 + 2] = lanes[2][j];
+		}
+	}
+	kernel_rotate_quat_scalar(quats + i * quat_step, quat_step, vecs + i * 3, out + i * 3, count - i);
+}
+
+inline void kernel_normalize_quatf_sse2(float* quats, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f q[4];
+		kernel_gather_quatf_sse2(quats + i * 4, q);
+		kernel_normalize_quat_lanes(q);
+		kernel_scatter_quatf_sse2(q, quats + i * 4);
+	}
+	kernel_normalize_quat_scalar(quats + i * 4, count - i);
+}
+
+inline void kernel_nlerp_quatf_sse2(const float* quats1, const float* quats2, const float* t, size_t t_step, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f a[4], b[4], r[4];
+		kernel_gather_quatf_sse2(quats1 + i * 4, a);
+		kernel_gather_quatf_sse2(quats2 + i * 4, b);
+		simd_lanes4f lanes_t = t_step == 0 ? simd_lanes4f(t[0]) : simd_lanes4f(_mm_loadu_ps(t + i));
+		kernel_nlerp_quat_lanes(a, b, lanes_t, r);
+		kernel_scatter_quatf_sse2(r, out + i * 4);
+	}
+	kernel_nlerp_quat_scalar(quats1 + i * 4, quats2 + i * 4, t + i * t_step, t_step, out + i * 4, count - i);
+}
+
+//Writes the 4 matrices whose rotation parts are held one per lane in m[9], transposing rows of lanes into matrix rows
+inline void kernel_scatter_rotation_mat4x4f_sse2(const simd_lanes4f* m, float* out, bool is_row_vector)
+{
+	__m128 rows[3][4];
+	for (size_t row = 0; row < 3; row++)
+	{
+		size_t step = is_row_vector ? 1 : 3;
+		size_t first = is_row_vector ? row * 3 : row;
+		__m128 r0 = m[first].v, r1 = m[first + step].v, r2 = m[first + 2 * step].v, r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		rows[row][0] = r0; rows[row][1] = r1; rows[row][2] = r2; rows[row][3] = r3;
+	}
+	__m128 last = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+	for (size_t j = 0; j < 4; j++)
+	{
+		_mm_storeu_ps(out + j * 16, rows[0][j]);
+		_mm_storeu_ps(out + j * 16 + 4, rows[1][j]);
+		_mm_storeu_ps(out + j * 16 + 8, rows[2][j]);
+		_mm_storeu_ps(out + j * 16 + 12, last);
+	}
+}
+
+inline void kernel_to_mat4x4_quatf_sse2(const float* quats, float* out, size_t count, bool is_row_vector)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f q[4], m[9];
+		kernel_gather_quatf_sse2(quats + i * 4, q);
+		kernel_rotation_quat_lanes(q, m);
+		kernel_scatter_rotation_mat4x4f_sse2(m, out + i * 16, is_row_vector);
+	}
+	kernel_to_mat4x4_quat_scalar(quats + i * 4, out + i * 16, count - i, is_row_vector);
+}
+
+inline void kernel_rsqrtf_sse2(const float* in, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, lanes_rsqrt(simd_lanes4f(_mm_loadu_ps(in + i))).v);
+	}
+	for (; i < count; i++)
+	{
+		out[i] = _mm_cvtss_f32(lanes_rsqrt(simd_lanes4f(_mm_set_ss(in[i]))).v);
+	}
+}
+
+inline void kernel_fast_length_soaf_sse2(const float* const* components, size_t dimension, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f c[4];
+		for (size_t k = 0; k < dimension; k++) { c[k] = _mm_loadu_ps(components[k] + i); }
+		_mm_storeu_ps(out + i, kernel_fast_length_lanes(kernel_sqr_length_soa_lanes(c, dimension)).v);
+	}
+	for (; i < count; i++)
+	{
+		simd_lanes4f c[4];
+		for (size_t k = 0; k < dimension; k++) { c[k] = _mm_set_ss(components[k][i]); }
+		out[i] = _mm_cvtss_f32(kernel_fast_length_lanes(kernel_sqr_length_soa_lanes(c, dimension)).v);
+	}
+}
+
+inline void kernel_fast_normalize_soaf_sse2(float* const* components, size_t dimension, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f c[4];
+		for (size_t k = 0; k < dimension; k++) { c[k] = _mm_loadu_ps(components[k] + i); }
+		simd_lanes4f length_inv = lanes_rsqrt(kernel_sqr_length_soa_lanes(c, dimension));
+		for (size_t k = 0; k < dimension; k++) { _mm_storeu_ps(components[k] + i, (c[k] * length_inv).v); }
+	}
+	for (; i < count; i++)
+	{
+		simd_lanes4f c[4];
+		for (size_t k = 0; k < dimension; k++) { c[k] = _mm_set_ss(components[k][i]); }
+		simd_lanes4f length_inv = lanes_rsqrt(kernel_sqr_length_soa_lanes(c, dimension));
+		for (size_t k = 0; k < dimension; k++) { components[k][i] = _mm_cvtss_f32((c[k] * length_inv).v); }
+	}
+}
+
+template<bool is_precise>
+inline void kernel_sincosf_sse2_run(const float* radians, float* sin_out, float* cos_out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f sin_value, cos_value;
+		kernel_sincos_lanes<is_precise>(simd_lanes4f(_mm_loadu_ps(radians + i)), sin_value, cos_value);
+		_mm_storeu_ps(sin_out + i, sin_value.v);
+		_mm_storeu_ps(cos_out + i, cos_value.v);
+	}
+	kernel_sincosf_scalar_run<is_precise>(radians + i, sin_out + i, cos_out + i, count - i);
+}
+
+template<bool is_precise>
+inline void kernel_atan2f_sse2_run(const float* y, const float* x, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, kernel_atan2_lanes<is_precise>(simd_lanes4f(_mm_loadu_ps(y + i)), simd_lanes4f(_mm_loadu_ps(x + i))).v);
+	}
+	kernel_atan2f_scalar_run<is_precise>(y + i, x + i, out + i, count - i);
+}
+
+template<bool is_precise>
+inline void kernel_acosf_sse2_run(const float* in, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, kernel_acos_lanes<is_precise>(simd_lanes4f(_mm_loadu_ps(in + i))).v);
+	}
+	kernel_acosf_scalar_run<is_precise>(in + i, out + i, count - i);
+}
+
+inline void kernel_sincosf_sse2(const float* radians, float* sin_out, float* cos_out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_sincosf_sse2_run<true>(radians, sin_out, cos_out, count); }
+	else { kernel_sincosf_sse2_run<false>(radians, sin_out, cos_out, count); }
+}
+
+inline void kernel_atan2f_sse2(const float* y, const float* x, float* out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_atan2f_sse2_run<true>(y, x, out, count); }
+	else { kernel_atan2f_sse2_run<false>(y, x, out, count); }
+}
+
+inline void kernel_acosf_sse2(const float* in, float* out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_acosf_sse2_run<true>(in, out, count); }
+	else { kernel_acosf_sse2_run<false>(in, out, count); }
+}
+
+inline size_t kernel_cull_spheresf_sse2(const float* planes, const float* const* spheres, size_t begin, size_t end, uint64_t* visible_mask)
+{
+	simd_lanes4f lanes[24], abs_normals[18];
+	kernel_broadcast_planes(planes, lanes, abs_normals);
+	size_t visible = 0;
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		simd_lanes4f distance = kernel_cull_sphere_lanes(lanes, simd_lanes4f(_mm_loadu_ps(spheres[0] + i)), simd_lanes4f(_mm_loadu_ps(spheres[1] + i)),
+			simd_lanes4f(_mm_loadu_ps(spheres[2] + i)), simd_lanes4f(_mm_loadu_ps(spheres[3] + i)));
+		visible += kernel_mark_visible(lanes_lt_mask(distance, simd_lanes4f()) ^ 0xFu, i, visible_mask);
+	}
+	return visible + kernel_cull_spheres_scalar(planes, spheres, i, end, visible_mask);
+}
+
+inline size_t kernel_cull_boxesf_sse2(const float* planes, const float* const* boxes, size_t begin, size_t end, uint64_t* visible_mask)
+{
+	simd_lanes4f lanes[24], abs_normals[18];
+	kernel_broadcast_planes(planes, lanes, abs_normals);
+	size_t visible = 0;
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		simd_lanes4f box[6];
+		for (size_t k = 0; k < 6; k++) { box[k] = _mm_loadu_ps(boxes[k] + i); }
+		simd_lanes4f distance = kernel_cull_box_lanes(lanes, abs_normals, box);
+		visible += kernel_mark_visible(lanes_lt_mask(distance, simd_lanes4f()) ^ 0xFu, i, visible_mask);
+	}
+	return visible + kernel_cull_boxes_scalar(planes, boxes, i, end, visible_mask);
+}
+
+inline void kernel_intersect_trianglesf_sse2(const float* ray, const float* const* triangles, size_t begin, size_t end, float t_min, float* hit, size_t* primitive)
+{
+	simd_lanes4f lanes_ray[6];
+	for (size_t k = 0; k < 6; k++) { lanes_ray[k] = simd_lanes4f(ray[k]); }
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		simd_lanes4f triangle[9], t, u, v;
+		for (size_t k = 0; k < 9; k++) { triangle[k] = _mm_loadu_ps(triangles[k] + i); }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(lanes_ray, triangle, simd_lanes4f(t_min), simd_lanes4f(hit[0]), t, u, v);
+		if (lane_mask != 0)
+		{
+			float lanes[3][4];
+			_mm_storeu_ps(lanes[0], t.v); _mm_storeu_ps(lanes[1], u.v); _mm_storeu_ps(lanes[2], v.v);
+			kernel_closest_hit(lane_mask, i, lanes[0], lanes[1], lanes[2], hit, primitive);
+		}
+	}
+	kernel_intersect_triangles_scalar(ray, triangles, i, end, t_min, hit, primitive);
+}
+
+inline void kernel_intersect_raysf_sse2(const float* const* rays, size_t begin, size_t end, const float* triangle, size_t triangle_index, float t_min, float* const* hits, size_t* primitives)
+{
+	simd_lanes4f lanes_triangle[9];
+	for (size_t k = 0; k < 9; k++) { lanes_triangle[k] = simd_lanes4f(triangle[k]); }
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		simd_lanes4f ray[6], t, u, v;
+		for (size_t k = 0; k < 6; k++) { ray[k] = _mm_loadu_ps(rays[k] + i); }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(ray, lanes_triangle, simd_lanes4f(t_min), simd_lanes4f(_mm_loadu_ps(hits[0] + i)), t, u, v);
+		if (lane_mask != 0)
+		{
+			float lanes[3][4];
+			_mm_storeu_ps(lanes[0], t.v); _mm_storeu_ps(lanes[1], u.v); _mm_storeu_ps(lanes[2], v.v);
+			kernel_store_hits(lane_mask, i, triangle_index, lanes[0], lanes[1], lanes[2], hits, primitives);
+		}
+	}
+	kernel_intersect_rays_scalar(rays, i, end, triangle, triangle_index, t_min, hits, primitives);
+}
+
+inline void kernel_reduce_boundsf_sse2(const float* const* components, size_t count, float* out)
+{
+	simd_lanes4f acc[9];
+	kernel_reduce_bounds_identity(acc);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f c[3];
+		for (size_t k = 0; k < 3; k++) { c[k] = _mm_loadu_ps(components[k] + i); }
+		kernel_reduce_bounds_lanes(c, acc);
+	}
+	const float* tail[] = { components[0] + i, components[1] + i, components[2] + i };
+	kernel_reduce_bounds_scalar(tail, count - i, out);
+	float lanes[9][4];
+	for (size_t k = 0; k < 9; k++) { _mm_storeu_ps(lanes[k], acc[k].v); }
+	kernel_reduce_merge_lanes(&lanes[0][0], 4, out, kernel_reduce_bounds_merge<float>);
+}
+
+inline void kernel_reduce_momentsf_sse2(const float* const* components, size_t count, const float* center, float* out)
+{
+	simd_lanes4f acc[9], lanes_center[3];
+	for (size_t k = 0; k < 3; k++) { lanes_center[k] = simd_lanes4f(center[k]); }
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		simd_lanes4f c[3];
+		for (size_t k = 0; k < 3; k++) { c[k] = _mm_loadu_ps(components[k] + i); }
+		kernel_reduce_moments_lanes(c, lanes_center, acc);
+	}
+	const float* tail[] = { components[0] + i, components[1] + i, components[2] + i };
+	kernel_reduce_moments_scalar(tail, count - i, center, out);
+	float lanes[9][4];
+	for (size_t k = 0; k < 9; k++) { _mm_storeu_ps(lanes[k], acc[k].v); }
+	kernel_reduce_merge_lanes(&lanes[0][0], 4, out, kernel_reduce_moments_merge<float>);
+}
+
+MATH_TARGET("sse4.1")
+inline void kernel_normalize_vec4f_sse41(float* data, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		__m128 v = _mm_loadu_ps(data + i * 4);
+		_mm_storeu_ps(data + i * 4, _mm_div_ps(v, _mm_sqrt_ps(_mm_dp_ps(v, v, 0xFF))));
+	}
+}
+
+MATH_TARGET("sse4.1")
+inline void kernel_dot_vec4f_sse41(const float* vecs1, const float* vecs2, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = _mm_cvtss_f32(_mm_dp_ps(_mm_loadu_ps(vecs1 + i * 4), _mm_loadu_ps(vecs2 + i * 4), 0xF1));
+	}
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_transform_vec4f_avx2(const float* in, float* out, size_t count, const float* mat, bool is_row_vector)
+{
+	__m128 r0, r1, r2, r3;
+	kernel_load_transform_rows(mat, is_row_vector, r0, r1, r2, r3);
+	__m256 w0 = _mm256_set_m128(r0, r0);
+	__m256 w1 = _mm256_set_m128(r1, r1);
+	__m256 w2 = _mm256_set_m128(r2, r2);
+	__m256 w3 = _mm256_set_m128(r3, r3);
+
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m256 v = _mm256_loadu_ps(in + i * 4);
+		__m256 sum = _mm256_mul_ps(_mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)), w0);
+		sum = _mm256_fmadd_ps(_mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1)), w1, sum);
+		sum = _mm256_fmadd_ps(_mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2)), w2, sum);
+		sum = _mm256_fmadd_ps(_mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3)), w3, sum);
+		_mm256_storeu_ps(out + i * 4, sum);
+	}
+	kernel_transform_vec4f_sse2(in + i * 4, out + i * 4, count - i, mat, is_row_vector);
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_transform_vec3f_avx2(const char* in, size_t in_stride, char* out, size_t out_stride, size_t count, const float* basis, float w, bool perspective_divide)
+{
+	__m256 r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(basis));
+	__m256 r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(basis + 4));
+	__m256 r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(basis + 8));
+	__m256 r3 = _mm256_mul_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(basis + 12)), _mm256_set1_ps(w));
+
+	//Two points per register, one in each 128-bit half
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		const float* v0 = reinterpret_cast<const float*>(in + i * in_stride);
+		const float* v1 = reinterpret_cast<const float*>(in + (i + 1) * in_stride);
+		__m256 x = _mm256_set_m128(_mm_broadcast_ss(v1), _mm_broadcast_ss(v0));
+		__m256 y = _mm256_set_m128(_mm_broadcast_ss(v1 + 1), _mm_broadcast_ss(v0 + 1));
+		__m256 z = _mm256_set_m128(_mm_broadcast_ss(v1 + 2), _mm_broadcast_ss(v0 + 2));
+		__m256 sum = _mm256_fmadd_ps(x, r0, r3);
+		sum = _mm256_fmadd_ps(y, r1, sum);
+		sum = _mm256_fmadd_ps(z, r2, sum);
+		if (perspective_divide)
+		{
+			sum = _mm256_div_ps(sum, _mm256_permute_ps(sum, _MM_SHUFFLE(3, 3, 3, 3)));
+		}
+		kernel_store_vec3f(reinterpret_cast<float*>(out + i * out_stride), _mm256_castps256_ps128(sum));
+		kernel_store_vec3f(reinterpret_cast<float*>(out + (i + 1) * out_stride), _mm256_extractf128_ps(sum, 1));
+	}
+	kernel_transform_vec3f_sse2(in + i * in_stride, in_stride, out + i * out_stride, out_stride, count - i, basis, w, perspective_divide);
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_normalize_vec4f_avx2(float* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m256 v = _mm256_loadu_ps(data + i * 4);
+		__m256 sqr = _mm256_mul_ps(v, v);
+		sqr = _mm256_hadd_ps(sqr, sqr);
+		sqr = _mm256_hadd_ps(sqr, sqr);
+		_mm256_storeu_ps(data + i * 4, _mm256_div_ps(v, _mm256_sqrt_ps(sqr)));
+	}
+	kernel_normalize_vec4f_sse2(data + i * 4, count - i);
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_dot_vec4f_avx2(const float* vecs1, const float* vecs2, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		//Two vectors per register, four registers reduce to the eight sums
+		__m256 p0 = _mm256_mul_ps(_mm256_loadu_ps(vecs1 + i * 4), _mm256_loadu_ps(vecs2 + i * 4));
+		__m256 p1 = _mm256_mul_ps(_mm256_loadu_ps(vecs1 + i * 4 + 8), _mm256_loadu_ps(vecs2 + i * 4 + 8));
+		__m256 p2 = _mm256_mul_ps(_mm256_loadu_ps(vecs1 + i * 4 + 16), _mm256_loadu_ps(vecs2 + i * 4 + 16));
+		__m256 p3 = _mm256_mul_ps(_mm256_loadu_ps(vecs1 + i * 4 + 24), _mm256_loadu_ps(vecs2 + i * 4 + 24));
+		__m256 s01 = _mm256_hadd_ps(p0, p1);
+		__m256 s23 = _mm256_hadd_ps(p2, p3);
+		__m256 s = _mm256_hadd_ps(s01, s23);
+		//s = [d0 d2 d4 d6 | d1 d3 d5 d7]
+		__m128 lo = _mm256_castps256_ps128(s);
+		__m128 hi = _mm256_extractf128_ps(s, 1);
+		_mm_storeu_ps(out + i, _mm_unpacklo_ps(lo, hi));
+		_mm_storeu_ps(out + i + 4, _mm_unpackhi_ps(lo, hi));
+	}
+	kernel_dot_vec4f_sse2(vecs1 + i * 4, vecs2 + i * 4, out + i, count - i);
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_multiply_mat4x4f_avx2(const float* mats1, const float* mats2, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = mats1 + i * 16;
+		const float* b = mats2 + i * 16;
+		__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+		__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+		__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+		__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+
+		//Rows 0-1 and 2-3 of the left matrix, two rows per register
+		__m256 a01 = _mm256_loadu_ps(a);
+		__m256 a23 = _mm256_loadu_ps(a + 8);
+
+		__m256 sum01 = _mm256_mul_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		__m256 sum23 = _mm256_mul_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(1, 1, 1, 1)), b1, sum01);
+		sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(1, 1, 1, 1)), b1, sum23);
+		sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(2, 2, 2, 2)), b2, sum01);
+		sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(2, 2, 2, 2)), b2, sum23);
+		sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(3, 3, 3, 3)), b3, sum01);
+		sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(3, 3, 3, 3)), b3, sum23);
+
+		_mm256_storeu_ps(out + i * 16, sum01);
+		_mm256_storeu_ps(out + i * 16 + 8, sum23);
+	}
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_multiply_left_mat4x4f_avx2(const float* left, const float* mats, float* out, size_t count)
+{
+	//Coefficient k of rows 0-1 and of rows 2-3, two rows per register
+	__m256 l01 = _mm256_loadu_ps(left);
+	__m256 l23 = _mm256_loadu_ps(left + 8);
+	__m256 l01_0 = _mm256_permute_ps(l01, _MM_SHUFFLE(0, 0, 0, 0));
+	__m256 l01_1 = _mm256_permute_ps(l01, _MM_SHUFFLE(1, 1, 1, 1));
+	__m256 l01_2 = _mm256_permute_ps(l01, _MM_SHUFFLE(2, 2, 2, 2));
+	__m256 l01_3 = _mm256_permute_ps(l01, _MM_SHUFFLE(3, 3, 3, 3));
+	__m256 l23_0 = _mm256_permute_ps(l23, _MM_SHUFFLE(0, 0, 0, 0));
+	__m256 l23_1 = _mm256_permute_ps(l23, _MM_SHUFFLE(1, 1, 1, 1));
+	__m256 l23_2 = _mm256_permute_ps(l23, _MM_SHUFFLE(2, 2, 2, 2));
+	__m256 l23_3 = _mm256_permute_ps(l23, _MM_SHUFFLE(3, 3, 3, 3));
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* b = mats + i * 16;
+		__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+		__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+		__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+		__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+		__m256 sum01 = _mm256_mul_ps(l01_0, b0);
+		__m256 sum23 = _mm256_mul_ps(l23_0, b0);
+		sum01 = _mm256_fmadd_ps(l01_1, b1, sum01);
+		sum23 = _mm256_fmadd_ps(l23_1, b1, sum23);
+		sum01 = _mm256_fmadd_ps(l01_2, b2, sum01);
+		sum23 = _mm256_fmadd_ps(l23_2, b2, sum23);
+		sum01 = _mm256_fmadd_ps(l01_3, b3, sum01);
+		sum23 = _mm256_fmadd_ps(l23_3, b3, sum23);
+		_mm256_storeu_ps(out + i * 16, sum01);
+		_mm256_storeu_ps(out + i * 16 + 8, sum23);
+	}
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_multiply_right_mat4x4f_avx2(const float* mats, const float* right, float* out, size_t count)
+{
+	__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right));
+	__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right + 4));
+	__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right + 8));
+	__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(right + 12));
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = mats + i * 16;
+		__m256 a01 = _mm256_loadu_ps(a);
+		__m256 a23 = _mm256_loadu_ps(a + 8);
+		__m256 sum01 = _mm256_mul_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		__m256 sum23 = _mm256_mul_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(1, 1, 1, 1)), b1, sum01);
+		sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(1, 1, 1, 1)), b1, sum23);
+		sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(2, 2, 2, 2)), b2, sum01);
+		sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(2, 2, 2, 2)), b2, sum23);
+		sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(3, 3, 3, 3)), b3, sum01);
+		sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, _MM_SHUFFLE(3, 3, 3, 3)), b3, sum23);
+		_mm256_storeu_ps(out + i * 16, sum01);
+		_mm256_storeu_ps(out + i * 16 + 8, sum23);
+	}
+}
+
+//Eight consecutive 4x4 matrices, lanes 0-3 and 4-7 are gathered as two SSE blocks
+MATH_TARGET("avx2,fma")
+inline void kernel_gather_mat4x4f_avx2(const float* mats, simd_lanes8f* e)
+{
+	__m128 lo[16], hi[16];
+	kernel_gather_mat4x4f_sse2(mats, lo);
+	kernel_gather_mat4x4f_sse2(mats + 64, hi);
+	for (size_t k = 0; k < 16; k++)
+	{
+		e[k] = _mm256_set_m128(hi[k], lo[k]);
+	}
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline size_t kernel_inverse_mat4x4f_avx2(const float* mats, float* out, size_t begin, size_t end, float threshold, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f e[16], d[16], det;
+		kernel_gather_mat4x4f_avx2(mats + i * 16, e);
+		kernel_inverse_mat4x4_lanes(e, d, det);
+		__m128 lo[16], hi[16];
+		for (size_t k = 0; k < 16; k++)
+		{
+			lo[k] = _mm256_castps256_ps128(d[k].v);
+			hi[k] = _mm256_extractf128_ps(d[k].v, 1);
+		}
+		kernel_scatter_mat4x4f_sse2(lo, out + i * 16);
+		kernel_scatter_mat4x4f_sse2(hi, out + i * 16 + 64);
+		singular += kernel_mark_singular(lanes_abs_le_mask(det, threshold), i, out, 4, singular_mask);
+	}
+	return singular + kernel_inverse_mat4x4f_sse2(mats, out, i, end, threshold, singular_mask);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_det_mat4x4f_avx2(const float* mats, float* out, size_t begin, size_t end)
+{
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f e[16], det;
+		kernel_gather_mat4x4f_avx2(mats + i * 16, e);
+		kernel_det_mat4x4_lanes(e, det);
+		_mm256_storeu_ps(out + i, det.v);
+	}
+	kernel_det_mat4x4f_sse2(mats, out, i, end);
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_gather_mat3x3f_avx2(const float* mats, simd_lanes8f* e)
+{
+	for (size_t k = 0; k < 9; k++)
+	{
+		e[k] = _mm256_setr_ps(mats[k], mats[9 + k], mats[18 + k], mats[27 + k], mats[36 + k], mats[45 + k], mats[54 + k], mats[63 + k]);
+	}
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline size_t kernel_inverse_mat3x3f_avx2(const float* mats, float* out, size_t begin, size_t end, float threshold, uint64_t* singular_mask)
+{
+	size_t singular = 0;
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f e[9], d[9], det;
+		kernel_gather_mat3x3f_avx2(mats + i * 9, e);
+		kernel_inverse_mat3x3_lanes(e, d, det);
+		float lanes[8];
+		for (size_t k = 0; k < 9; k++)
+		{
+			_mm256_storeu_ps(lanes, d[k].v);
+			for (size_t j = 0; j < 8; j++)
+			{
+				out[(i + j) * 9 + k] = lanes[j];
+			}
+		}
+		singular += kernel_mark_singular(lanes_abs_le_mask(det, threshold), i, out, 3, singular_mask);
+	}
+	return singular + kernel_inverse_mat3x3f_sse2(mats, out, i, end, threshold, singular_mask);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_det_mat3x3f_avx2(const float* mats, float* out, size_t begin, size_t end)
+{
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f e[9], det;
+		kernel_gather_mat3x3f_avx2(mats + i * 9, e);
+		kernel_det_mat3x3_lanes(e, det);
+		_mm256_storeu_ps(out + i, det.v);
+	}
+	kernel_det_mat3x3f_sse2(mats, out, i, end);
+}
+
+//Eight consecutive quats, lanes 0-3 and 4-7 are gathered as two SSE blocks
+MATH_TARGET("avx2,fma")
+inline void kernel_gather_quatf_avx2(const float* quats, simd_lanes8f* q)
+{
+	simd_lanes4f lo[4], hi[4];
+	kernel_gather_quatf_sse2(quats, lo);
+	kernel_gather_quatf_sse2(quats + 16, hi);
+	for (size_t k = 0; k < 4; k++)
+	{
+		q[k] = _mm256_set_m128(hi[k].v, lo[k].v);
+	}
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_scatter_quatf_avx2(const simd_lanes8f* q, float* out)
+{
+	simd_lanes4f lo[4], hi[4];
+	for (size_t k = 0; k < 4; k++)
+	{
+		lo[k] = _mm256_castps256_ps128(q[k].v);
+		hi[k] = _mm256_extractf128_ps(q[k].v, 1);
+	}
+	kernel_scatter_quatf_sse2(lo, out);
+	kernel_scatter_quatf_sse2(hi, out + 16);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_multiply_quatf_avx2(const float* quats1, const float* quats2, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f a[4], b[4], r[4];
+		kernel_gather_quatf_avx2(quats1 + i * 4, a);
+		kernel_gather_quatf_avx2(quats2 + i * 4, b);
+		kernel_multiply_quat_lanes(a, b, r);
+		kernel_scatter_quatf_avx2(r, out + i * 4);
+	}
+	kernel_multiply_quatf_sse2(quats1 + i * 4, quats2 + i * 4, out + i * 4, count - i);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_rotate_quatf_avx2(const float* quats, size_t quat_step, const float* vecs, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f q[4], v[3], r[3];
+		if (quat_step == 0)
+		{
+			for (size_t k = 0; k < 4; k++) { q[k] = simd_lanes8f(quats[k]); }
+		}
+		else
+		{
+			kernel_gather_quatf_avx2(quats + i * 4, q);
+		}
+		const float* p = vecs + i * 3;
+		for (size_t k = 0; k < 3; k++)
+		{
+			v[k] = _mm256_setr_ps(p[k], p[3 + k], p[6 + k], p[9 + k], p[12 + k], p[15 + k], p[18 + k], p[21 + k]);
+		}
+		kernel_rotate_quat_lanes(q, v, r);
+		float lanes[3][8];
+		for (size_t k = 0; k < 3; k++) { _mm256_storeu_ps(lanes[k], r[k].v); }
+		for (size_t j = 0; j < 8; j++)
+		{
+			out[(i + j) * 3] = lanes[0][j]; out[(i + j) * 3 + 1] = lanes[1][j]; out[(i + j) * 3 + 2] = lanes[2][j];
+		}
+	}
+	kernel_rotate_quatf_sse2(quats + i * quat_step, quat_step, vecs + i * 3, out + i * 3, count - i);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_normalize_quatf_avx2(float* quats, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f q[4];
+		kernel_gather_quatf_avx2(quats + i * 4, q);
+		kernel_normalize_quat_lanes(q);
+		kernel_scatter_quatf_avx2(q, quats + i * 4);
+	}
+	kernel_normalize_quatf_sse2(quats + i * 4, count - i);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_nlerp_quatf_avx2(const float* quats1, const float* quats2, const float* t, size_t t_step, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f a[4], b[4], r[4];
+		kernel_gather_quatf_avx2(quats1 + i * 4, a);
+		kernel_gather_quatf_avx2(quats2 + i * 4, b);
+		simd_lanes8f lanes_t = t_step == 0 ? simd_lanes8f(t[0]) : simd_lanes8f(_mm256_loadu_ps(t + i));
+		kernel_nlerp_quat_lanes(a, b, lanes_t, r);
+		kernel_scatter_quatf_avx2(r, out + i * 4);
+	}
+	kernel_nlerp_quatf_sse2(quats1 + i * 4, quats2 + i * 4, t + i * t_step, t_step, out + i * 4, count - i);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_to_mat4x4_quatf_avx2(const float* quats, float* out, size_t count, bool is_row_vector)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f q[4], m[9];
+		kernel_gather_quatf_avx2(quats + i * 4, q);
+		kernel_rotation_quat_lanes(q, m);
+		simd_lanes4f lo[9], hi[9];
+		for (size_t k = 0; k < 9; k++)
+		{
+			lo[k] = _mm256_castps256_ps128(m[k].v);
+			hi[k] = _mm256_extractf128_ps(m[k].v, 1);
+		}
+		kernel_scatter_rotation_mat4x4f_sse2(lo, out + i * 16, is_row_vector);
+		kernel_scatter_rotation_mat4x4f_sse2(hi, out + (i + 4) * 16, is_row_vector);
+	}
+	kernel_to_mat4x4_quatf_sse2(quats + i * 4, out + i * 16, count - i, is_row_vector);
+}
+
+MATH_TARGET("avx2,fma")
+inline void kernel_rsqrtf_avx2(const float* in, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(out + i, lanes_rsqrt(simd_lanes8f(_mm256_loadu_ps(in + i))).v);
+	}
+	kernel_rsqrtf_sse2(in + i, out + i, count - i);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_fast_length_soaf_avx2(const float* const* components, size_t dimension, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f c[4];
+		for (size_t k = 0; k < dimension; k++) { c[k] = _mm256_loadu_ps(components[k] + i); }
+		_mm256_storeu_ps(out + i, kernel_fast_length_lanes(kernel_sqr_length_soa_lanes(c, dimension)).v);
+	}
+	const float* rest[4];
+	for (size_t k = 0; k < dimension; k++) { rest[k] = components[k] + i; }
+	kernel_fast_length_soaf_sse2(rest, dimension, out + i, count - i);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_fast_normalize_soaf_avx2(float* const* components, size_t dimension, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f c[4];
+		for (size_t k = 0; k < dimension; k++) { c[k] = _mm256_loadu_ps(components[k] + i); }
+		simd_lanes8f length_inv = lanes_rsqrt(kernel_sqr_length_soa_lanes(c, dimension));
+		for (size_t k = 0; k < dimension; k++) { _mm256_storeu_ps(components[k] + i, (c[k] * length_inv).v); }
+	}
+	float* rest[4];
+	for (size_t k = 0; k < dimension; k++) { rest[k] = components[k] + i; }
+	kernel_fast_normalize_soaf_sse2(rest, dimension, count - i);
+}
+
+template<bool is_precise>
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_sincosf_avx2_run(const float* radians, float* sin_out, float* cos_out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f sin_value, cos_value;
+		kernel_sincos_lanes<is_precise>(simd_lanes8f(_mm256_loadu_ps(radians + i)), sin_value, cos_value);
+		_mm256_storeu_ps(sin_out + i, sin_value.v);
+		_mm256_storeu_ps(cos_out + i, cos_value.v);
+	}
+	kernel_sincosf_sse2_run<is_precise>(radians + i, sin_out + i, cos_out + i, count - i);
+}
+
+template<bool is_precise>
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_atan2f_avx2_run(const float* y, const float* x, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(out + i, kernel_atan2_lanes<is_precise>(simd_lanes8f(_mm256_loadu_ps(y + i)), simd_lanes8f(_mm256_loadu_ps(x + i))).v);
+	}
+	kernel_atan2f_sse2_run<is_precise>(y + i, x + i, out + i, count - i);
+}
+
+template<bool is_precise>
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_acosf_avx2_run(const float* in, float* out, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(out + i, kernel_acos_lanes<is_precise>(simd_lanes8f(_mm256_loadu_ps(in + i))).v);
+	}
+	kernel_acosf_sse2_run<is_precise>(in + i, out + i, count - i);
+}
+
+inline void kernel_sincosf_avx2(const float* radians, float* sin_out, float* cos_out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_sincosf_avx2_run<true>(radians, sin_out, cos_out, count); }
+	else { kernel_sincosf_avx2_run<false>(radians, sin_out, cos_out, count); }
+}
+
+inline void kernel_atan2f_avx2(const float* y, const float* x, float* out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_atan2f_avx2_run<true>(y, x, out, count); }
+	else { kernel_atan2f_avx2_run<false>(y, x, out, count); }
+}
+
+inline void kernel_acosf_avx2(const float* in, float* out, size_t count, elementary_accuracy accuracy)
+{
+	if (accuracy == elementary_accuracy::precise) { kernel_acosf_avx2_run<true>(in, out, count); }
+	else { kernel_acosf_avx2_run<false>(in, out, count); }
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline size_t kernel_cull_spheresf_avx2(const float* planes, const float* const* spheres, size_t begin, size_t end, uint64_t* visible_mask)
+{
+	simd_lanes8f lanes[24], abs_normals[18];
+	kernel_broadcast_planes(planes, lanes, abs_normals);
+	size_t visible = 0;
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f distance = kernel_cull_sphere_lanes(lanes, simd_lanes8f(_mm256_loadu_ps(spheres[0] + i)), simd_lanes8f(_mm256_loadu_ps(spheres[1] + i)),
+			simd_lanes8f(_mm256_loadu_ps(spheres[2] + i)), simd_lanes8f(_mm256_loadu_ps(spheres[3] + i)));
+		visible += kernel_mark_visible(lanes_lt_mask(distance, simd_lanes8f()) ^ 0xFFu, i, visible_mask);
+	}
+	return visible + kernel_cull_spheresf_sse2(planes, spheres, i, end, visible_mask);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline size_t kernel_cull_boxesf_avx2(const float* planes, const float* const* boxes, size_t begin, size_t end, uint64_t* visible_mask)
+{
+	simd_lanes8f lanes[24], abs_normals[18];
+	kernel_broadcast_planes(planes, lanes, abs_normals);
+	size_t visible = 0;
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f box[6];
+		for (size_t k = 0; k < 6; k++) { box[k] = _mm256_loadu_ps(boxes[k] + i); }
+		simd_lanes8f distance = kernel_cull_box_lanes(lanes, abs_normals, box);
+		visible += kernel_mark_visible(lanes_lt_mask(distance, simd_lanes8f()) ^ 0xFFu, i, visible_mask);
+	}
+	return visible + kernel_cull_boxesf_sse2(planes, boxes, i, end, visible_mask);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_intersect_trianglesf_avx2(const float* ray, const float* const* triangles, size_t begin, size_t end, float t_min, float* hit, size_t* primitive)
+{
+	simd_lanes8f lanes_ray[6];
+	for (size_t k = 0; k < 6; k++) { lanes_ray[k] = simd_lanes8f(ray[k]); }
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f triangle[9], t, u, v;
+		for (size_t k = 0; k < 9; k++) { triangle[k] = _mm256_loadu_ps(triangles[k] + i); }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(lanes_ray, triangle, simd_lanes8f(t_min), simd_lanes8f(hit[0]), t, u, v);
+		if (lane_mask != 0)
+		{
+			float lanes[3][8];
+			_mm256_storeu_ps(lanes[0], t.v); _mm256_storeu_ps(lanes[1], u.v); _mm256_storeu_ps(lanes[2], v.v);
+			kernel_closest_hit(lane_mask, i, lanes[0], lanes[1], lanes[2], hit, primitive);
+		}
+	}
+	kernel_intersect_trianglesf_sse2(ray, triangles, i, end, t_min, hit, primitive);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_intersect_raysf_avx2(const float* const* rays, size_t begin, size_t end, const float* triangle, size_t triangle_index, float t_min, float* const* hits, size_t* primitives)
+{
+	simd_lanes8f lanes_triangle[9];
+	for (size_t k = 0; k < 9; k++) { lanes_triangle[k] = simd_lanes8f(triangle[k]); }
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		simd_lanes8f ray[6], t, u, v;
+		for (size_t k = 0; k < 6; k++) { ray[k] = _mm256_loadu_ps(rays[k] + i); }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(ray, lanes_triangle, simd_lanes8f(t_min), simd_lanes8f(_mm256_loadu_ps(hits[0] + i)), t, u, v);
+		if (lane_mask != 0)
+		{
+			float lanes[3][8];
+			_mm256_storeu_ps(lanes[0], t.v); _mm256_storeu_ps(lanes[1], u.v); _mm256_storeu_ps(lanes[2], v.v);
+			kernel_store_hits(lane_mask, i, triangle_index, lanes[0], lanes[1], lanes[2], hits, primitives);
+		}
+	}
+	kernel_intersect_raysf_sse2(rays, i, end, triangle, triangle_index, t_min, hits, primitives);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_reduce_boundsf_avx2(const float* const* components, size_t count, float* out)
+{
+	simd_lanes8f acc[9];
+	kernel_reduce_bounds_identity(acc);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f c[3];
+		for (size_t k = 0; k < 3; k++) { c[k] = _mm256_loadu_ps(components[k] + i); }
+		kernel_reduce_bounds_lanes(c, acc);
+	}
+	const float* tail[] = { components[0] + i, components[1] + i, components[2] + i };
+	kernel_reduce_boundsf_sse2(tail, count - i, out);
+	float lanes[9][8];
+	for (size_t k = 0; k < 9; k++) { _mm256_storeu_ps(lanes[k], acc[k].v); }
+	kernel_reduce_merge_lanes(&lanes[0][0], 8, out, kernel_reduce_bounds_merge<float>);
+}
+
+MATH_TARGET("avx2,fma") MATH_FLATTEN
+inline void kernel_reduce_momentsf_avx2(const float* const* components, size_t count, const float* center, float* out)
+{
+	simd_lanes8f acc[9], lanes_center[3];
+	for (size_t k = 0; k < 3; k++) { lanes_center[k] = simd_lanes8f(center[k]); }
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		simd_lanes8f c[3];
+		for (size_t k = 0; k < 3; k++) { c[k] = _mm256_loadu_ps(components[k] + i); }
+		kernel_reduce_moments_lanes(c, lanes_center, acc);
+	}
+	const float* tail[] = { components[0] + i, components[1] + i, components[2] + i };
+	kernel_reduce_momentsf_sse2(tail, count - i, center, out);
+	float lanes[9][8];
+	for (size_t k = 0; k < 9; k++) { _mm256_storeu_ps(lanes[k], acc[k].v); }
+	kernel_reduce_merge_lanes(&lanes[0][0], 8, out, kernel_reduce_moments_merge<float>);
+}
+
+MATH_TARGET("avx512f")
+inline void kernel_transform_vec4f_avx512(const float* in, float* out, size_t count, const float* mat, bool is_row_vector)
+{
+	__m128 r0, r1, r2, r3;
+	kernel_load_transform_rows(mat, is_row_vector, r0, r1, r2, r3);
+	__m512 w0 = _mm512_broadcast_f32x4(r0);
+	__m512 w1 = _mm512_broadcast_f32x4(r1);
+	__m512 w2 = _mm512_broadcast_f32x4(r2);
+	__m512 w3 = _mm512_broadcast_f32x4(r3);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m512 v = _mm512_loadu_ps(in + i * 4);
+		__m512 sum = _mm512_mul_ps(_mm512_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)), w0);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1)), w1, sum);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2)), w2, sum);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3)), w3, sum);
+		_mm512_storeu_ps(out + i * 4, sum);
+	}
+	kernel_transform_vec4f_sse2(in + i * 4, out + i * 4, count - i, mat, is_row_vector);
+}
+
+MATH_TARGET("avx512f")
+inline void kernel_multiply_mat4x4f_avx512(const float* mats1, const float* mats2, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* a = mats1 + i * 16;
+		const float* b = mats2 + i * 16;
+		__m512 b0 = _mm512_broadcast_f32x4(_mm_loadu_ps(b));
+		__m512 b1 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 4));
+		__m512 b2 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 8));
+		__m512 b3 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 12));
+
+		//All four rows of the left matrix in one register
+		__m512 rows = _mm512_loadu_ps(a);
+		__m512 sum = _mm512_mul_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b1, sum);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b2, sum);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b3, sum);
+		_mm512_storeu_ps(out + i * 16, sum);
+	}
+}
+
+MATH_TARGET("avx512f")
+inline void kernel_multiply_left_mat4x4f_avx512(const float* left, const float* mats, float* out, size_t count)
+{
+	__m512 rows = _mm512_loadu_ps(left);
+	__m512 l0 = _mm512_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0));
+	__m512 l1 = _mm512_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1));
+	__m512 l2 = _mm512_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2));
+	__m512 l3 = _mm512_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3));
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* b = mats + i * 16;
+		__m512 sum = _mm512_mul_ps(l0, _mm512_broadcast_f32x4(_mm_loadu_ps(b)));
+		sum = _mm512_fmadd_ps(l1, _mm512_broadcast_f32x4(_mm_loadu_ps(b + 4)), sum);
+		sum = _mm512_fmadd_ps(l2, _mm512_broadcast_f32x4(_mm_loadu_ps(b + 8)), sum);
+		sum = _mm512_fmadd_ps(l3, _mm512_broadcast_f32x4(_mm_loadu_ps(b + 12)), sum);
+		_mm512_storeu_ps(out + i * 16, sum);
+	}
+}
+
+MATH_TARGET("avx512f")
+inline void kernel_multiply_right_mat4x4f_avx512(const float* mats, const float* right, float* out, size_t count)
+{
+	__m512 b0 = _mm512_broadcast_f32x4(_mm_loadu_ps(right));
+	__m512 b1 = _mm512_broadcast_f32x4(_mm_loadu_ps(right + 4));
+	__m512 b2 = _mm512_broadcast_f32x4(_mm_loadu_ps(right + 8));
+	__m512 b3 = _mm512_broadcast_f32x4(_mm_loadu_ps(right + 12));
+	for (size_t i = 0; i < count; i++)
+	{
+		__m512 rows = _mm512_loadu_ps(mats + i * 16);
+		__m512 sum = _mm512_mul_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b1, sum);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b2, sum);
+		sum = _mm512_fmadd_ps(_mm512_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b3, sum);
+		_mm512_storeu_ps(out + i * 16, sum);
+	}
+}
+
+MATH_TARGET("avx512f") MATH_FLATTEN
+inline void kernel_intersect_trianglesf_avx512(const float* ray, const float* const* triangles, size_t begin, size_t end, float t_min, float* hit, size_t* primitive)
+{
+	simd_lanes16f lanes_ray[6];
+	for (size_t k = 0; k < 6; k++) { lanes_ray[k] = simd_lanes16f(ray[k]); }
+	size_t i = begin;
+	for (; i + 16 <= end; i += 16)
+	{
+		simd_lanes16f triangle[9], t, u, v;
+		for (size_t k = 0; k < 9; k++) { triangle[k] = _mm512_loadu_ps(triangles[k] + i); }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(lanes_ray, triangle, simd_lanes16f(t_min), simd_lanes16f(hit[0]), t, u, v);
+		if (lane_mask != 0)
+		{
+			float lanes[3][16];
+			_mm512_storeu_ps(lanes[0], t.v); _mm512_storeu_ps(lanes[1], u.v); _mm512_storeu_ps(lanes[2], v.v);
+			kernel_closest_hit(lane_mask, i, lanes[0], lanes[1], lanes[2], hit, primitive);
+		}
+	}
+	kernel_intersect_trianglesf_avx2(ray, triangles, i, end, t_min, hit, primitive);
+}
+
+MATH_TARGET("avx512f") MATH_FLATTEN
+inline void kernel_intersect_raysf_avx512(const float* const* rays, size_t begin, size_t end, const float* triangle, size_t triangle_index, float t_min, float* const* hits, size_t* primitives)
+{
+	simd_lanes16f lanes_triangle[9];
+	for (size_t k = 0; k < 9; k++) { lanes_triangle[k] = simd_lanes16f(triangle[k]); }
+	size_t i = begin;
+	for (; i + 16 <= end; i += 16)
+	{
+		simd_lanes16f ray[6], t, u, v;
+		for (size_t k = 0; k < 6; k++) { ray[k] = _mm512_loadu_ps(rays[k] + i); }
+		unsigned int lane_mask = kernel_intersect_triangle_lanes(ray, lanes_triangle, simd_lanes16f(t_min), simd_lanes16f(_mm512_loadu_ps(hits[0] + i)), t, u, v);
+		if (lane_mask != 0)
+		{
+			float lanes[3][16];
+			_mm512_storeu_ps(lanes[0], t.v); _mm512_storeu_ps(lanes[1], u.v); _mm512_storeu_ps(lanes[2], v.v);
+			kernel_store_hits(lane_mask, i, triangle_index, lanes[0], lanes[1], lanes[2], hits, primitives);
+		}
+	}
+	kernel_intersect_raysf_avx2(rays, i, end, triangle, triangle_index, t_min, hits, primitives);
+}
+
+MATH_TARGET("avx512f") MATH_FLATTEN
+inline void kernel_reduce_boundsf_avx512(const float* const* components, size_t count, float* out)
+{
+	simd_lanes16f acc[9];
+	kernel_reduce_bounds_identity(acc);
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		simd_lanes16f c[3];
+		for (size_t k = 0; k < 3; k++) { c[k] = _mm512_loadu_ps(components[k] + i); }
+		kernel_reduce_bounds_lanes(c, acc);
+	}
+	const float* tail[] = { components[0] + i, components[1] + i, components[2] + i };
+	kernel_reduce_boundsf_avx2(tail, count - i, out);
+	float lanes[9][16];
+	for (size_t k = 0; k < 9; k++) { _mm512_storeu_ps(lanes[k], acc[k].v); }
+	kernel_reduce_merge_lanes(&lanes[0][0], 16, out, kernel_reduce_bounds_merge<float>);
+}
+
+MATH_TARGET("avx512f") MATH_FLATTEN
+inline void kernel_reduce_momentsf_avx512(const float* const* components, size_t count, const float* center, float* out)
+{
+	simd_lanes16f acc[9], lanes_center[3];
+	for (size_t k = 0; k < 3; k++) { lanes_center[k] = simd_lanes16f(center[k]); }
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		simd_lanes16f c[3];
+		for (size_t k = 0; k < 3; k++) { c[k] = _mm512_loadu_ps(components[k] + i); }
+		kernel_reduce_moments_lanes(c, lanes_center, acc);
+	}
+	const float* tail[] = { components[0] + i, components[1] + i, components[2] + i };
+	kernel_reduce_momentsf_avx2(tail, count - i, center, out);
+	float lanes[9][16];
+	for (size_t k = 0; k < 9; k++) { _mm512_storeu_ps(lanes[k], acc[k].v); }
+	kernel_reduce_merge_lanes(&lanes[0][0], 16, out, kernel_reduce_moments_merge<float>);
+}
+
+#endif // MATH_SSE2
+
+#endif // !__KERNELS__
@@ -32,19 +32,16 @@ private:
 	std::array<std::array<T, 3>, 3> elements;
 
 public:
-	static mat3x3<T> zero;
-	static mat3x3<T> identity;
+	static const mat3x3<T> zero;
+	static const mat3x3<T> identity;
 
 public:
-	mat3x3()
+	constexpr mat3x3() : elements{ { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } } }
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of mat3x3 must be a floating-point type!");
-		elements[0] = { 1.0, 0.0, 0.0 };
-		elements[1] = { 0.0, 1.0, 0.0 };
-		elements[2] = { 0.0, 0.0, 1.0 };
 	}
 
-	mat3x3(T* elements, bool is_input_row_major = true/*or column major?*/)
+	constexpr mat3x3(const T* elements, bool is_input_row_major = true/*or column major?*/) : elements()
 	{
 		if (is_input_row_major)
 		{
@@ -60,15 +57,13 @@ public:
 		}
 	}
 
-	mat3x3(T e00, T e01, T e02, T e10, T e11, T e12, T e20, T e21, T e22)
+	constexpr mat3x3(T e00, T e01, T e02, T e10, T e11, T e12, T e20, T e21, T e22)
+		: elements{ { { e00, e01, e02 }, { e10, e11, e12 }, { e20, e21, e22 } } }
 	{
-		elements[0] = { e00, e01, e02 };
-		elements[1] = { e10, e11, e12 };
-		elements[2] = { e20, e21, e22 };
 	}
 
-	mat3x3(std::array<T, 3> subs0, std::array<T, 3> subs1, std::array<T, 3> subs2, 
-		bool is_input_row_major = true/*or column major?*/)
+	constexpr mat3x3(std::array<T, 3> subs0, std::array<T, 3> subs1, std::array<T, 3> subs2, 
+		bool is_input_row_major = true/*or column major?*/) : elements()
 	{
 		if (is_input_row_major)
 		{
@@ -103,46 +98,81 @@ public:
 		return ptr;
 	}
 
-	T& operator()(size_t row_index, size_t col_index)
+	constexpr T* ptr()
 	{
-		if (row_index >= 3 || col_index >= 3 || row_index < 0 || col_index < 0) { throw std::out_of_range("mat3x3 index out of range!"); }
+		return &elements[0][0];
+	}
+
+	constexpr const T* ptr() const
+	{
+		return &elements[0][0];
+	}
+
+	constexpr T& operator()(size_t row_index, size_t col_index)
+	{
+		MATH_CHECK_INDEX(row_index >= 3 || col_index >= 3, "mat3x3 index out of range!");
 		return elements[row_index][col_index];
 	}
 
-	T operator()(size_t row_index, size_t col_index) const
+	constexpr T operator()(size_t row_index, size_t col_index) const
 	{
-		if (row_index >= 3 || col_index >= 3 || row_index < 0 || col_index < 0) { throw std::out_of_range("mat3x3 index out of range!"); }
+		MATH_CHECK_INDEX(row_index >= 3 || col_index >= 3, "mat3x3 index out of range!");
 		return elements[row_index][col_index];
 	}
 
-	std::array<T, 3> row(size_t index) const
+	//Unchecked runtime access, for loops whose indices are known to be in range
+	constexpr T& unchecked(size_t row_index, size_t col_index)
 	{
-		if (index >= 3 || index < 0) { throw std::out_of_range("mat3x3 index out of range!"); }
+		return elements[row_index][col_index];
+	}
+
+	constexpr T unchecked(size_t row_index, size_t col_index) const
+	{
+		return elements[row_index][col_index];
+	}
+
+	template<size_t R, size_t C>
+	constexpr T& get()
+	{
+		static_assert(R < 3 && C < 3, "mat3x3 index out of range!");
+		return elements[R][C];
+	}
+
+	template<size_t R, size_t C>
+	constexpr T get() const
+	{
+		static_assert(R < 3 && C < 3, "mat3x3 index out of range!");
+		return elements[R][C];
+	}
+
+	constexpr std::array<T, 3> row(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= 3, "mat3x3 index out of range!");
 		return elements[index];
 	}
 
-	std::array<T, 3> col(size_t index) const
+	constexpr std::array<T, 3> col(size_t index) const
 	{
-		if (index >= 3 || index < 0) { throw std::out_of_range("mat3x3 index out of range!"); }
+		MATH_CHECK_INDEX(index >= 3, "mat3x3 index out of range!");
 		return { elements[0][index], elements[1][index], elements[2][index] };
 	}
 
-	void set_row(size_t index, std::array<T, 3> rows)
+	constexpr void set_row(size_t index, std::array<T, 3> rows)
 	{
-		if (index >= 3 || index < 0) { throw std::out_of_range("mat3x3 index out of range!"); }
+		MATH_CHECK_INDEX(index >= 3, "mat3x3 index out of range!");
 		elements[index] = rows;
 	}
 
-	void set_col(size_t index, std::array<T, 3> cols)
+	constexpr void set_col(size_t index, std::array<T, 3> cols)
 	{
-		if (index >= 3 || index < 0) { throw std::out_of_range("mat3x3 index out of range!"); }
-		elements[0][index] = rows[0];
-		elements[1][index] = rows[1];
-		elements[2][index] = rows[2];
+		MATH_CHECK_INDEX(index >= 3, "mat3x3 index out of range!");
+		elements[0][index] = cols[0];
+		elements[1][index] = cols[1];
+		elements[2][index] = cols[2];
 	}
 
 public:
-	T det() const
+	constexpr T det() const
 	{
 		T cofactor00 = elements[1][1] * elements[2][2] - elements[1][2] * elements[2][1];
 		T cofactor10 = elements[1][2] * elements[2][0] - elements[1][0] * elements[2][2];
@@ -151,20 +181,20 @@ public:
 		return elements[0][0] * cofactor00 + elements[0][1] * cofactor10 + elements[0][2] * cofactor20;
 	}
 
-	std::tuple<bool, mat3x3<T>> inverse(T threshold = FLOATING_POINT_THRESHOLD) const
+	constexpr std::tuple<bool, mat3x3<T>> inverse(T threshold = FLOATING_POINT_THRESHOLD) const
 	{
 		mat3x3<T> inversed;
-		inversed(0, 0) = elements[1][1] * elements[2][2] - elements[1][2] * elements[2][1];
-		inversed(0, 1) = elements[0][2] * elements[2][1] - elements[0][1] * elements[2][2];
-		inversed(0, 2) = elements[0][1] * elements[1][2] - elements[0][2] * elements[1][1];
-		inversed(1, 0) = elements[1][2] * elements[2][0] - elements[1][0] * elements[2][2];
-		inversed(1, 1) = elements[0][0] * elements[2][2] - elements[0][2] * elements[2][0];
-		inversed(1, 2) = elements[0][2] * elements[1][0] - elements[0][0] * elements[1][2];
-		inversed(2, 0) = elements[1][0] * elements[2][1] - elements[1][1] * elements[2][0];
-		inversed(2, 1) = elements[0][1] * elements[2][0] - elements[0][0] * elements[2][1];
-		inversed(2, 2) = elements[0][0] * elements[1][1] - elements[0][1] * elements[1][0];
-
-		T det = elements[0][0] * inversed(0, 0) + elements[0][1] * inversed(1, 0) + elements[0][2] * inversed(2, 0);
+		inversed.unchecked(0, 0) = elements[1][1] * elements[2][2] - elements[1][2] * elements[2][1];
+		inversed.unchecked(0, 1) = elements[0][2] * elements[2][1] - elements[0][1] * elements[2][2];
+		inversed.unchecked(0, 2) = elements[0][1] * elements[1][2] - elements[0][2] * elements[1][1];
+		inversed.unchecked(1, 0) = elements[1][2] * elements[2][0] - elements[1][0] * elements[2][2];
+		inversed.unchecked(1, 1) = elements[0][0] * elements[2][2] - elements[0][2] * elements[2][0];
+		inversed.unchecked(1, 2) = elements[0][2] * elements[1][0] - elements[0][0] * elements[1][2];
+		inversed.unchecked(2, 0) = elements[1][0] * elements[2][1] - elements[1][1] * elements[2][0];
+		inversed.unchecked(2, 1) = elements[0][1] * elements[2][0] - elements[0][0] * elements[2][1];
+		inversed.unchecked(2, 2) = elements[0][0] * elements[1][1] - elements[0][1] * elements[1][0];
+
+		T det = elements[0][0] * inversed.unchecked(0, 0) + elements[0][1] * inversed.unchecked(1, 0) + elements[0][2] * inversed.unchecked(2, 0);
 
 		if (abs(det) <= threshold)
 		{
@@ -177,21 +207,21 @@ public:
 		{
 			for (size_t col = 0; col < 3; col++)
 			{
-				inversed(row, col) *= det_inv;
+				inversed.unchecked(row, col) *= det_inv;
 			}
 		}
 
 		return { true, inversed };
 	}
 
-	mat3x3<T> transpose() const
+	constexpr mat3x3<T> transpose() const
 	{
 		mat3x3<T> ret;
 		for (size_t row = 0; row < 3; row++)
 		{
 			for (size_t col = 0; col < 3; col++)
 			{
-				ret(row, col) = elements(col, row);
+				ret.unchecked(row, col) = elements[col][row];
 			}
 		}
 		return ret;
@@ -206,20 +236,16 @@ private:
 	std::array<std::array<T, 4>, 4> elements;
 
 public:
-	static mat4x4<T> zero;
-	static mat4x4<T> identity;
+	static const mat4x4<T> zero;
+	static const mat4x4<T> identity;
 
 public:
-	mat4x4()
+	constexpr mat4x4() : elements{ { { 1.0, 0.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0, 0.0 }, { 0.0, 0.0, 1.0, 0.0 }, { 0.0, 0.0, 0.0, 1.0 } } }
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of mat4x4 must be a floating-point type!");
-		elements[0] = { 1.0, 0.0, 0.0, 0.0 };
-		elements[1] = { 0.0, 1.0, 0.0, 0.0 };
-		elements[2] = { 0.0, 0.0, 1.0, 0.0 };
-		elements[3] = { 0.0, 0.0, 0.0, 1.0 };
 	}
 
-	mat4x4(T* elements, bool is_input_row_major = true/*or column major?*/)
+	constexpr mat4x4(const T* elements, bool is_input_row_major = true/*or column major?*/) : elements()
 	{
 		if (is_input_row_major)
 		{
@@ -237,16 +263,13 @@ public:
 		}
 	}
 
-	mat4x4(T e00, T e01, T e02, T e03, T e10, T e11, T e12, T e13, T e20, T e21, T e22, T e23, T e30, T e31, T e32, T e33)
+	constexpr mat4x4(T e00, T e01, T e02, T e03, T e10, T e11, T e12, T e13, T e20, T e21, T e22, T e23, T e30, T e31, T e32, T e33)
+		: elements{ { { e00, e01, e02, e03 }, { e10, e11, e12, e13 }, { e20, e21, e22, e23 }, { e30, e31, e32, e33 } } }
 	{
-		elements[0] = { e00, e01, e02, e03 };
-		elements[1] = { e10, e11, e12, e13 };
-		elements[2] = { e20, e21, e22, e23 };
-		elements[3] = { e30, e31, e32, e33 };
 	}
 
-	mat4x4(std::array<T, 4> subs0, std::array<T, 4> subs1, std::array<T, 4> subs2, std::array<T, 4> subs3,
-		bool is_input_row_major = true/*or column major?*/)
+	constexpr mat4x4(std::array<T, 4> subs0, std::array<T, 4> subs1, std::array<T, 4> subs2, std::array<T, 4> subs3,
+		bool is_input_row_major = true/*or column major?*/) : elements()
 	{
 		if (is_input_row_major)
 		{
@@ -285,46 +308,81 @@ public:
 		return ptr;
 	}
 
-	T& operator()(size_t row_index, size_t col_index)
+	constexpr T* ptr()
+	{
+		return &elements[0][0];
+	}
+
+	constexpr const T* ptr() const
+	{
+		return &elements[0][0];
+	}
+
+	constexpr T& operator()(size_t row_index, size_t col_index)
 	{
-		if (row_index >= 4 || col_index >= 4 || row_index < 0 || col_index < 0) { throw std::out_of_range("mat4x4 index out of range!"); }
+		MATH_CHECK_INDEX(row_index >= 4 || col_index >= 4, "mat4x4 index out of range!");
 		return elements[row_index][col_index];
 	}
 
-	T operator()(size_t row_index, size_t col_index) const
+	constexpr T operator()(size_t row_index, size_t col_index) const
 	{
-		if (row_index >= 4 || col_index >= 4 || row_index < 0 || col_index < 0) { throw std::out_of_range("mat4x4 index out of range!"); }
+		MATH_CHECK_INDEX(row_index >= 4 || col_index >= 4, "mat4x4 index out of range!");
 		return elements[row_index][col_index];
 	}
 
-	std::array<T, 4> row(size_t index) const
+	//Unchecked runtime access, for loops whose indices are known to be in range
+	constexpr T& unchecked(size_t row_index, size_t col_index)
 	{
-		if (index >= 4 || index < 0) { throw std::out_of_range("mat4x4 index out of range!"); }
+		return elements[row_index][col_index];
+	}
+
+	constexpr T unchecked(size_t row_index, size_t col_index) const
+	{
+		return elements[row_index][col_index];
+	}
+
+	template<size_t R, size_t C>
+	constexpr T& get()
+	{
+		static_assert(R < 4 && C < 4, "mat4x4 index out of range!");
+		return elements[R][C];
+	}
+
+	template<size_t R, size_t C>
+	constexpr T get() const
+	{
+		static_assert(R < 4 && C < 4, "mat4x4 index out of range!");
+		return elements[R][C];
+	}
+
+	constexpr std::array<T, 4> row(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= 4, "mat4x4 index out of range!");
 		return elements[index];
 	}
 
-	std::array<T, 4> col(size_t index) const
+	constexpr std::array<T, 4> col(size_t index) const
 	{
-		if (index >= 4 || index < 0) { throw std::out_of_range("mat4x4 index out of range!"); }
+		MATH_CHECK_INDEX(index >= 4, "mat4x4 index out of range!");
 		return { elements[0][index], elements[1][index], elements[2][index], elements[3][index] };
 	}
 
-	void set_row(size_t index, std::array<T, 4> rows)
+	constexpr void set_row(size_t index, std::array<T, 4> rows)
 	{
-		if (index >= 4 || index < 0) { throw std::out_of_range("mat4x4 index out of range!"); }
+		MATH_CHECK_INDEX(index >= 4, "mat4x4 index out of range!");
 		elements[index] = rows;
 	}
 
-	void set_col(size_t index, std::array<T, 4> cols)
+	constexpr void set_col(size_t index, std::array<T, 4> cols)
 	{
-		if (index >= 4 || index < 0) { throw std::out_of_range("mat4x4 index out of range!"); }
-		elements[0][index] = rows[0];
-		elements[1][index] = rows[1];
-		elements[2][index] = rows[2];
-		elements[3][index] = rows[3];
+		MATH_CHECK_INDEX(index >= 4, "mat4x4 index out of range!");
+		elements[0][index] = cols[0];
+		elements[1][index] = cols[1];
+		elements[2][index] = cols[2];
+		elements[3][index] = cols[3];
 	}
 
-	T det() const
+	constexpr T det() const
 	{
 		return
 			elements[0][0] * sub_mat_det(1, 2, 3, 1, 2, 3) -
@@ -333,7 +391,7 @@ public:
 			elements[0][3] * sub_mat_det(1, 2, 3, 0, 1, 2);
 	}
 
-	std::tuple<bool, mat4x4<T>> inverse(T threshold = FLOATING_POINT_THRESHOLD) const
+	constexpr std::tuple<bool, mat4x4<T>> inverse(T threshold = FLOATING_POINT_THRESHOLD) const
 	{
 		T e00 = elements[0][0], e01 = elements[0][1], e02 = elements[0][2], e03 = elements[0][3];
 		T e10 = elements[1][0], e11 = elements[1][1], e12 = elements[1][2], e13 = elements[1][3];
@@ -405,21 +463,21 @@ public:
 		return { true, inversed };
 	}
 
-	mat4x4<T> transpose() const
+	constexpr mat4x4<T> transpose() const
 	{
 		mat4x4<T> ret;
 		for (size_t row = 0; row < 4; row++)
 		{
 			for (size_t col = 0; col < 4; col++)
 			{
-				ret(row, col) = elements(col, row);
+				ret.unchecked(row, col) = elements[col][row];
 			}
 		}
 		return ret;
 	}
 
 private:
-	T sub_mat_det(size_t row0, const size_t row1, const size_t row2, size_t col0, const size_t col1, const size_t col2) const
+	constexpr T sub_mat_det(size_t row0, const size_t row1, const size_t row2, size_t col0, const size_t col1, const size_t col2) const
 	{
 		return
 			elements[row0][col0] * (elements[row1][col1] * elements[row2][col2] - elements[row2][col1] * elements[row1][col2]) -
@@ -430,16 +488,16 @@ private:
 };
 
 template<class T>
-mat3x3<T> mat3x3<T>::zero = mat3x3<T>(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+constexpr mat3x3<T> mat3x3<T>::zero = mat3x3<T>(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
 
 template<class T>
-mat3x3<T> mat3x3<T>::identity = mat3x3<T>(1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0);
+constexpr mat3x3<T> mat3x3<T>::identity = mat3x3<T>(1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0);
 
 template<class T>
-mat4x4<T> mat4x4<T>::zero = mat4x4<T>(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+constexpr mat4x4<T> mat4x4<T>::zero = mat4x4<T>(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
 
 template<class T>
-mat4x4<T> mat4x4<T>::identity = mat4x4<T>(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+constexpr mat4x4<T> mat4x4<T>::identity = mat4x4<T>(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0);
 
 template<class T>
 std::unique_ptr<T[]> copy(const mat3x3<T>& mat, bool is_output_row_major = true)
@@ -453,50 +511,74 @@ std::unique_ptr<T[]> copy(const mat4x4<T>& mat, bool is_output_row_major = true)
 	return mat.copy(is_output_row_major);
 }
 
+template<size_t R, size_t C, class T>
+constexpr T& get(mat3x3<T>& mat)
+{
+	return mat.template get<R, C>();
+}
+
+template<size_t R, size_t C, class T>
+constexpr T get(const mat3x3<T>& mat)
+{
+	return mat.template get<R, C>();
+}
+
+template<size_t R, size_t C, class T>
+constexpr T& get(mat4x4<T>& mat)
+{
+	return mat.template get<R, C>();
+}
+
+template<size_t R, size_t C, class T>
+constexpr T get(const mat4x4<T>& mat)
+{
+	return mat.template get<R, C>();
+}
+
 template<class T>
-T det(const mat3x3<T>& mat)
+constexpr T det(const mat3x3<T>& mat)
 {
 	return mat.det();
 }
 
 template<class T>
-T det(const mat4x4<T>& mat)
+constexpr T det(const mat4x4<T>& mat)
 {
 	return mat.det();
 }
 
 template<class T>
-std::tuple<bool, mat3x3<T>> inverse(const mat3x3<T>& mat, T threshold = FLOATING_POINT_THRESHOLD)
+constexpr std::tuple<bool, mat3x3<T>> inverse(const mat3x3<T>& mat, T threshold = FLOATING_POINT_THRESHOLD)
 {
 	return mat.inverse(threshold);
 }
 
 template<class T>
-std::tuple<bool, mat4x4<T>> inverse(const mat3x3<T>& mat, T threshold = FLOATING_POINT_THRESHOLD)
+constexpr std::tuple<bool, mat4x4<T>> inverse(const mat4x4<T>& mat, T threshold = FLOATING_POINT_THRESHOLD)
 {
 	return mat.inverse(threshold);
 }
 
 template<class T>
-mat3x3<T> transpose(const mat3x3<T>& mat)
+constexpr mat3x3<T> transpose(const mat3x3<T>& mat)
 {
 	return mat.transpose();
 }
 
 template<class T>
-mat4x4<T> transpose(const mat4x4<T>& mat)
+constexpr mat4x4<T> transpose(const mat4x4<T>& mat)
 {
 	return mat.transpose();
 }
 
 template<class T>
-inline bool operator==(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr bool operator==(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			if (!equal(mat1(row, col), mat2(row, col)))
+			if (!equal(mat1.unchecked(row, col), mat2.unchecked(row, col)))
 			{
 				return false;
 			}
@@ -506,13 +588,13 @@ inline bool operator==(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
 }
 
 template<class T>
-inline bool operator==(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr bool operator==(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			if (!equal(mat1(row, col), mat2(row, col)))
+			if (!equal(mat1.unchecked(row, col), mat2.unchecked(row, col)))
 			{
 				return false;
 			}
@@ -522,200 +604,200 @@ inline bool operator==(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 }
 
 template<class T>
-inline bool operator!=(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr bool operator!=(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	return !(mat1 == mat2);
 }
 
 template<class T>
-inline bool operator!=(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr bool operator!=(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
 	return !(mat1 == mat2);
 }
 
 template<class T>
-inline mat3x3<T> operator-(const mat3x3<T>& mat)
+constexpr mat3x3<T> operator-(const mat3x3<T>& mat)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = -mat(row, col);
+			ret.unchecked(row, col) = -mat.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator-(const mat4x4<T>& mat)
+constexpr mat4x4<T> operator-(const mat4x4<T>& mat)
 {
 	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = -mat(row, col);
+			ret.unchecked(row, col) = -mat.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat3x3<T> operator+(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr mat3x3<T> operator+(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat1(row, col) + mat2(row, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, col) + mat2.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator+(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr mat4x4<T> operator+(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
-	mat3x3<T> ret;
+	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat1(row, col) + mat2(row, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, col) + mat2.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat3x3<T> operator+(const mat3x3<T>& mat, T t)
+constexpr mat3x3<T> operator+(const mat3x3<T>& mat, T t)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat(row, col) + t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) + t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator+(const mat4x4<T>& mat, T t)
+constexpr mat4x4<T> operator+(const mat4x4<T>& mat, T t)
 {
-	mat3x3<T> ret;
+	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat(row, col) + t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) + t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat3x3<T> operator+(T t, const mat3x3<T>& mat)
+constexpr mat3x3<T> operator+(T t, const mat3x3<T>& mat)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat(row, col) + t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) + t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator+(T t, const mat4x4<T>& mat)
+constexpr mat4x4<T> operator+(T t, const mat4x4<T>& mat)
 {
-	mat3x3<T> ret;
+	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat(row, col) + t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) + t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline void operator+=(mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr void operator+=(mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			mat1(row, col) += mat2(row, col);
+			mat1.unchecked(row, col) += mat2.unchecked(row, col);
 		}
 	}
 }
 
 template<class T>
-inline void operator+=(mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr void operator+=(mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			mat1(row, col) += mat2(row, col);
+			mat1.unchecked(row, col) += mat2.unchecked(row, col);
 		}
 	}
 }
 
 template<class T>
-inline void operator+=(mat3x3<T>& mat, T t)
+constexpr void operator+=(mat3x3<T>& mat, T t)
 {
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			mat(row, col) += t;
+			mat.unchecked(row, col) += t;
 		}
 	}
 }
 
 template<class T>
-inline void operator+=(mat4x4<T>& mat, T t)
+constexpr void operator+=(mat4x4<T>& mat, T t)
 {
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			mat(row, col) += t;
+			mat.unchecked(row, col) += t;
 		}
 	}
 }
 
 template<class T>
-inline mat3x3<T> operator-(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr mat3x3<T> operator-(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat1(row, col) - mat2(row, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, col) - mat2.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator-(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr mat4x4<T> operator-(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
-	mat3x3<T> ret;
+	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat1(row, col) - mat2(row, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, col) - mat2.unchecked(row, col);
 		}
 	}
 	return ret;
@@ -723,288 +805,288 @@ inline mat4x4<T> operator-(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 
 
 template<class T>
-inline mat3x3<T> operator-(const mat3x3<T>& mat, T t)
+constexpr mat3x3<T> operator-(const mat3x3<T>& mat, T t)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat(row, col) - t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) - t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator-(const mat4x4<T>& mat, T t)
+constexpr mat4x4<T> operator-(const mat4x4<T>& mat, T t)
 {
-	mat3x3<T> ret;
+	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat(row, col) - t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) - t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat3x3<T> operator-(T t, const mat3x3<T>& mat)
+constexpr mat3x3<T> operator-(T t, const mat3x3<T>& mat)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat(row, col) - t;
+			ret.unchecked(row, col) = t - mat.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator-(T t, const mat4x4<T>& mat)
+constexpr mat4x4<T> operator-(T t, const mat4x4<T>& mat)
 {
-	mat3x3<T> ret;
+	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat(row, col) - t;
+			ret.unchecked(row, col) = t - mat.unchecked(row, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline void operator-=(mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr void operator-=(mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			mat1(row, col) -= mat2(row, col);
+			mat1.unchecked(row, col) -= mat2.unchecked(row, col);
 		}
 	}
 }
 
 template<class T>
-inline void operator-=(mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr void operator-=(mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			mat1(row, col) -= mat2(row, col);
+			mat1.unchecked(row, col) -= mat2.unchecked(row, col);
 		}
 	}
 }
 
 template<class T>
-inline void operator-=(mat3x3<T>& mat, T t)
+constexpr void operator-=(mat3x3<T>& mat, T t)
 {
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			mat(row, col) -= t;
+			mat.unchecked(row, col) -= t;
 		}
 	}
 }
 
 template<class T>
-inline void operator-=(mat4x4<T>& mat, T t)
+constexpr void operator-=(mat4x4<T>& mat, T t)
 {
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			mat(row, col) -= t;
+			mat.unchecked(row, col) -= t;
 		}
 	}
 }
 
 template<class T>
-inline mat3x3<T> operator*(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr mat3x3<T> operator*(const mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat1(row, 0) * mat2(0, col) + mat1(row, 1) * mat2(1, col) + mat1(row, 2) * mat2(2, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, 0) * mat2.unchecked(0, col) + mat1.unchecked(row, 1) * mat2.unchecked(1, col) + mat1.unchecked(row, 2) * mat2.unchecked(2, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator*(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr mat4x4<T> operator*(const mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
 	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat1(row, 0) * mat2(0, col) + mat1(row, 1) * mat2(1, col) + mat1(row, 2) * mat2(2, col) + mat1(row, 3) * mat2(3, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, 0) * mat2.unchecked(0, col) + mat1.unchecked(row, 1) * mat2.unchecked(1, col) + mat1.unchecked(row, 2) * mat2.unchecked(2, col) + mat1.unchecked(row, 3) * mat2.unchecked(3, col);
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat3x3<T> operator*(const mat3x3<T>& mat, T t)
+constexpr mat3x3<T> operator*(const mat3x3<T>& mat, T t)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat(row, col) * t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) * t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator*(const mat4x4<T>& mat, T t)
+constexpr mat4x4<T> operator*(const mat4x4<T>& mat, T t)
 {
 	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat(row, col) * t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) * t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat3x3<T> operator*(T t, const mat3x3<T>& mat)
+constexpr mat3x3<T> operator*(T t, const mat3x3<T>& mat)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat(row, col) * t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) * t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline mat4x4<T> operator*(T t, const mat4x4<T>& mat)
+constexpr mat4x4<T> operator*(T t, const mat4x4<T>& mat)
 {
 	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat(row, col) * t;
+			ret.unchecked(row, col) = mat.unchecked(row, col) * t;
 		}
 	}
 	return ret;
 }
 
 template<class T>
-inline void operator*=(mat3x3<T>& mat1, const mat3x3<T>& mat2)
+constexpr void operator*=(mat3x3<T>& mat1, const mat3x3<T>& mat2)
 {
 	mat3x3<T> ret;
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			ret(row, col) = mat1(row, 0) * mat2(0, col) + mat1(row, 1) * mat2(1, col) + mat1(row, 2) * mat2(2, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, 0) * mat2.unchecked(0, col) + mat1.unchecked(row, 1) * mat2.unchecked(1, col) + mat1.unchecked(row, 2) * mat2.unchecked(2, col);
 		}
 	}
 	mat1 = ret;
 }
 
 template<class T>
-inline void operator*=(mat4x4<T>& mat1, const mat4x4<T>& mat2)
+constexpr void operator*=(mat4x4<T>& mat1, const mat4x4<T>& mat2)
 {
 	mat4x4<T> ret;
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			ret(row, col) = mat1(row, 0) * mat2(0, col) + mat1(row, 1) * mat2(1, col) + mat1(row, 2) * mat2(2, col) + mat1(row, 3) * mat2(3, col);
+			ret.unchecked(row, col) = mat1.unchecked(row, 0) * mat2.unchecked(0, col) + mat1.unchecked(row, 1) * mat2.unchecked(1, col) + mat1.unchecked(row, 2) * mat2.unchecked(2, col) + mat1.unchecked(row, 3) * mat2.unchecked(3, col);
 		}
 	}
 	mat1 = ret;
 }
 
 template<class T>
-inline void operator*=(mat3x3<T>& mat, T t)
+constexpr void operator*=(mat3x3<T>& mat, T t)
 {
 	for (size_t row = 0; row < 3; row++)
 	{
 		for (size_t col = 0; col < 3; col++)
 		{
-			mat(row, col) *= t;
+			mat.unchecked(row, col) *= t;
 		}
 	}
 }
 
 template<class T>
-inline void operator*=(mat4x4<T>& mat, T t)
+constexpr void operator*=(mat4x4<T>& mat, T t)
 {
 	for (size_t row = 0; row < 4; row++)
 	{
 		for (size_t col = 0; col < 4; col++)
 		{
-			mat(row, col) *= t;
+			mat.unchecked(row, col) *= t;
 		}
 	}
 }
 
 template<class T>
-inline mat4x4<T> translate(T x, T y, T z, bool is_row_vector = true)
+constexpr mat4x4<T> translate(T x, T y, T z, bool is_row_vector = true)
 {
 	mat4x4<T> mat = mat4x4<T>::identity;
 	if (is_row_vector)
 	{
-		mat(3, 0) = x; mat(3, 1) = y; mat(3, 2) = z;
+		mat.unchecked(3, 0) = x; mat.unchecked(3, 1) = y; mat.unchecked(3, 2) = z;
 	}
 	else
 	{
-		mat(0, 3) = x; mat(1, 3) = y; mat(2, 3) = z;
+		mat.unchecked(0, 3) = x; mat.unchecked(1, 3) = y; mat.unchecked(2, 3) = z;
 	}
 	return mat;
 }
 
 template<class T>
-inline mat4x4<T> translate(vec3<T> vec, bool is_row_vector = true)
+constexpr mat4x4<T> translate(vec3<T> vec, bool is_row_vector = true)
 {
 	mat4x4<T> mat = mat4x4<T>::identity;
 	if (is_row_vector)
 	{
-		mat(3, 0) = vec.x; mat(3, 1) = vec.y; mat(3, 2) = vec.z;
+		mat.unchecked(3, 0) = vec.x; mat.unchecked(3, 1) = vec.y; mat.unchecked(3, 2) = vec.z;
 	}
 	else
 	{
-		mat(0, 3) = vec.x; mat(1, 3) = vec.y; mat(2, 3) = vec.z;
+		mat.unchecked(0, 3) = vec.x; mat.unchecked(1, 3) = vec.y; mat.unchecked(2, 3) = vec.z;
 	}
 	return mat;
 }
 
 template<class T>
-inline mat4x4<T> scale(T x, T y, T z)
+constexpr mat4x4<T> scale(T x, T y, T z)
 {
 	mat4x4<T> mat = mat4x4<T>::identity;
-	mat(0, 0) = x; mat(1, 1) = y; mat(2, 2) = z;
+	mat.unchecked(0, 0) = x; mat.unchecked(1, 1) = y; mat.unchecked(2, 2) = z;
 	return mat;
 }
 
 template<class T>
-inline mat4x4<T> scale(vec3<T> vec)
+constexpr mat4x4<T> scale(vec3<T> vec)
 {
 	mat4x4<T> mat = mat4x4<T>::identity;
-	mat(0, 0) = vec.x; mat(1, 1) = vec.y; mat(2, 2) = vec.z;
+	mat.unchecked(0, 0) = vec.x; mat.unchecked(1, 1) = vec.y; mat.unchecked(2, 2) = vec.z;
 	return mat;
 }
 
@@ -1029,70 +1111,157 @@ inline mat4x4<T> rotate(T radian, vec3<T> axis, bool is_row_vector = true)
 	mat4x4<T> mat = mat4x4<T>::identity;
 	if (is_row_vector)
 	{
-		mat(0, 0) = 1 - 2 * (y2 + z2);
-		mat(0, 1) = 2 * (xy - zw);
-		mat(0, 2) = 2 * (xz + yw);
-		mat(0, 3) = 0.0f;
+		mat.unchecked(0, 0) = 1 - 2 * (y2 + z2);
+		mat.unchecked(0, 1) = 2 * (xy - zw);
+		mat.unchecked(0, 2) = 2 * (xz + yw);
+		mat.unchecked(0, 3) = 0.0f;
 
-		mat(1, 0) = 2 * (xy + zw);
-		mat(1, 1) = 1 - 2 * (x2 + z2);
-		mat(1, 2) = 2 * (yz - xw);
-		mat(1, 3) = 0.0f;
+		mat.unchecked(1, 0) = 2 * (xy + zw);
+		mat.unchecked(1, 1) = 1 - 2 * (x2 + z2);
+		mat.unchecked(1, 2) = 2 * (yz - xw);
+		mat.unchecked(1, 3) = 0.0f;
 
-		mat(2, 0) = 2 * (xz - yw);
-		mat(2, 1) = 2 * (yz + xw);
-		mat(2, 2) = 1 - 2 * (x2 + y2);
-		mat(2, 3) = 0.0f;
+		mat.unchecked(2, 0) = 2 * (xz - yw);
+		mat.unchecked(2, 1) = 2 * (yz + xw);
+		mat.unchecked(2, 2) = 1 - 2 * (x2 + y2);
+		mat.unchecked(2, 3) = 0.0f;
 
-		mat(3, 0) = 0.0f;
-		mat(3, 1) = 0.0f;
-		mat(3, 2) = 0.0f;
-		mat(3, 3) = 1.0f;
+		mat.unchecked(3, 0) = 0.0f;
+		mat.unchecked(3, 1) = 0.0f;
+		mat.unchecked(3, 2) = 0.0f;
+		mat.unchecked(3, 3) = 1.0f;
 	}
 	else
 	{
-		mat(0, 0) = 1 - 2 * (y2 + z2);
-		mat(1, 0) = 2 * (xy - zw);
-		mat(2, 0) = 2 * (xz + yw);
-		mat(3, 0) = 0.0f;
+		mat.unchecked(0, 0) = 1 - 2 * (y2 + z2);
+		mat.unchecked(1, 0) = 2 * (xy - zw);
+		mat.unchecked(2, 0) = 2 * (xz + yw);
+		mat.unchecked(3, 0) = 0.0f;
 
-		mat(0, 1) = 2 * (xy + zw);
-		mat(1, 1) = 1 - 2 * (x2 + z2);
-		mat(2, 1) = 2 * (yz - xw);
-		mat(3, 1) = 0.0f;
+		mat.unchecked(0, 1) = 2 * (xy + zw);
+		mat.unchecked(1, 1) = 1 - 2 * (x2 + z2);
+		mat.unchecked(2, 1) = 2 * (yz - xw);
+		mat.unchecked(3, 1) = 0.0f;
 
-		mat(0, 2) = 2 * (xz - yw);
-		mat(1, 2) = 2 * (yz + xw);
-		mat(2, 2) = 1 - 2 * (x2 + y2);
-		mat(3, 2) = 0.0f;
+		mat.unchecked(0, 2) = 2 * (xz - yw);
+		mat.unchecked(1, 2) = 2 * (yz + xw);
+		mat.unchecked(2, 2) = 1 - 2 * (x2 + y2);
+		mat.unchecked(3, 2) = 0.0f;
 
-		mat(0, 3) = 0.0f;
-		mat(1, 3) = 0.0f;
-		mat(2, 3) = 0.0f;
-		mat(3, 3) = 1.0f;
+		mat.unchecked(0, 3) = 0.0f;
+		mat.unchecked(1, 3) = 0.0f;
+		mat.unchecked(2, 3) = 0.0f;
+		mat.unchecked(3, 3) = 1.0f;
 	}
 	return mat;
 }
 
 template<class T>
-inline vec4<T> transform(vec4<T> vec, const mat4x4<T> mat, bool is_row_vector = true)
+constexpr vec4<T> transform(vec4<T> vec, const mat4x4<T>& mat, bool is_row_vector = true)
 {
 	vec4<T> ret;
 	if (is_row_vector)
 	{
-		ret.x = vec.x * mat(0, 0) + vec.y * mat(1, 0) + vec.z * mat(2, 0) + vec.w(3, 0);
-		ret.y = vec.x * mat(0, 1) + vec.y * mat(1, 1) + vec.z * mat(2, 1) + vec.w(3, 1);
-		ret.z = vec.x * mat(0, 2) + vec.y * mat(1, 2) + vec.z * mat(2, 2) + vec.w(3, 2);
-		ret.w = vec.x * mat(0, 3) + vec.y * mat(1, 3) + vec.z * mat(2, 3) + vec.w(3, 3);
+		ret.x = vec.x * mat.unchecked(0, 0) + vec.y * mat.unchecked(1, 0) + vec.z * mat.unchecked(2, 0) + vec.w * mat.unchecked(3, 0);
+		ret.y = vec.x * mat.unchecked(0, 1) + vec.y * mat.unchecked(1, 1) + vec.z * mat.unchecked(2, 1) + vec.w * mat.unchecked(3, 1);
+		ret.z = vec.x * mat.unchecked(0, 2) + vec.y * mat.unchecked(1, 2) + vec.z * mat.unchecked(2, 2) + vec.w * mat.unchecked(3, 2);
+		ret.w = vec.x * mat.unchecked(0, 3) + vec.y * mat.unchecked(1, 3) + vec.z * mat.unchecked(2, 3) + vec.w * mat.unchecked(3, 3);
 	}
 	else
 	{
-		ret.x = mat(0, 0) * vec.x + mat(0, 1)*vec.y + mat(0, 2)*vec.z + mat(0, 3)*vec.w;
-		ret.y = mat(1, 0) * vec.x + mat(1, 1)*vec.y + mat(1, 2)*vec.z + mat(1, 3)*vec.w;
-		ret.z = mat(2, 0) * vec.x + mat(2, 1)*vec.y + mat(2, 2)*vec.z + mat(2, 3)*vec.w;
-		ret.w = mat(3, 0) * vec.x + mat(3, 1)*vec.y + mat(3, 2)*vec.z + mat(3, 3)*vec.w;
+		ret.x = mat.unchecked(0, 0) * vec.x + mat.unchecked(0, 1)*vec.y + mat.unchecked(0, 2)*vec.z + mat.unchecked(0, 3)*vec.w;
+		ret.y = mat.unchecked(1, 0) * vec.x + mat.unchecked(1, 1)*vec.y + mat.unchecked(1, 2)*vec.z + mat.unchecked(1, 3)*vec.w;
+		ret.z = mat.unchecked(2, 0) * vec.x + mat.unchecked(2, 1)*vec.y + mat.unchecked(2, 2)*vec.z + mat.unchecked(2, 3)*vec.w;
+		ret.w = mat.unchecked(3, 0) * vec.x + mat.unchecked(3, 1)*vec.y + mat.unchecked(3, 2)*vec.z + mat.unchecked(3, 3)*vec.w;
 	}
 	return ret;
 }
 
+#ifdef MATH_SSE2
+
+/*
+	mat4x4<float> specializations
+	- each row is one __m128, a product is 16 multiply-adds over 4 rows
+	- constant evaluation takes the scalar branch, intrinsics are not constexpr
+*/
+template<>
+constexpr mat4x4<float> operator*(const mat4x4<float>& mat1, const mat4x4<float>& mat2)
+{
+	static_assert(sizeof(mat4x4<float>) == 16 * sizeof(float), "mat4x4<float> must be tightly packed!");
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		mat4x4<float> ret;
+		for (size_t row = 0; row < 4; row++)
+		{
+			for (size_t col = 0; col < 4; col++)
+			{
+				ret.unchecked(row, col) = mat1.unchecked(row, 0) * mat2.unchecked(0, col) + mat1.unchecked(row, 1) * mat2.unchecked(1, col) + mat1.unchecked(row, 2) * mat2.unchecked(2, col) + mat1.unchecked(row, 3) * mat2.unchecked(3, col);
+			}
+		}
+		return ret;
+	}
+	const float* a = mat1.ptr();
+	const float* b = mat2.ptr();
+	__m128 b0 = _mm_loadu_ps(b);
+	__m128 b1 = _mm_loadu_ps(b + 4);
+	__m128 b2 = _mm_loadu_ps(b + 8);
+	__m128 b3 = _mm_loadu_ps(b + 12);
+
+	mat4x4<float> ret;
+	float* r = ret.ptr();
+	for (size_t row = 0; row < 4; row++)
+	{
+		__m128 a_row = _mm_loadu_ps(a + row * 4);
+		__m128 sum = _mm_mul_ps(simd_splat_ps<0>(a_row), b0);
+		sum = simd_madd_ps(simd_splat_ps<1>(a_row), b1, sum);
+		sum = simd_madd_ps(simd_splat_ps<2>(a_row), b2, sum);
+		sum = simd_madd_ps(simd_splat_ps<3>(a_row), b3, sum);
+		_mm_storeu_ps(r + row * 4, sum);
+	}
+	return ret;
+}
+
+template<>
+constexpr void operator*=(mat4x4<float>& mat1, const mat4x4<float>& mat2)
+{
+	mat1 = mat1 * mat2;
+}
+
+template<>
+constexpr vec4<float> transform(vec4<float> vec, const mat4x4<float>& mat, bool is_row_vector)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		vec4<float> ret;
+		for (size_t i = 0; i < 4; i++)
+		{
+			ret[i] = is_row_vector ?
+				vec.x * mat.unchecked(0, i) + vec.y * mat.unchecked(1, i) + vec.z * mat.unchecked(2, i) + vec.w * mat.unchecked(3, i) :
+				mat.unchecked(i, 0) * vec.x + mat.unchecked(i, 1) * vec.y + mat.unchecked(i, 2) * vec.z + mat.unchecked(i, 3) * vec.w;
+		}
+		return ret;
+	}
+	const float* m = mat.ptr();
+	__m128 r0 = _mm_loadu_ps(m);
+	__m128 r1 = _mm_loadu_ps(m + 4);
+	__m128 r2 = _mm_loadu_ps(m + 8);
+	__m128 r3 = _mm_loadu_ps(m + 12);
+	if (!is_row_vector)
+	{
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	}
+
+	__m128 v = _mm_loadu_ps(&vec.x);
+	__m128 sum = _mm_mul_ps(simd_splat_ps<0>(v), r0);
+	sum = simd_madd_ps(simd_splat_ps<1>(v), r1, sum);
+	sum = simd_madd_ps(simd_splat_ps<2>(v), r2, sum);
+	sum = simd_madd_ps(simd_splat_ps<3>(v), r3, sum);
+
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, sum);
+	return ret;
+}
+
+#endif // MATH_SSE2
+
 #endif // !__MATRIX__
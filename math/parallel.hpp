@@ -0,0 +1,429 @@
+#pragma once
+
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//Elements of the smallest chunk of the array entry points, define before including to tune it for a whole build
+#ifndef PARALLEL_GRAIN
+#define PARALLEL_GRAIN 16384
+#endif
+
+//Matrices of the smallest chunk of the matrix entry points, a multiple of 64 so that chunks never share a mask word
+#ifndef PARALLEL_MATRIX_GRAIN
+#define PARALLEL_MATRIX_GRAIN 4096
+#endif
+static_assert(PARALLEL_MATRIX_GRAIN % 64 == 0 && PARALLEL_MATRIX_GRAIN > 0, "PARALLEL_MATRIX_GRAIN must be a positive multiple of 64!");
+
+/*
+	execution_policy / execution
+	- execution::seq runs a batch call on the calling thread, execution::par and execution::par_unseq split it across
+	  the thread pool, the float kernels are vectorised under every policy
+	- with_grain_scale(n) makes the chunks of every parallel_for n times larger, chunks stay multiples of the grain
+	  of each entry point, which the per-chunk buffers of the entry points rely on
+	- passed as the first argument of a batch entry point, or set for a block of calls (the build and query member
+	  functions of bvh, kdtree, hash_grid and hierarchy included) with execution_scope
+*/
+struct execution_policy
+{
+	bool is_parallel;
+	size_t grain_scale;
+
+	constexpr execution_policy with_grain_scale(size_t scale) const
+	{
+		return execution_policy{ is_parallel, scale > 0 ? scale : 1 };
+	}
+};
+
+struct execution
+{
+	static constexpr execution_policy seq = { false, 1 };
+	static constexpr execution_policy par = { true, 1 };
+	static constexpr execution_policy par_unseq = { true, 1 };
+};
+
+//Policy of the parallel_for calls made on this thread
+inline execution_policy& current_execution_policy()
+{
+	thread_local execution_policy policy = execution::par;
+	return policy;
+}
+
+class execution_scope
+{
+private:
+	execution_policy previous;
+
+public:
+	explicit execution_scope(execution_policy policy) : previous(current_execution_policy())
+	{
+		current_execution_policy() = policy;
+	}
+
+	execution_scope(const execution_scope&) = delete;
+	execution_scope& operator=(const execution_scope&) = delete;
+
+	~execution_scope()
+	{
+		current_execution_policy() = previous;
+	}
+};
+
+//Pins thread to cpu, returns false where affinity is not supported or cpu does not exist
+inline bool set_thread_affinity(std::thread& thread, size_t cpu)
+{
+#if defined(_WIN32)
+	if (cpu >= sizeof(DWORD_PTR) * 8)
+	{
+		return false;
+	}
+	return SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#elif defined(__linux__)
+	if (cpu >= CPU_SETSIZE)
+	{
+		return false;
+	}
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+	(void)thread;
+	(void)cpu;
+	return false;
+#endif
+}
+
+/*
+	thread_pool
+	- threads participants, the thread calling run and threads - 1 workers that sleep between jobs,
+	  0 threads means std::thread::hardware_concurrency()
+	- cpus pins worker i to cpus[(i - 1) % cpus.size()], the calling thread keeps its own affinity
+	- run(count, grain, func) deals the chunks of [0, count) out to the participants in contiguous runs, a participant
+	  that runs out steals the back half of the largest run left, so that uneven chunks still balance
+	- one job at a time: run called from inside a job, or while another thread's job is running, calls func(0, count)
+	  on the calling thread instead of waiting
+*/
+class thread_pool
+{
+private:
+	//Chunks [first, last) left to a participant, first in the high half, so that the owner and thieves agree with one CAS
+	struct alignas(64) queue
+	{
+		std::atomic<uint64_t> range{ 0 };
+	};
+
+	std::vector<std::thread> workers;
+	std::unique_ptr<queue[]> queues;
+	std::mutex submit_mutex;
+	std::mutex mutex;
+	std::condition_variable wake_condition;
+	std::condition_variable done_condition;
+	uint64_t generation = 0;
+	bool is_open = false;
+	bool is_stopping = false;
+	size_t joined = 0;
+	//The running job
+	void (*invoke)(void*, size_t, size_t) = nullptr;
+	void* context = nullptr;
+	size_t job_count = 0;
+	size_t job_grain = 0;
+	std::atomic<size_t> remaining{ 0 };
+
+public:
+	explicit thread_pool(size_t threads = 0, const std::vector<size_t>& cpus = std::vector<size_t>())
+	{
+		if (threads == 0)
+		{
+			threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+		}
+		queues.reset(new queue[threads]);
+		workers.reserve(threads - 1);
+		for (size_t i = 1; i < threads; i++)
+		{
+			workers.emplace_back([this, i]() { work(i); });
+			if (!cpus.empty())
+			{
+				set_thread_affinity(workers.back(), cpus[(i - 1) % cpus.size()]);
+			}
+		}
+	}
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_stopping = true;
+		}
+		wake_condition.notify_all();
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+public:
+	size_t size() const
+	{
+		return workers.size() + 1;
+	}
+
+	template<class F>
+	void run(size_t count, size_t grain, F& func)
+	{
+		if (grain == 0)
+		{
+			grain = 1;
+		}
+		size_t chunks = (count + grain - 1) / grain;
+		//Chunk indices are packed in 32 bits, coarser chunks stay multiples of grain
+		if (chunks > static_cast<size_t>(UINT32_MAX))
+		{
+			grain *= (chunks + UINT32_MAX - 1) / UINT32_MAX;
+			chunks = (count + grain - 1) / grain;
+		}
+		std::unique_lock<std::mutex> submit(submit_mutex, std::defer_lock);
+		if (workers.empty() || chunks <= 1 || is_inside_job() || !submit.try_lock())
+		{
+			if (count > 0)
+			{
+				func(static_cast<size_t>(0), count);
+			}
+			return;
+		}
+
+		size_t used = size() < chunks ? size() : chunks;
+		for (size_t p = 0; p < size(); p++)
+		{
+			size_t first = p < used ? p * chunks / used : 0;
+			size_t last = p < used ? (p + 1) * chunks / used : 0;
+			queues[p].range.store(pack(first, last));
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			invoke = [](void* function, size_t begin, size_t end) { (*static_cast<F*>(function))(begin, end); };
+			context = &func;
+			job_count = count;
+			job_grain = grain;
+			remaining.store(chunks);
+			is_open = true;
+			generation++;
+		}
+		wake_condition.notify_all();
+
+		is_inside_job() = true;
+		participate(0);
+		is_inside_job() = false;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		done_condition.wait(lock, [&]() { return remaining.load() == 0; });
+		is_open = false;
+		done_condition.wait(lock, [&]() { return joined == 0; });
+	}
+
+private:
+	static bool& is_inside_job()
+	{
+		thread_local bool is_inside = false;
+		return is_inside;
+	}
+
+	static uint64_t pack(size_t first, size_t last)
+	{
+		return static_cast<uint64_t>(first) << 32 | static_cast<uint64_t>(last);
+	}
+
+	static size_t left(uint64_t range)
+	{
+		uint32_t first = static_cast<uint32_t>(range >> 32);
+		uint32_t last = static_cast<uint32_t>(range);
+		return first < last ? last - first : 0;
+	}
+
+	void work(size_t index)
+	{
+		is_inside_job() = true;
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;)
+		{
+			wake_condition.wait(lock, [&]() { return is_stopping || generation != seen; });
+			if (is_stopping)
+			{
+				return;
+			}
+			seen = generation;
+			if (!is_open)
+			{
+				continue;
+			}
+			joined++;
+			lock.unlock();
+			participate(index);
+			lock.lock();
+			if (--joined == 0)
+			{
+				done_condition.notify_all();
+			}
+		}
+	}
+
+	void participate(size_t index)
+	{
+		size_t chunk;
+		while (pop(index, chunk) || steal(index, chunk))
+		{
+			size_t begin = chunk * job_grain;
+			size_t end = job_count - begin < job_grain ? job_count : begin + job_grain;
+			invoke(context, begin, end);
+			if (remaining.fetch_sub(1) == 1)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				done_condition.notify_all();
+			}
+		}
+	}
+
+	//The owner takes chunks from the front of its run
+	bool pop(size_t index, size_t& chunk)
+	{
+		uint64_t range = queues[index].range.load();
+		while (left(range) > 0)
+		{
+			size_t first = static_cast<size_t>(range >> 32);
+			if (queues[index].range.compare_exchange_weak(range, pack(first + 1, static_cast<uint32_t>(range))))
+			{
+				chunk = first;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//Thieves take the back half of the largest run, keep its first chunk and make the rest their own run
+	bool steal(size_t index, size_t& chunk)
+	{
+		for (;;)
+		{
+			size_t victim = index;
+			uint64_t victim_range = 0;
+			size_t most = 0;
+			for (size_t p = 0; p < size(); p++)
+			{
+				uint64_t range = queues[p].range.load();
+				if (p != index && left(range) > most)
+				{
+					victim = p;
+					victim_range = range;
+					most = left(range);
+				}
+			}
+			if (most == 0)
+			{
+				return false;
+			}
+			size_t first = static_cast<size_t>(victim_range >> 32);
+			size_t last = static_cast<size_t>(static_cast<uint32_t>(victim_range));
+			size_t middle = first + most / 2;
+			if (queues[victim].range.compare_exchange_strong(victim_range, pack(first, middle)))
+			{
+				chunk = middle;
+				queues[index].range.store(pack(middle + 1, last));
+				return true;
+			}
+		}
+	}
+};
+
+inline std::unique_ptr<thread_pool>& parallel_pool_storage()
+{
+	static std::unique_ptr<thread_pool> pool(new thread_pool());
+	return pool;
+}
+
+//The pool behind parallel_for, created with hardware_concurrency() threads on first use
+inline thread_pool& parallel_pool()
+{
+	return *parallel_pool_storage();
+}
+
+/*
+	set_parallel_threads
+	- replaces the pool behind parallel_for with one of threads participants pinned to cpus, as thread_pool,
+	  1 runs every call on the calling thread
+	- lets the library share the machine with the threads of the application instead of oversubscribing it
+	- not safe while parallel calls are in flight
+*/
+inline void set_parallel_threads(size_t threads, const std::vector<size_t>& cpus = std::vector<size_t>())
+{
+	parallel_pool_storage().reset(new thread_pool(threads, cpus));
+}
+
+inline size_t parallel_threads()
+{
+	return parallel_pool().size();
+}
+
+/*
+	parallel_for
+	- calls func(begin, end) on disjoint chunks of grain * grain_scale elements covering [0, count) on the pool,
+	  grain_scale comes from the policy of the calling thread
+	- runs inline under execution::seq, when there is a single chunk and when called from inside another parallel_for
+	- func must not throw
+*/
+template<class F>
+inline void parallel_for(size_t count, size_t grain, F func)
+{
+	const execution_policy& policy = current_execution_policy();
+	grain = (grain > 0 ? grain : 1) * policy.grain_scale;
+	if (!policy.is_parallel || count <= grain)
+	{
+		if (count > 0)
+		{
+			func(static_cast<size_t>(0), count);
+		}
+		return;
+	}
+	parallel_pool().run(count, grain, func);
+}
+
+/*
+	MATH_EXECUTION_OVERLOAD
+	- declares name(policy, args...) for a batch entry point, it calls name(args...) inside an execution_scope of policy
+	- goes after the last overload of name in its header, overloads of other headers taking vec, mat or view
+	  arguments are found by argument dependent lookup
+*/
+#define MATH_EXECUTION_OVERLOAD(name) \
+	template<class... Args> \
+	inline auto name(execution_policy policy, Args&&... args) -> decltype(name(std::forward<Args>(args)...)) \
+	{ \
+		execution_scope scope(policy); \
+		return name(std::forward<Args>(args)...); \
+	}
+
+#endif // !__PARALLEL__
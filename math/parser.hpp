@@ -0,0 +1,323 @@
+#pragma once
+
+#ifndef __PARSER__
+#define __PARSER__
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+
+#include "soa.hpp"
+#include "parallel.hpp"
+
+//Bytes of text parsed by one task
+#define PARSE_GRAIN 1048576
+//Bytes read from a file per parallel pass
+#define PARSE_BLOCK 67108864
+
+/*
+	parse_target
+	- the containers parse_vecs can fill, with their component type and dimension
+	- store writes record index from D consecutive values, it is called concurrently for distinct indices
+*/
+template<class C>
+struct parse_target;
+
+template<class T>
+struct parse_target<std::vector<vec2<T>>>
+{
+	using value_type = T;
+	static const size_t dimension = 2;
+
+	static void resize(std::vector<vec2<T>>& out, size_t size) { out.resize(size); }
+	static void store(std::vector<vec2<T>>& out, size_t index, const T* v) { out[index] = vec2<T>(v[0], v[1]); }
+};
+
+template<class T>
+struct parse_target<std::vector<vec3<T>>>
+{
+	using value_type = T;
+	static const size_t dimension = 3;
+
+	static void resize(std::vector<vec3<T>>& out, size_t size) { out.resize(size); }
+	static void store(std::vector<vec3<T>>& out, size_t index, const T* v) { out[index] = vec3<T>(v[0], v[1], v[2]); }
+};
+
+template<class T>
+struct parse_target<std::vector<vec4<T>>>
+{
+	using value_type = T;
+	static const size_t dimension = 4;
+
+	static void resize(std::vector<vec4<T>>& out, size_t size) { out.resize(size); }
+	static void store(std::vector<vec4<T>>& out, size_t index, const T* v) { out[index] = vec4<T>(v[0], v[1], v[2], v[3]); }
+};
+
+template<class T>
+struct parse_target<vec3_soa<T>>
+{
+	using value_type = T;
+	static const size_t dimension = 3;
+
+	static void resize(vec3_soa<T>& out, size_t size) { out = vec3_soa<T>(size); }
+	static void store(vec3_soa<T>& out, size_t index, const T* v) { out.x.data()[index] = v[0]; out.y.data()[index] = v[1]; out.z.data()[index] = v[2]; }
+};
+
+template<class T>
+struct parse_target<vec4_soa<T>>
+{
+	using value_type = T;
+	static const size_t dimension = 4;
+
+	static void resize(vec4_soa<T>& out, size_t size) { out = vec4_soa<T>(size); }
+	static void store(vec4_soa<T>& out, size_t index, const T* v) { out.x.data()[index] = v[0]; out.y.data()[index] = v[1]; out.z.data()[index] = v[2]; out.w.data()[index] = v[3]; }
+};
+
+inline bool parse_is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*
+	parse_records
+	- parses the lines of [first, last), each line holds D numbers separated by blanks and/or a comma
+	- blank lines are skipped, '\r' is treated as a blank so CRLF files parse as well
+	- appends the values to out and returns nullptr, or returns the position of the first malformed token
+*/
+template<class T, size_t D>
+inline const char* parse_records(const char* first, const char* last, std::vector<T>& out)
+{
+	const char* p = first;
+	while (p < last)
+	{
+		while (p < last && parse_is_blank(*p))
+		{
+			p++;
+		}
+		if (p == last)
+		{
+			break;
+		}
+		if (*p == '\n')
+		{
+			p++;
+			continue;
+		}
+
+		T values[D];
+		for (size_t d = 0; d < D; d++)
+		{
+			if (d > 0)
+			{
+				const char* token = p;
+				while (p < last && parse_is_blank(*p))
+				{
+					p++;
+				}
+				if (p < last && *p == ',')
+				{
+					p++;
+					while (p < last && parse_is_blank(*p))
+					{
+						p++;
+					}
+				}
+				else if (p == token)
+				{
+					return p;
+				}
+			}
+			//from_chars takes no '+', skip it but do not let it pass a '-' through as well
+			const char* number = p < last && *p == '+' ? p + 1 : p;
+			if (number != p && number < last && *number == '-')
+			{
+				return p;
+			}
+			std::from_chars_result result = std::from_chars(number, last, values[d]);
+			if (result.ec != std::errc())
+			{
+				return p;
+			}
+			p = result.ptr;
+		}
+
+		while (p < last && parse_is_blank(*p))
+		{
+			p++;
+		}
+		if (p < last && *p != '\n')
+		{
+			return p;
+		}
+		out.insert(out.end(), values, values + D);
+	}
+	return nullptr;
+}
+
+//Start of the first line beginning at or after offset
+inline size_t parse_line_start(const char* text, size_t size, size_t offset)
+{
+	if (offset == 0 || offset >= size)
+	{
+		return offset == 0 ? 0 : size;
+	}
+	const void* newline = memchr(text + offset - 1, '\n', size - offset + 1);
+	return newline != nullptr ? static_cast<const char*>(newline) - text + 1 : size;
+}
+
+/*
+	parse_values
+	- parse_records over text split into PARSE_GRAIN sized runs of whole lines, the runs are parsed in parallel
+	- appends the values of every record to out, in order
+	- returns { true, 0 } or { false, offset } where offset is the first error position plus base_offset
+*/
+template<class T, size_t D>
+inline std::tuple<bool, size_t> parse_values(const char* text, size_t size, size_t base_offset, std::vector<T>& out)
+{
+	size_t chunks = (size + PARSE_GRAIN - 1) / PARSE_GRAIN;
+	std::vector<std::vector<T>> values(chunks);
+	std::vector<const char*> errors(chunks, nullptr);
+	parallel_for(chunks, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t chunk = begin; chunk < end; chunk++)
+		{
+			size_t first = parse_line_start(text, size, chunk * PARSE_GRAIN);
+			size_t last = parse_line_start(text, size, (chunk + 1) * PARSE_GRAIN);
+			values[chunk].reserve((last - first) / 4);
+			errors[chunk] = parse_records<T, D>(text + first, text + last, values[chunk]);
+		}
+	});
+
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		if (errors[chunk] != nullptr)
+		{
+			return { false, base_offset + static_cast<size_t>(errors[chunk] - text) };
+		}
+	}
+
+	std::vector<size_t> offsets(chunks + 1, out.size());
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		offsets[chunk + 1] = offsets[chunk] + values[chunk].size();
+	}
+	out.resize(offsets[chunks]);
+	parallel_for(chunks, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t chunk = begin; chunk < end; chunk++)
+		{
+			std::copy(values[chunk].begin(), values[chunk].end(), out.begin() + offsets[chunk]);
+		}
+	});
+	return { true, 0 };
+}
+
+template<class C>
+inline void parse_store(const std::vector<typename parse_target<C>::value_type>& values, C& out)
+{
+	using target = parse_target<C>;
+	size_t count = values.size() / target::dimension;
+	target::resize(out, count);
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			target::store(out, i, values.data() + i * target::dimension);
+		}
+	});
+}
+
+/*
+	parse_vecs
+	- reads one vec2/vec3/vec4 per line from a buffer, a FILE* or a file path into std::vector<vecN<T>>, vec3_soa or vec4_soa
+	- numbers are read with std::from_chars: locale independent, no copies, large inputs are split across threads
+	- files are read in PARSE_BLOCK sized blocks, each block is parsed in parallel, only one block of text is held at
+	  a time but the parsed values of all blocks are kept until they are copied to out, about twice the size of out
+	- returns { true, records } on success, or { false, offset } with the byte offset of the first malformed token,
+	  out is only replaced on success
+	- throws std::runtime_error when a file cannot be opened or read
+*/
+template<class C>
+inline std::tuple<bool, size_t> parse_vecs(const char* text, size_t size, C& out)
+{
+	using T = typename parse_target<C>::value_type;
+	std::vector<T> values;
+	std::tuple<bool, size_t> result = parse_values<T, parse_target<C>::dimension>(text, size, 0, values);
+	if (!std::get<0>(result))
+	{
+		return result;
+	}
+	parse_store(values, out);
+	return { true, values.size() / parse_target<C>::dimension };
+}
+
+template<class C>
+inline std::tuple<bool, size_t> parse_vecs(const std::string& text, C& out)
+{
+	return parse_vecs(text.data(), text.size(), out);
+}
+
+template<class C>
+inline std::tuple<bool, size_t> parse_vecs(FILE* file, C& out)
+{
+	using T = typename parse_target<C>::value_type;
+	std::vector<T> values;
+	std::vector<char> block(PARSE_BLOCK);
+	size_t filled = 0;
+	size_t offset = 0;
+	for (;;)
+	{
+		size_t read = fread(block.data() + filled, 1, block.size() - filled, file);
+		if (ferror(file)) { throw std::runtime_error("failed to read the file!"); }
+		filled += read;
+		bool eof = filled < block.size();
+
+		size_t usable = filled;
+		if (!eof)
+		{
+			while (usable > 0 && block[usable - 1] != '\n')
+			{
+				usable--;
+			}
+			if (usable == 0)
+			{
+				//A single line longer than the block
+				block.resize(block.size() * 2);
+				continue;
+			}
+		}
+
+		std::tuple<bool, size_t> result = parse_values<T, parse_target<C>::dimension>(block.data(), usable, offset, values);
+		if (!std::get<0>(result))
+		{
+			return result;
+		}
+		if (eof)
+		{
+			break;
+		}
+		memmove(block.data(), block.data() + usable, filled - usable);
+		offset += usable;
+		filled -= usable;
+	}
+	parse_store(values, out);
+	return { true, values.size() / parse_target<C>::dimension };
+}
+
+template<class C>
+inline std::tuple<bool, size_t> parse_vecs_file(const std::string& path, C& out)
+{
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file, path.c_str(), "rb") != 0) { file = nullptr; }
+#else
+	file = fopen(path.c_str(), "rb");
+#endif
+	if (file == nullptr) { throw std::runtime_error("failed to open the file!"); }
+	std::unique_ptr<FILE, int(*)(FILE*)> closer(file, fclose);
+	return parse_vecs(file, out);
+}
+
+#endif // !__PARSER__
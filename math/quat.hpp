@@ -0,0 +1,488 @@
+#pragma once
+
+#ifndef __QUAT__
+#define __QUAT__
+
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "dispatch.hpp"
+
+//Above this cosine slerp falls back to nlerp, the arc is too short for sin(theta) to be divided by
+#define QUAT_SLERP_THRESHOLD 0.9995
+
+template<class T>
+class quat;
+
+using quatf = quat<float>;
+using quatd = quat<double>;
+using quatld = quat<long double>;
+
+/*
+	quat
+	- x, y, z is the vector part and w the scalar part, default constructed as identity
+	- a rotation of radian around axis is the same rotation as rotate(radian, axis) in matrix.hpp,
+	  to_mat4x4(quat(radian, axis)) equals rotate(radian, axis) for both conventions
+	- q1 * q2 rotates by q1 first and then by q2, like the row-vector product of their matrices
+*/
+template<class T>
+class quat
+{
+public:
+	T x, y, z, w;
+	static const quat<T> identity;
+
+public:
+	constexpr quat() : x(0.0), y(0.0), z(0.0), w(1.0)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of quat must be a floating-point type!");
+	}
+
+	constexpr quat(T x, T y, T z, T w) : x(x), y(y), z(z), w(w)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of quat must be a floating-point type!");
+	}
+
+	quat(T radian, vec3<T> axis) : quat()
+	{
+		T half_sin = std::sin(radian * static_cast<T>(0.5));
+		axis.normalize();
+		x = axis.x * half_sin;
+		y = axis.y * half_sin;
+		z = axis.z * half_sin;
+		w = std::cos(radian * static_cast<T>(0.5));
+	}
+
+public:
+	constexpr T length() const
+	{
+		return constexpr_sqrt(x * x + y * y + z * z + w * w);
+	}
+
+	constexpr T sqr_length() const
+	{
+		return x * x + y * y + z * z + w * w;
+	}
+
+	constexpr quat<T> normal() const
+	{
+		T length = this->length();
+		return quat<T>(x / length, y / length, z / length, w / length);
+	}
+
+	constexpr void normalize()
+	{
+		T length = this->length();
+		x /= length; y /= length; z /= length; w /= length;
+	}
+
+	constexpr bool is_normal() const
+	{
+		return equal(this->length(), static_cast<T>(1.0));
+	}
+
+	constexpr T dot(const quat<T>& q) const
+	{
+		return x * q.x + y * q.y + z * q.z + w * q.w;
+	}
+
+	constexpr quat<T> conjugate() const
+	{
+		return quat<T>(-x, -y, -z, w);
+	}
+
+	//Equals conjugate() for unit quats
+	constexpr quat<T> inverse() const
+	{
+		T sqr_length_inv = static_cast<T>(1.0) / sqr_length();
+		return quat<T>(-x * sqr_length_inv, -y * sqr_length_inv, -z * sqr_length_inv, w * sqr_length_inv);
+	}
+
+	//The quat must be normalized
+	constexpr vec3<T> rotate(vec3<T> vec) const
+	{
+		T q[4] = { x, y, z, w }, v[3] = { vec.x, vec.y, vec.z }, r[3] = { 0.0, 0.0, 0.0 };
+		kernel_rotate_quat_lanes(q, v, r);
+		return vec3<T>(r[0], r[1], r[2]);
+	}
+
+public:
+	std::string to_string() const
+	{
+		char buffer[256];
+		sprintf_s(buffer, 256, "quat(%.2lf, %.2lf, %.2lf, %.2lf)", x, y, z, w);
+		return std::string(buffer);
+	}
+};
+
+template<class T>
+constexpr quat<T> quat<T>::identity = quat<T>(0.0, 0.0, 0.0, 1.0);
+
+template<class T>
+constexpr quat<T> operator*(const quat<T>& q1, const quat<T>& q2)
+{
+	T a[4] = { q1.x, q1.y, q1.z, q1.w }, b[4] = { q2.x, q2.y, q2.z, q2.w }, r[4] = { 0.0, 0.0, 0.0, 0.0 };
+	kernel_multiply_quat_lanes(a, b, r);
+	return quat<T>(r[0], r[1], r[2], r[3]);
+}
+
+template<class T>
+constexpr void operator*=(quat<T>& q1, const quat<T>& q2)
+{
+	q1 = q1 * q2;
+}
+
+template<class T>
+constexpr quat<T> operator*(const quat<T>& q, T t)
+{
+	return quat<T>(q.x * t, q.y * t, q.z * t, q.w * t);
+}
+
+template<class T>
+constexpr quat<T> operator*(T t, const quat<T>& q)
+{
+	return quat<T>(t * q.x, t * q.y, t * q.z, t * q.w);
+}
+
+template<class T>
+constexpr quat<T> operator+(const quat<T>& q1, const quat<T>& q2)
+{
+	return quat<T>(q1.x + q2.x, q1.y + q2.y, q1.z + q2.z, q1.w + q2.w);
+}
+
+template<class T>
+constexpr quat<T> operator-(const quat<T>& q1, const quat<T>& q2)
+{
+	return quat<T>(q1.x - q2.x, q1.y - q2.y, q1.z - q2.z, q1.w - q2.w);
+}
+
+template<class T>
+constexpr quat<T> operator-(const quat<T>& q)
+{
+	return quat<T>(-q.x, -q.y, -q.z, -q.w);
+}
+
+template<class T>
+constexpr bool operator==(const quat<T>& q1, const quat<T>& q2)
+{
+	return equal(q1.x, q2.x) && equal(q1.y, q2.y) && equal(q1.z, q2.z) && equal(q1.w, q2.w);
+}
+
+template<class T>
+constexpr bool operator!=(const quat<T>& q1, const quat<T>& q2)
+{
+	return !(q1 == q2);
+}
+
+template<class T>
+constexpr T dot(const quat<T>& q1, const quat<T>& q2)
+{
+	return q1.dot(q2);
+}
+
+template<class T>
+constexpr T length(const quat<T>& q)
+{
+	return q.length();
+}
+
+template<class T>
+constexpr quat<T> normal(const quat<T>& q)
+{
+	return q.normal();
+}
+
+template<class T>
+constexpr quat<T> conjugate(const quat<T>& q)
+{
+	return q.conjugate();
+}
+
+template<class T>
+constexpr quat<T> inverse(const quat<T>& q)
+{
+	return q.inverse();
+}
+
+template<class T>
+constexpr vec3<T> rotate(const quat<T>& q, vec3<T> vec)
+{
+	return q.rotate(vec);
+}
+
+//Normalized linear interpolation along the shorter arc, cheaper than slerp but not constant speed
+template<class T>
+constexpr quat<T> nlerp(const quat<T>& q1, const quat<T>& q2, T t)
+{
+	T a[4] = { q1.x, q1.y, q1.z, q1.w }, b[4] = { q2.x, q2.y, q2.z, q2.w }, r[4] = { 0.0, 0.0, 0.0, 0.0 };
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		T sign = q1.dot(q2) < 0 ? static_cast<T>(-1.0) : static_cast<T>(1.0);
+		return normal(q1 + (q2 * sign - q1) * t);
+	}
+	kernel_nlerp_quat_lanes(a, b, t, r);
+	return quat<T>(r[0], r[1], r[2], r[3]);
+}
+
+//Spherical linear interpolation along the shorter arc
+template<class T>
+inline quat<T> slerp(const quat<T>& q1, const quat<T>& q2, T t)
+{
+	T cos_theta = q1.dot(q2);
+	quat<T> target = cos_theta < 0 ? -q2 : q2;
+	cos_theta = abs(cos_theta);
+	if (cos_theta > static_cast<T>(QUAT_SLERP_THRESHOLD))
+	{
+		return nlerp(q1, target, t);
+	}
+	T theta = std::acos(cos_theta);
+	T sin_theta_inv = static_cast<T>(1.0) / std::sin(theta);
+	return q1 * (std::sin((static_cast<T>(1.0) - t) * theta) * sin_theta_inv) + target * (std::sin(t * theta) * sin_theta_inv);
+}
+
+//The quat must be normalized
+template<class T>
+constexpr mat3x3<T> to_mat3x3(const quat<T>& q, bool is_row_vector = true)
+{
+	T e[4] = { q.x, q.y, q.z, q.w }, m[9] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	kernel_rotation_quat_lanes(e, m);
+	mat3x3<T> mat(m, true);
+	return is_row_vector ? mat : mat.transpose();
+}
+
+template<class T>
+constexpr mat4x4<T> to_mat4x4(const quat<T>& q, bool is_row_vector = true)
+{
+	T e[4] = { q.x, q.y, q.z, q.w }, m[9] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	T d[16] = {};
+	kernel_rotation_quat_lanes(e, m);
+	kernel_store_rotation_mat4x4(m, d, is_row_vector);
+	return mat4x4<T>(d, true);
+}
+
+/*
+	to_quat
+	- the rotation of a matrix built by rotate() or to_mat3x3 / to_mat4x4, only the upper 3x3 is read
+	- the matrix must be a pure rotation, scaled or sheared matrices give meaningless results
+*/
+template<class T>
+inline quat<T> to_quat(const mat3x3<T>& mat, bool is_row_vector = true)
+{
+	//r(i, j) reads the row-vector form
+	auto r = [&](size_t row, size_t col) { return is_row_vector ? mat.unchecked(row, col) : mat.unchecked(col, row); };
+	T trace = r(0, 0) + r(1, 1) + r(2, 2);
+	quat<T> q;
+	if (trace > 0)
+	{
+		T s = std::sqrt(trace + static_cast<T>(1.0)) * static_cast<T>(2.0);
+		q = quat<T>((r(2, 1) - r(1, 2)) / s, (r(0, 2) - r(2, 0)) / s, (r(1, 0) - r(0, 1)) / s, s * static_cast<T>(0.25));
+	}
+	else if (r(0, 0) > r(1, 1) && r(0, 0) > r(2, 2))
+	{
+		T s = std::sqrt(static_cast<T>(1.0) + r(0, 0) - r(1, 1) - r(2, 2)) * static_cast<T>(2.0);
+		q = quat<T>(s * static_cast<T>(0.25), (r(0, 1) + r(1, 0)) / s, (r(0, 2) + r(2, 0)) / s, (r(2, 1) - r(1, 2)) / s);
+	}
+	else if (r(1, 1) > r(2, 2))
+	{
+		T s = std::sqrt(static_cast<T>(1.0) + r(1, 1) - r(0, 0) - r(2, 2)) * static_cast<T>(2.0);
+		q = quat<T>((r(0, 1) + r(1, 0)) / s, s * static_cast<T>(0.25), (r(1, 2) + r(2, 1)) / s, (r(0, 2) - r(2, 0)) / s);
+	}
+	else
+	{
+		T s = std::sqrt(static_cast<T>(1.0) + r(2, 2) - r(0, 0) - r(1, 1)) * static_cast<T>(2.0);
+		q = quat<T>((r(0, 2) + r(2, 0)) / s, (r(1, 2) + r(2, 1)) / s, s * static_cast<T>(0.25), (r(1, 0) - r(0, 1)) / s);
+	}
+	return q.normal();
+}
+
+template<class T>
+inline quat<T> to_quat(const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	return to_quat(mat3x3<T>(
+		mat.unchecked(0, 0), mat.unchecked(0, 1), mat.unchecked(0, 2),
+		mat.unchecked(1, 0), mat.unchecked(1, 1), mat.unchecked(1, 2),
+		mat.unchecked(2, 0), mat.unchecked(2, 1), mat.unchecked(2, 2)), is_row_vector);
+}
+
+/*
+	batch quat operations
+	- out[i] = quats1[i] * quats2[i], rotate, normalize, nlerp, slerp and to_mat4x4 over arrays
+	- float arrays run on the dispatched kernels, 4 (SSE) or 8 (AVX2) quats at a time with one quat per lane
+	- t is one factor for every pair or an array of count factors, out may be the same array as an input
+	- slerp needs acos / sin per element and stays scalar
+	- arrays above PARALLEL_GRAIN (PARALLEL_MATRIX_GRAIN for to_mat4x4) are split across threads
+*/
+template<class T>
+inline void batch_multiply(const quat<T>* quats1, const quat<T>* quats2, quat<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = quats1[i] * quats2[i];
+		}
+	});
+}
+
+inline void batch_multiply(const quat<float>* quats1, const quat<float>* quats2, quat<float>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().multiply_quatf(reinterpret_cast<const float*>(quats1 + begin), reinterpret_cast<const float*>(quats2 + begin),
+			reinterpret_cast<float*>(out + begin), end - begin);
+	});
+}
+
+template<class T>
+inline void batch_rotate(const quat<T>* quats, const vec3<T>* vecs, vec3<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = quats[i].rotate(vecs[i]);
+		}
+	});
+}
+
+inline void batch_rotate(const quat<float>* quats, const vec3<float>* vecs, vec3<float>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().rotate_quatf(reinterpret_cast<const float*>(quats + begin), 4, reinterpret_cast<const float*>(vecs + begin),
+			reinterpret_cast<float*>(out + begin), end - begin);
+	});
+}
+
+template<class T>
+inline void batch_rotate(const quat<T>& q, const vec3<T>* vecs, vec3<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = q.rotate(vecs[i]);
+		}
+	});
+}
+
+inline void batch_rotate(const quat<float>& q, const vec3<float>* vecs, vec3<float>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().rotate_quatf(&q.x, 0, reinterpret_cast<const float*>(vecs + begin), reinterpret_cast<float*>(out + begin), end - begin);
+	});
+}
+
+template<class T>
+inline void batch_normalize(quat<T>* quats, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			quats[i].normalize();
+		}
+	});
+}
+
+inline void batch_normalize(quat<float>* quats, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().normalize_quatf(reinterpret_cast<float*>(quats + begin), end - begin);
+	});
+}
+
+template<class T>
+inline void batch_nlerp(const quat<T>* quats1, const quat<T>* quats2, const T* t, quat<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = nlerp(quats1[i], quats2[i], t[i]);
+		}
+	});
+}
+
+inline void batch_nlerp(const quat<float>* quats1, const quat<float>* quats2, const float* t, quat<float>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().nlerp_quatf(reinterpret_cast<const float*>(quats1 + begin), reinterpret_cast<const float*>(quats2 + begin), t + begin, 1,
+			reinterpret_cast<float*>(out + begin), end - begin);
+	});
+}
+
+template<class T>
+inline void batch_nlerp(const quat<T>* quats1, const quat<T>* quats2, T t, quat<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = nlerp(quats1[i], quats2[i], t);
+		}
+	});
+}
+
+inline void batch_nlerp(const quat<float>* quats1, const quat<float>* quats2, float t, quat<float>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().nlerp_quatf(reinterpret_cast<const float*>(quats1 + begin), reinterpret_cast<const float*>(quats2 + begin), &t, 0,
+			reinterpret_cast<float*>(out + begin), end - begin);
+	});
+}
+
+template<class T>
+inline void batch_slerp(const quat<T>* quats1, const quat<T>* quats2, const T* t, quat<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = slerp(quats1[i], quats2[i], t[i]);
+		}
+	});
+}
+
+template<class T>
+inline void batch_slerp(const quat<T>* quats1, const quat<T>* quats2, T t, quat<T>* out, size_t count)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = slerp(quats1[i], quats2[i], t);
+		}
+	});
+}
+
+template<class T>
+inline void batch_to_mat4x4(const quat<T>* quats, mat4x4<T>* out, size_t count, bool is_row_vector = true)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = to_mat4x4(quats[i], is_row_vector);
+		}
+	});
+}
+
+inline void batch_to_mat4x4(const quat<float>* quats, mat4x4<float>* out, size_t count, bool is_row_vector = true)
+{
+	parallel_for(count, PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().to_mat4x4_quatf(reinterpret_cast<const float*>(quats + begin), reinterpret_cast<float*>(out + begin), end - begin, is_row_vector);
+	});
+}
+
+//Also covers the angle-axis batch_rotate of elementary.hpp
+MATH_EXECUTION_OVERLOAD(batch_rotate)
+MATH_EXECUTION_OVERLOAD(batch_nlerp)
+MATH_EXECUTION_OVERLOAD(batch_slerp)
+MATH_EXECUTION_OVERLOAD(batch_to_mat4x4)
+
+#endif // !__QUAT__
@@ -0,0 +1,286 @@
+#pragma once
+
+#ifndef __RAY__
+#define __RAY__
+
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "soa.hpp"
+#include "bvh.hpp"
+
+//Primitive of a ray_hit that hit nothing
+#define RAY_NO_HIT static_cast<size_t>(-1)
+//Rays a packet intersection runs against all triangles before moving on, so that they stay in cache
+#define RAY_PACKET_CHUNK 256
+
+template<class T>
+class ray_hit;
+
+template<class T>
+class ray_hit_soa;
+
+template<class T>
+class triangle_soa;
+
+using ray_hitf = ray_hit<float>;
+using ray_hitd = ray_hit<double>;
+using ray_hitld = ray_hit<long double>;
+
+using ray_hit_soaf = ray_hit_soa<float>;
+using ray_hit_soad = ray_hit_soa<double>;
+using ray_hit_soald = ray_hit_soa<long double>;
+
+using triangle_soaf = triangle_soa<float>;
+using triangle_soad = triangle_soa<double>;
+using triangle_soald = triangle_soa<long double>;
+
+/*
+	ray_hit / ray_hit_soa
+	- the hit point is origin + distance * direction = v0 + u * (v1 - v0) + v * (v2 - v0) of triangle primitive
+	- start with distance = t_max and primitive = RAY_NO_HIT, the intersections only replace them with closer hits
+*/
+template<class T>
+class ray_hit
+{
+public:
+	T distance, u, v;
+	size_t primitive;
+
+public:
+	explicit ray_hit(T t_max = std::numeric_limits<T>::infinity()) : distance(t_max), u(0.0), v(0.0), primitive(RAY_NO_HIT)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of ray_hit must be a floating-point type!");
+	}
+
+public:
+	bool is_hit() const
+	{
+		return primitive != RAY_NO_HIT;
+	}
+};
+
+template<class T>
+class ray_hit_soa
+{
+public:
+	soa_array<T> distance, u, v;
+	std::vector<size_t> primitive;
+
+public:
+	explicit ray_hit_soa(size_t size, T t_max = std::numeric_limits<T>::infinity()) : distance(size, t_max), u(size), v(size), primitive(size, RAY_NO_HIT)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of ray_hit_soa must be a floating-point type!");
+	}
+
+public:
+	size_t size() const
+	{
+		return primitive.size();
+	}
+
+	ray_hit<T> operator[](size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= size(), "ray_hit_soa index out of range!");
+		ray_hit<T> hit(distance[index]);
+		hit.u = u[index]; hit.v = v[index]; hit.primitive = primitive[index];
+		return hit;
+	}
+};
+
+/*
+	triangle_soa
+	- triangles stored for the intersection kernels: first vertex v0 and edges e1 = v1 - v0, e2 = v2 - v0 as SoA arrays,
+	  primitives[i] is the id reported for triangle i
+	- triangles are 3 indices per triangle into vertices, or nullptr for a triangle soup, as in bvh
+	- the bvh constructor stores the triangles in the leaf order of the tree, so that a leaf is one contiguous range,
+	  intersect(tree, triangles, ...) needs this order
+	- update() reloads the positions after the vertices moved, refit the bvh along with it
+*/
+template<class T>
+class triangle_soa
+{
+public:
+	vec3_soa<T> v0, e1, e2;
+	std::vector<size_t> primitives;
+
+public:
+	triangle_soa()
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of triangle_soa must be a floating-point type!");
+	}
+
+	triangle_soa(const vec3<T>* vertices, const size_t* triangles, size_t count) : v0(count), e1(count), e2(count), primitives(count)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of triangle_soa must be a floating-point type!");
+		for (size_t i = 0; i < count; i++)
+		{
+			primitives[i] = i;
+		}
+		update(vertices, triangles);
+	}
+
+	triangle_soa(const vec3<T>* vertices, const size_t* triangles, const bvh<T>& tree) :
+		v0(tree.primitive_count()), e1(tree.primitive_count()), e2(tree.primitive_count()), primitives(tree.primitive_count())
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of triangle_soa must be a floating-point type!");
+		for (size_t i = 0; i < primitives.size(); i++)
+		{
+			primitives[i] = tree.primitive(i);
+		}
+		update(vertices, triangles);
+	}
+
+public:
+	size_t size() const
+	{
+		return primitives.size();
+	}
+
+	void update(const vec3<T>* vertices, const size_t* triangles)
+	{
+		parallel_for(size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				size_t first = primitives[i] * 3;
+				vec3<T> p0 = vertices[triangles != nullptr ? triangles[first] : first];
+				vec3<T> p1 = vertices[triangles != nullptr ? triangles[first + 1] : first + 1];
+				vec3<T> p2 = vertices[triangles != nullptr ? triangles[first + 2] : first + 2];
+				v0.x[i] = p0.x; v0.y[i] = p0.y; v0.z[i] = p0.z;
+				e1.x[i] = p1.x - p0.x; e1.y[i] = p1.y - p0.y; e1.z[i] = p1.z - p0.z;
+				e2.x[i] = p2.x - p0.x; e2.y[i] = p2.y - p0.y; e2.z[i] = p2.z - p0.z;
+			}
+		});
+	}
+
+	//The 9 component arrays of the intersection kernels
+	void components(const T** out) const
+	{
+		const vec3_soa<T>* parts[] = { &v0, &e1, &e2 };
+		for (size_t k = 0; k < 3; k++)
+		{
+			out[k * 3] = parts[k]->x.data(); out[k * 3 + 1] = parts[k]->y.data(); out[k * 3 + 2] = parts[k]->z.data();
+		}
+	}
+};
+
+/*
+	intersect_triangle
+	- Moller-Trumbore test of origin + t * direction against the triangle v0, v1, v2 for t_min < t < t_max
+	- returns whether it hits and the distance t and barycentrics u, v of the hit
+*/
+template<class T>
+inline std::tuple<bool, T, T, T> intersect_triangle(vec3<T> origin, vec3<T> direction, vec3<T> v0, vec3<T> v1, vec3<T> v2,
+	T t_min = 0, T t_max = std::numeric_limits<T>::infinity())
+{
+	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
+	T ray[] = { origin.x, origin.y, origin.z, direction.x, direction.y, direction.z };
+	T triangle[] = { v0.x, v0.y, v0.z, v1.x - v0.x, v1.y - v0.y, v1.z - v0.z, v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+	T t, u, v;
+	bool is_hit = kernel_intersect_triangle_lanes(ray, triangle, t_min, t_max, t, u, v) != 0;
+	return { is_hit, t, u, v };
+}
+
+/*
+	intersect
+	- one ray against triangles [begin, end), all triangles or the triangles of a bvh (stored in its leaf order),
+	  hit keeps the closest hit, the range overload returns whether it found a closer one and is the leaf routine
+	  of the bvh traversal
+	- rays against triangles: every ray of origins / directions against triangles [begin, end), hits keeps the
+	  closest hit of each ray, rays are split across threads above PARALLEL_MATRIX_GRAIN
+	- float runs 4 (SSE), 8 (AVX2) or 16 (AVX-512) triangles or rays at a time
+	- throws std::invalid_argument when the soa containers differ in size
+*/
+template<class T, class Kernel>
+inline bool intersect_range(const triangle_soa<T>& triangles, size_t begin, size_t end, vec3<T> origin, vec3<T> direction, ray_hit<T>& hit, T t_min, Kernel kernel)
+{
+	T ray[] = { origin.x, origin.y, origin.z, direction.x, direction.y, direction.z };
+	T closest[] = { hit.distance, hit.u, hit.v };
+	size_t index = RAY_NO_HIT;
+	const T* parts[9];
+	triangles.components(parts);
+	kernel(ray, parts, begin, end, t_min, closest, &index);
+	if (index == RAY_NO_HIT)
+	{
+		return false;
+	}
+	hit.distance = closest[0]; hit.u = closest[1]; hit.v = closest[2];
+	hit.primitive = triangles.primitives[index];
+	return true;
+}
+
+template<class T>
+inline bool intersect(const triangle_soa<T>& triangles, size_t begin, size_t end, vec3<T> origin, vec3<T> direction, ray_hit<T>& hit, T t_min = 0)
+{
+	return intersect_range(triangles, begin, end, origin, direction, hit, t_min, kernel_intersect_triangles_scalar<T>);
+}
+
+inline bool intersect(const triangle_soa<float>& triangles, size_t begin, size_t end, vec3<float> origin, vec3<float> direction, ray_hit<float>& hit, float t_min = 0)
+{
+	return intersect_range(triangles, begin, end, origin, direction, hit, t_min, batch_kernels().intersect_trianglesf);
+}
+
+template<class T>
+inline ray_hit<T> intersect(const triangle_soa<T>& triangles, vec3<T> origin, vec3<T> direction, T t_min = 0, T t_max = std::numeric_limits<T>::infinity())
+{
+	ray_hit<T> hit(t_max);
+	intersect(triangles, 0, triangles.size(), origin, direction, hit, t_min);
+	return hit;
+}
+
+template<class T>
+inline ray_hit<T> intersect(const bvh<T>& tree, const triangle_soa<T>& triangles, vec3<T> origin, vec3<T> direction,
+	T t_min = 0, T t_max = std::numeric_limits<T>::infinity())
+{
+	ray_hit<T> hit(t_max);
+	tree.traverse_ray_leaves(origin, direction, t_max, [&](size_t offset, size_t count, T)
+	{
+		intersect(triangles, offset, offset + count, origin, direction, hit, t_min);
+		return hit.distance;
+	});
+	return hit;
+}
+
+template<class T, class Kernel>
+inline void intersect_packets(const vec3_soa<T>& origins, const vec3_soa<T>& directions, const triangle_soa<T>& triangles, size_t begin, size_t end,
+	ray_hit_soa<T>& hits, T t_min, Kernel kernel)
+{
+	check_soa_size(origins.size(), directions.size());
+	check_soa_size(origins.size(), hits.size());
+	const T* rays[] = { origins.x.data(), origins.y.data(), origins.z.data(), directions.x.data(), directions.y.data(), directions.z.data() };
+	T* hit_parts[] = { hits.distance.data(), hits.u.data(), hits.v.data() };
+	const T* parts[9];
+	triangles.components(parts);
+	parallel_for(origins.size(), PARALLEL_MATRIX_GRAIN, [&](size_t ray_begin, size_t ray_end)
+	{
+		for (size_t chunk = ray_begin; chunk < ray_end; chunk += RAY_PACKET_CHUNK)
+		{
+			size_t chunk_end = ray_end - chunk < RAY_PACKET_CHUNK ? ray_end : chunk + RAY_PACKET_CHUNK;
+			for (size_t i = begin; i < end; i++)
+			{
+				T triangle[9];
+				for (size_t k = 0; k < 9; k++) { triangle[k] = parts[k][i]; }
+				kernel(rays, chunk, chunk_end, triangle, triangles.primitives[i], t_min, hit_parts, hits.primitive.data());
+			}
+		}
+	});
+}
+
+template<class T>
+inline void intersect(const vec3_soa<T>& origins, const vec3_soa<T>& directions, const triangle_soa<T>& triangles, size_t begin, size_t end,
+	ray_hit_soa<T>& hits, T t_min = 0)
+{
+	intersect_packets(origins, directions, triangles, begin, end, hits, t_min, kernel_intersect_rays_scalar<T>);
+}
+
+inline void intersect(const vec3_soa<float>& origins, const vec3_soa<float>& directions, const triangle_soa<float>& triangles, size_t begin, size_t end,
+	ray_hit_soa<float>& hits, float t_min = 0)
+{
+	intersect_packets(origins, directions, triangles, begin, end, hits, t_min, batch_kernels().intersect_raysf);
+}
+
+MATH_EXECUTION_OVERLOAD(intersect)
+
+#endif // !__RAY__
@@ -0,0 +1,298 @@
+#pragma once
+
+#ifndef __REDUCE__
+#define __REDUCE__
+
+#include <array>
+#include <vector>
+
+#include "aabb.hpp"
+#include "soa.hpp"
+#include "view.hpp"
+
+//Points a reduction block sums directly, blocks and then thread chunks are combined pairwise
+#define REDUCE_BLOCK 256
+
+/*
+	reduce_sum / reduce_bounds / reduce_centroid / reduce_covariance
+	- the sum, bounding box, mean and covariance of vec3 points given as an array, a vec3_soa or a strided view
+	- sums are pairwise: every REDUCE_BLOCK points are summed directly (float across 4, 8 or 16 SIMD lanes), blocks
+	  and the chunks of the threads are then added in a balanced tree, the error grows with log(count) instead of
+	  count, so float points stay accurate without wider accumulators
+	- covariance is the population covariance sum((p - c) * (p - c)^T) / count about the centroid c, taken in a
+	  second pass over the deviations from c
+	- arrays above PARALLEL_GRAIN are split across threads, the result does not depend on the thread count
+	- empty inputs give a zero sum, centroid and covariance and the empty box
+*/
+template<class T>
+inline void reduce_bounds_block(const T* const* components, size_t count, T* out)
+{
+	kernel_reduce_bounds_scalar(components, count, out);
+}
+
+inline void reduce_bounds_block(const float* const* components, size_t count, float* out)
+{
+	batch_kernels().reduce_boundsf(components, count, out);
+}
+
+template<class T>
+inline void reduce_moments_block(const T* const* components, size_t count, const T* center, T* out)
+{
+	kernel_reduce_moments_scalar(components, count, center, out);
+}
+
+inline void reduce_moments_block(const float* const* components, size_t count, const float* center, float* out)
+{
+	batch_kernels().reduce_momentsf(components, count, center, out);
+}
+
+/*
+	reduce_pairwise
+	- reduces points [begin, end) into out: load(begin, end, buffer, components) points components at the x, y, z
+	  arrays of a block (staging AoS points in buffer), block(components, count, out) reduces one block and
+	  merge(partial, out) combines two results
+*/
+template<class T, class Load, class Block, class Merge>
+inline void reduce_pairwise(size_t begin, size_t end, Load& load, Block& block, Merge& merge, T* out)
+{
+	if (end - begin <= REDUCE_BLOCK)
+	{
+		T buffer[3][REDUCE_BLOCK];
+		const T* components[3];
+		load(begin, end, buffer, components);
+		block(components, end - begin, out);
+		return;
+	}
+	size_t blocks = (end - begin + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+	size_t middle = begin + blocks / 2 * REDUCE_BLOCK;
+	T partial[9];
+	reduce_pairwise(begin, middle, load, block, merge, out);
+	reduce_pairwise(middle, end, load, block, merge, partial);
+	merge(partial, out);
+}
+
+template<class T, class Merge>
+inline void reduce_merge_pairwise(std::array<T, 9>* partials, size_t begin, size_t end, Merge& merge)
+{
+	if (end - begin <= 1)
+	{
+		return;
+	}
+	size_t middle = begin + (end - begin) / 2;
+	reduce_merge_pairwise(partials, begin, middle, merge);
+	reduce_merge_pairwise(partials, middle, end, merge);
+	merge(partials[middle].data(), partials[begin].data());
+}
+
+//Chunks of PARALLEL_GRAIN points are reduced pairwise on their own and then merged pairwise
+template<class T, class Load, class Block, class Merge>
+inline void reduce_parallel(size_t count, Load load, Block block, Merge merge, T* out)
+{
+	size_t chunks = count > 0 ? (count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN : 1;
+	std::vector<std::array<T, 9>> partials(chunks);
+	const T* none[3] = { nullptr, nullptr, nullptr };
+	for (std::array<T, 9>& partial : partials)
+	{
+		block(none, 0, partial.data());
+	}
+	//parallel_for runs a single [0, count) call when it stays on one thread, split it at the same chunk boundaries
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t chunk_begin = begin; chunk_begin < end; chunk_begin += PARALLEL_GRAIN)
+		{
+			size_t chunk_end = end - chunk_begin < PARALLEL_GRAIN ? end : chunk_begin + PARALLEL_GRAIN;
+			reduce_pairwise(chunk_begin, chunk_end, load, block, merge, partials[chunk_begin / PARALLEL_GRAIN].data());
+		}
+	});
+	reduce_merge_pairwise(partials.data(), 0, chunks, merge);
+	for (size_t k = 0; k < 9; k++)
+	{
+		out[k] = partials[0][k];
+	}
+}
+
+template<class T, class Load>
+inline void reduce_bounds_run(size_t count, Load load, T* out)
+{
+	reduce_parallel(count, load, [](const T* const* components, size_t size, T* result) { reduce_bounds_block(components, size, result); },
+		[](const T* partial, T* result) { kernel_reduce_bounds_merge(partial, result); }, out);
+}
+
+template<class T, class Load>
+inline mat3x3<T> reduce_covariance_run(size_t count, Load load)
+{
+	T bounds[9];
+	reduce_bounds_run(count, load, bounds);
+	if (count == 0)
+	{
+		return mat3x3<T>(0, 0, 0, 0, 0, 0, 0, 0, 0);
+	}
+	T inverse_count = static_cast<T>(1.0) / static_cast<T>(count);
+	T center[] = { bounds[0] * inverse_count, bounds[1] * inverse_count, bounds[2] * inverse_count };
+	T moments[9];
+	reduce_parallel(count, load, [&](const T* const* components, size_t size, T* result) { reduce_moments_block(components, size, center, result); },
+		[](const T* partial, T* result) { kernel_reduce_moments_merge(partial, result); }, moments);
+	//The deviations sum to zero up to rounding, subtracting their square removes what the rounded center leaves behind
+	T xx = (moments[3] - moments[0] * moments[0] * inverse_count) * inverse_count;
+	T yy = (moments[4] - moments[1] * moments[1] * inverse_count) * inverse_count;
+	T zz = (moments[5] - moments[2] * moments[2] * inverse_count) * inverse_count;
+	T xy = (moments[6] - moments[0] * moments[1] * inverse_count) * inverse_count;
+	T yz = (moments[7] - moments[1] * moments[2] * inverse_count) * inverse_count;
+	T zx = (moments[8] - moments[2] * moments[0] * inverse_count) * inverse_count;
+	return mat3x3<T>(xx, xy, zx, xy, yy, yz, zx, yz, zz);
+}
+
+//Loaders of reduce_pairwise for the three layouts
+template<class T>
+inline auto reduce_load(const vec3<T>* vecs)
+{
+	return [vecs](size_t begin, size_t end, T (&buffer)[3][REDUCE_BLOCK], const T** components)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			buffer[0][i - begin] = vecs[i].x; buffer[1][i - begin] = vecs[i].y; buffer[2][i - begin] = vecs[i].z;
+		}
+		components[0] = buffer[0]; components[1] = buffer[1]; components[2] = buffer[2];
+	};
+}
+
+template<class T>
+inline auto reduce_load(const vec3_soa<T>& vecs)
+{
+	const T* x = vecs.x.data();
+	const T* y = vecs.y.data();
+	const T* z = vecs.z.data();
+	return [x, y, z](size_t begin, size_t, T (&)[3][REDUCE_BLOCK], const T** components)
+	{
+		components[0] = x + begin; components[1] = y + begin; components[2] = z + begin;
+	};
+}
+
+template<class T, class V>
+inline auto reduce_load(strided_view<V> vecs)
+{
+	return [vecs](size_t begin, size_t end, T (&buffer)[3][REDUCE_BLOCK], const T** components)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const vec3<T>& vec = vecs.unchecked(i);
+			buffer[0][i - begin] = vec.x; buffer[1][i - begin] = vec.y; buffer[2][i - begin] = vec.z;
+		}
+		components[0] = buffer[0]; components[1] = buffer[1]; components[2] = buffer[2];
+	};
+}
+
+template<class T>
+inline vec3<T> reduce_sum(const vec3<T>* vecs, size_t count)
+{
+	T bounds[9];
+	reduce_bounds_run(count, reduce_load(vecs), bounds);
+	return vec3<T>(bounds[0], bounds[1], bounds[2]);
+}
+
+template<class T>
+inline aabb3<T> reduce_bounds(const vec3<T>* vecs, size_t count)
+{
+	T bounds[9];
+	reduce_bounds_run(count, reduce_load(vecs), bounds);
+	return aabb3<T>(vec3<T>(bounds[3], bounds[4], bounds[5]), vec3<T>(bounds[6], bounds[7], bounds[8]));
+}
+
+template<class T>
+inline vec3<T> reduce_centroid(const vec3<T>* vecs, size_t count)
+{
+	return count > 0 ? reduce_sum(vecs, count) / static_cast<T>(count) : vec3<T>();
+}
+
+template<class T>
+inline mat3x3<T> reduce_covariance(const vec3<T>* vecs, size_t count)
+{
+	return reduce_covariance_run<T>(count, reduce_load(vecs));
+}
+
+template<class T>
+inline vec3<T> reduce_sum(const vec3_soa<T>& vecs)
+{
+	T bounds[9];
+	reduce_bounds_run(vecs.size(), reduce_load(vecs), bounds);
+	return vec3<T>(bounds[0], bounds[1], bounds[2]);
+}
+
+template<class T>
+inline aabb3<T> reduce_bounds(const vec3_soa<T>& vecs)
+{
+	T bounds[9];
+	reduce_bounds_run(vecs.size(), reduce_load(vecs), bounds);
+	return aabb3<T>(vec3<T>(bounds[3], bounds[4], bounds[5]), vec3<T>(bounds[6], bounds[7], bounds[8]));
+}
+
+template<class T>
+inline vec3<T> reduce_centroid(const vec3_soa<T>& vecs)
+{
+	return vecs.size() > 0 ? reduce_sum(vecs) / static_cast<T>(vecs.size()) : vec3<T>();
+}
+
+template<class T>
+inline mat3x3<T> reduce_covariance(const vec3_soa<T>& vecs)
+{
+	return reduce_covariance_run<T>(vecs.size(), reduce_load(vecs));
+}
+
+template<class T>
+inline vec3<T> reduce_sum(const_vec3_view<T> vecs)
+{
+	T bounds[9];
+	reduce_bounds_run(vecs.size(), reduce_load<T>(vecs), bounds);
+	return vec3<T>(bounds[0], bounds[1], bounds[2]);
+}
+
+template<class T>
+inline aabb3<T> reduce_bounds(const_vec3_view<T> vecs)
+{
+	T bounds[9];
+	reduce_bounds_run(vecs.size(), reduce_load<T>(vecs), bounds);
+	return aabb3<T>(vec3<T>(bounds[3], bounds[4], bounds[5]), vec3<T>(bounds[6], bounds[7], bounds[8]));
+}
+
+template<class T>
+inline vec3<T> reduce_centroid(const_vec3_view<T> vecs)
+{
+	return vecs.size() > 0 ? reduce_sum(vecs) / static_cast<T>(vecs.size()) : vec3<T>();
+}
+
+template<class T>
+inline mat3x3<T> reduce_covariance(const_vec3_view<T> vecs)
+{
+	return reduce_covariance_run<T>(vecs.size(), reduce_load<T>(vecs));
+}
+
+template<class T>
+inline vec3<T> reduce_sum(vec3_view<T> vecs)
+{
+	return reduce_sum(const_vec3_view<T>(vecs));
+}
+
+template<class T>
+inline aabb3<T> reduce_bounds(vec3_view<T> vecs)
+{
+	return reduce_bounds(const_vec3_view<T>(vecs));
+}
+
+template<class T>
+inline vec3<T> reduce_centroid(vec3_view<T> vecs)
+{
+	return reduce_centroid(const_vec3_view<T>(vecs));
+}
+
+template<class T>
+inline mat3x3<T> reduce_covariance(vec3_view<T> vecs)
+{
+	return reduce_covariance(const_vec3_view<T>(vecs));
+}
+
+MATH_EXECUTION_OVERLOAD(reduce_sum)
+MATH_EXECUTION_OVERLOAD(reduce_bounds)
+MATH_EXECUTION_OVERLOAD(reduce_centroid)
+MATH_EXECUTION_OVERLOAD(reduce_covariance)
+
+#endif // !__REDUCE__
@@ -0,0 +1,282 @@
+#pragma once
+
+#ifndef __SIMD__
+#define __SIMD__
+
+#include <type_traits>
+
+/*
+	simd
+	- MATH_SSE2 is defined when SSE2 is part of the compilation target (always on x64)
+	- MATH_AVX / MATH_FMA are defined only when the compiler itself targets AVX / FMA
+	- define MATH_NO_SIMD before including any header to force the scalar code paths
+*/
+#if !defined(MATH_NO_SIMD)
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE2 1
+#endif
+#if defined(MATH_SSE2) && defined(__AVX__)
+#define MATH_AVX 1
+#endif
+#if defined(MATH_AVX) && (defined(__FMA__) || defined(__AVX2__))
+#define MATH_FMA 1
+#endif
+#endif
+
+/*
+	MATH_TARGET
+	- lets a single function use an instruction set above the compilation target (GCC/Clang need it, MSVC does not)
+	- such functions must only be reached through the runtime dispatch in dispatch.hpp
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MATH_TARGET(isa)
+#endif
+
+//Inlines every call into a MATH_TARGET kernel, so generic templates over lane types get compiled for its instruction set
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_FLATTEN __attribute__((flatten))
+#else
+#define MATH_FLATTEN
+#endif
+
+/*
+	MATH_IS_CONSTANT_EVALUATED
+	- true while a constexpr function is being evaluated at compile time, the SIMD paths branch on it
+	- falls back to false on compilers without the builtin, constexpr calls then only work on the generic templates and
+	  not on the SIMD specializations of vec4<float>, vec4<double> and mat4x4<float>, the project needs the v142 toolset
+	  (Visual Studio 2019 16.5, _MSC_VER 1925) or later, math.cpp checks those specializations with static_assert
+*/
+#if defined(__cpp_lib_is_constant_evaluated)
+#define MATH_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define MATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define MATH_IS_CONSTANT_EVALUATED() false
+#endif
+
+#if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+#define MATH_RESTRICT __restrict
+#else
+#define MATH_RESTRICT
+#endif
+
+#ifdef MATH_SSE2
+
+#include <immintrin.h>
+
+//a * b + c
+inline __m128 simd_madd_ps(__m128 a, __m128 b, __m128 c)
+{
+#ifdef MATH_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+//Broadcast lane i of v to all four lanes
+template<int i>
+inline __m128 simd_splat_ps(__m128 v)
+{
+	return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+}
+
+//Sum of the four lanes, broadcast to all lanes
+inline __m128 simd_hsum_ps(__m128 v)
+{
+	__m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(v, shuf);
+	shuf = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+	return _mm_add_ps(sums, shuf);
+}
+
+inline __m128 simd_dot_ps(__m128 a, __m128 b)
+{
+	return simd_hsum_ps(_mm_mul_ps(a, b));
+}
+
+/*
+	simd_lanes4f / simd_lanes8f / simd_lanes16f
+	- one float per lane, used to run scalar-looking code on 4, 8 or 16 independent problems at once
+	- simd_lanes8f needs AVX2, only instantiate it from MATH_TARGET("avx2,fma") functions,
+	  simd_lanes16f needs AVX-512F and MATH_TARGET("avx512f") functions
+*/
+struct simd_lanes4f
+{
+	__m128 v;
+
+	simd_lanes4f() : v(_mm_setzero_ps()) {}
+	simd_lanes4f(__m128 v) : v(v) {}
+	explicit simd_lanes4f(float t) : v(_mm_set1_ps(t)) {}
+};
+
+inline simd_lanes4f operator+(simd_lanes4f a, simd_lanes4f b) { return _mm_add_ps(a.v, b.v); }
+inline simd_lanes4f operator-(simd_lanes4f a, simd_lanes4f b) { return _mm_sub_ps(a.v, b.v); }
+inline simd_lanes4f operator*(simd_lanes4f a, simd_lanes4f b) { return _mm_mul_ps(a.v, b.v); }
+inline simd_lanes4f operator/(simd_lanes4f a, simd_lanes4f b) { return _mm_div_ps(a.v, b.v); }
+inline simd_lanes4f operator-(simd_lanes4f a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+//Bit i is set when lane i satisfies abs(t) <= threshold
+inline unsigned int lanes_abs_le_mask(simd_lanes4f t, float threshold)
+{
+	__m128 abs = _mm_andnot_ps(_mm_set1_ps(-0.0f), t.v);
+	return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(abs, _mm_set1_ps(threshold))));
+}
+
+inline simd_lanes4f lanes_sqrt(simd_lanes4f t) { return _mm_sqrt_ps(t.v); }
+
+//1 or -1 with the sign of each lane
+inline simd_lanes4f lanes_sign(simd_lanes4f t) { return _mm_or_ps(_mm_and_ps(t.v, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f)); }
+inline simd_lanes4f lanes_max(simd_lanes4f a, simd_lanes4f b) { return _mm_max_ps(a.v, b.v); }
+inline simd_lanes4f lanes_min(simd_lanes4f a, simd_lanes4f b) { return _mm_min_ps(a.v, b.v); }
+inline simd_lanes4f lanes_abs(simd_lanes4f t) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), t.v); }
+
+//Nearest integer through the current rounding mode (ties to even), |t| must be below 2^31
+inline simd_lanes4f lanes_round(simd_lanes4f t) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(t.v)); }
+
+//if_true where t1 < t2, if_false elsewhere
+inline simd_lanes4f lanes_select_lt(simd_lanes4f t1, simd_lanes4f t2, simd_lanes4f if_true, simd_lanes4f if_false)
+{
+	__m128 mask = _mm_cmplt_ps(t1.v, t2.v);
+	return _mm_or_ps(_mm_and_ps(mask, if_true.v), _mm_andnot_ps(mask, if_false.v));
+}
+
+//Bit i is set when lane i satisfies t1 < t2
+inline unsigned int lanes_lt_mask(simd_lanes4f t1, simd_lanes4f t2) { return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmplt_ps(t1.v, t2.v))); }
+inline unsigned int lanes_le_mask(simd_lanes4f t1, simd_lanes4f t2) { return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(t1.v, t2.v))); }
+
+//rsqrtps estimate refined by one Newton-Raphson step: e * (1.5 - 0.5 * t * e * e)
+inline simd_lanes4f lanes_rsqrt(simd_lanes4f t)
+{
+	__m128 e = _mm_rsqrt_ps(t.v);
+	__m128 half_t_e2 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t.v, _mm_set1_ps(0.5f)), e), e);
+	return _mm_mul_ps(e, _mm_sub_ps(_mm_set1_ps(1.5f), half_t_e2));
+}
+
+struct simd_lanes8f
+{
+	__m256 v;
+
+	MATH_TARGET("avx2,fma") simd_lanes8f() : v(_mm256_setzero_ps()) {}
+	MATH_TARGET("avx2,fma") simd_lanes8f(__m256 v) : v(v) {}
+	MATH_TARGET("avx2,fma") explicit simd_lanes8f(float t) : v(_mm256_set1_ps(t)) {}
+};
+
+MATH_TARGET("avx2,fma") inline simd_lanes8f operator+(simd_lanes8f a, simd_lanes8f b) { return _mm256_add_ps(a.v, b.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f operator-(simd_lanes8f a, simd_lanes8f b) { return _mm256_sub_ps(a.v, b.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f operator*(simd_lanes8f a, simd_lanes8f b) { return _mm256_mul_ps(a.v, b.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f operator/(simd_lanes8f a, simd_lanes8f b) { return _mm256_div_ps(a.v, b.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f operator-(simd_lanes8f a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+MATH_TARGET("avx2,fma")
+inline unsigned int lanes_abs_le_mask(simd_lanes8f t, float threshold)
+{
+	__m256 abs = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), t.v);
+	return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(abs, _mm256_set1_ps(threshold), _CMP_LE_OQ)));
+}
+
+MATH_TARGET("avx2,fma") inline simd_lanes8f lanes_sqrt(simd_lanes8f t) { return _mm256_sqrt_ps(t.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f lanes_sign(simd_lanes8f t) { return _mm256_or_ps(_mm256_and_ps(t.v, _mm256_set1_ps(-0.0f)), _mm256_set1_ps(1.0f)); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f lanes_max(simd_lanes8f a, simd_lanes8f b) { return _mm256_max_ps(a.v, b.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f lanes_min(simd_lanes8f a, simd_lanes8f b) { return _mm256_min_ps(a.v, b.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f lanes_abs(simd_lanes8f t) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), t.v); }
+MATH_TARGET("avx2,fma") inline simd_lanes8f lanes_round(simd_lanes8f t) { return _mm256_round_ps(t.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+MATH_TARGET("avx2,fma")
+inline simd_lanes8f lanes_select_lt(simd_lanes8f t1, simd_lanes8f t2, simd_lanes8f if_true, simd_lanes8f if_false)
+{
+	return _mm256_blendv_ps(if_false.v, if_true.v, _mm256_cmp_ps(t1.v, t2.v, _CMP_LT_OQ));
+}
+
+MATH_TARGET("avx2,fma")
+inline unsigned int lanes_lt_mask(simd_lanes8f t1, simd_lanes8f t2)
+{
+	return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(t1.v, t2.v, _CMP_LT_OQ)));
+}
+
+MATH_TARGET("avx2,fma")
+inline unsigned int lanes_le_mask(simd_lanes8f t1, simd_lanes8f t2)
+{
+	return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(t1.v, t2.v, _CMP_LE_OQ)));
+}
+
+MATH_TARGET("avx2,fma")
+inline simd_lanes8f lanes_rsqrt(simd_lanes8f t)
+{
+	__m256 e = _mm256_rsqrt_ps(t.v);
+	__m256 half_t_e2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t.v, _mm256_set1_ps(0.5f)), e), e);
+	return _mm256_mul_ps(e, _mm256_sub_ps(_mm256_set1_ps(1.5f), half_t_e2));
+}
+
+struct simd_lanes16f
+{
+	__m512 v;
+
+	MATH_TARGET("avx512f") simd_lanes16f() : v(_mm512_setzero_ps()) {}
+	MATH_TARGET("avx512f") simd_lanes16f(__m512 v) : v(v) {}
+	MATH_TARGET("avx512f") explicit simd_lanes16f(float t) : v(_mm512_set1_ps(t)) {}
+};
+
+MATH_TARGET("avx512f") inline simd_lanes16f operator+(simd_lanes16f a, simd_lanes16f b) { return _mm512_add_ps(a.v, b.v); }
+MATH_TARGET("avx512f") inline simd_lanes16f operator-(simd_lanes16f a, simd_lanes16f b) { return _mm512_sub_ps(a.v, b.v); }
+MATH_TARGET("avx512f") inline simd_lanes16f operator*(simd_lanes16f a, simd_lanes16f b) { return _mm512_mul_ps(a.v, b.v); }
+MATH_TARGET("avx512f") inline simd_lanes16f operator/(simd_lanes16f a, simd_lanes16f b) { return _mm512_div_ps(a.v, b.v); }
+MATH_TARGET("avx512f") inline simd_lanes16f lanes_max(simd_lanes16f a, simd_lanes16f b) { return _mm512_max_ps(a.v, b.v); }
+MATH_TARGET("avx512f") inline simd_lanes16f lanes_min(simd_lanes16f a, simd_lanes16f b) { return _mm512_min_ps(a.v, b.v); }
+MATH_TARGET("avx512f") inline simd_lanes16f lanes_abs(simd_lanes16f t) { return _mm512_abs_ps(t.v); }
+MATH_TARGET("avx512f") inline unsigned int lanes_lt_mask(simd_lanes16f t1, simd_lanes16f t2) { return _mm512_cmp_ps_mask(t1.v, t2.v, _CMP_LT_OQ); }
+MATH_TARGET("avx512f") inline unsigned int lanes_le_mask(simd_lanes16f t1, simd_lanes16f t2) { return _mm512_cmp_ps_mask(t1.v, t2.v, _CMP_LE_OQ); }
+
+/*
+	simd_d4
+	- four doubles, held in one __m256d when compiling for AVX, otherwise in two __m128d
+*/
+#ifdef MATH_AVX
+
+using simd_d4 = __m256d;
+
+inline simd_d4 simd_load_d4(const double* ptr) { return _mm256_loadu_pd(ptr); }
+inline void simd_store_d4(double* ptr, simd_d4 v) { _mm256_storeu_pd(ptr, v); }
+inline simd_d4 simd_set1_d4(double t) { return _mm256_set1_pd(t); }
+inline simd_d4 simd_add_d4(simd_d4 a, simd_d4 b) { return _mm256_add_pd(a, b); }
+inline simd_d4 simd_sub_d4(simd_d4 a, simd_d4 b) { return _mm256_sub_pd(a, b); }
+inline simd_d4 simd_mul_d4(simd_d4 a, simd_d4 b) { return _mm256_mul_pd(a, b); }
+inline simd_d4 simd_div_d4(simd_d4 a, simd_d4 b) { return _mm256_div_pd(a, b); }
+
+inline double simd_dot_d4(simd_d4 a, simd_d4 b)
+{
+	__m256d m = _mm256_mul_pd(a, b);
+	__m128d s = _mm_add_pd(_mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1));
+	s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+	return _mm_cvtsd_f64(s);
+}
+
+#else
+
+struct simd_d4
+{
+	__m128d lo, hi;
+};
+
+inline simd_d4 simd_load_d4(const double* ptr) { return { _mm_loadu_pd(ptr), _mm_loadu_pd(ptr + 2) }; }
+inline void simd_store_d4(double* ptr, simd_d4 v) { _mm_storeu_pd(ptr, v.lo); _mm_storeu_pd(ptr + 2, v.hi); }
+inline simd_d4 simd_set1_d4(double t) { return { _mm_set1_pd(t), _mm_set1_pd(t) }; }
+inline simd_d4 simd_add_d4(simd_d4 a, simd_d4 b) { return { _mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi) }; }
+inline simd_d4 simd_sub_d4(simd_d4 a, simd_d4 b) { return { _mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi) }; }
+inline simd_d4 simd_mul_d4(simd_d4 a, simd_d4 b) { return { _mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi) }; }
+inline simd_d4 simd_div_d4(simd_d4 a, simd_d4 b) { return { _mm_div_pd(a.lo, b.lo), _mm_div_pd(a.hi, b.hi) }; }
+
+inline double simd_dot_d4(simd_d4 a, simd_d4 b)
+{
+	__m128d s = _mm_add_pd(_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi));
+	s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+	return _mm_cvtsd_f64(s);
+}
+
+#endif
+
+#endif // MATH_SSE2
+
+#endif // !__SIMD__
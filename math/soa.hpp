@@ -0,0 +1,1185 @@
+#pragma once
+
+#ifndef __SOA__
+#define __SOA__
+
+#include <new>
+#include <utility>
+
+#include "dispatch.hpp"
+
+template<class T>
+class soa_array;
+
+template<class T>
+class vec3_soa;
+
+template<class T>
+class vec4_soa;
+
+struct expr_node;
+
+using soa_arrayf = soa_array<float>;
+using soa_arrayd = soa_array<double>;
+using soa_arrayld = soa_array<long double>;
+
+using vec3f_soa = vec3_soa<float>;
+using vec3d_soa = vec3_soa<double>;
+using vec3ld_soa = vec3_soa<long double>;
+
+using vec4f_soa = vec4_soa<float>;
+using vec4d_soa = vec4_soa<double>;
+using vec4ld_soa = vec4_soa<long double>;
+
+#define SOA_ALIGNMENT 64
+
+/*
+	soa_array
+	- one component column of a SoA container, SOA_ALIGNMENT aligned
+	- the storage is padded to a whole number of SOA_ALIGNMENT blocks, padding lanes are zero and may be read
+*/
+template<class T>
+class soa_array
+{
+private:
+	T* elements;
+	size_t count;
+	size_t capacity;
+
+public:
+	soa_array() : elements(nullptr), count(0), capacity(0)
+	{
+		static_assert(std::is_floating_point<T>::value, "Type T of soa_array must be a floating-point type!");
+	}
+
+	explicit soa_array(size_t size, T value = 0.0) : soa_array()
+	{
+		allocate(size);
+		for (size_t i = 0; i < count; i++)
+		{
+			elements[i] = value;
+		}
+	}
+
+	soa_array(const soa_array<T>& arr) : soa_array()
+	{
+		allocate(arr.count);
+		for (size_t i = 0; i < count; i++)
+		{
+			elements[i] = arr.elements[i];
+		}
+	}
+
+	soa_array(soa_array<T>&& arr) noexcept : elements(arr.elements), count(arr.count), capacity(arr.capacity)
+	{
+		arr.elements = nullptr;
+		arr.count = 0;
+		arr.capacity = 0;
+	}
+
+	~soa_array()
+	{
+		release();
+	}
+
+	soa_array<T>& operator=(const soa_array<T>& arr)
+	{
+		if (this != &arr)
+		{
+			soa_array<T> copied(arr);
+			swap(copied);
+		}
+		return *this;
+	}
+
+	soa_array<T>& operator=(soa_array<T>&& arr) noexcept
+	{
+		if (this != &arr)
+		{
+			release();
+			std::swap(elements, arr.elements);
+			std::swap(count, arr.count);
+			std::swap(capacity, arr.capacity);
+		}
+		return *this;
+	}
+
+	//Evaluates an expression from expression.hpp in a single pass
+	template<class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+	soa_array<T>& operator=(const E& expr)
+	{
+		assign(*this, expr);
+		return *this;
+	}
+
+public:
+	T& operator[](size_t index)
+	{
+		MATH_CHECK_INDEX(index >= count, "soa_array index out of range!");
+		return elements[index];
+	}
+
+	T operator[](size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= count, "soa_array index out of range!");
+		return elements[index];
+	}
+
+	T* data()
+	{
+		return elements;
+	}
+
+	const T* data() const
+	{
+		return elements;
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	//Number of addressable lanes including the zeroed padding
+	size_t padded_size() const
+	{
+		return capacity;
+	}
+
+	void swap(soa_array<T>& arr) noexcept
+	{
+		std::swap(elements, arr.elements);
+		std::swap(count, arr.count);
+		std::swap(capacity, arr.capacity);
+	}
+
+private:
+	void allocate(size_t size)
+	{
+		const size_t block = SOA_ALIGNMENT / sizeof(T) > 0 ? SOA_ALIGNMENT / sizeof(T) : 1;
+		if (size > std::numeric_limits<size_t>::max() / sizeof(T) - block) { throw std::length_error("soa_array size too large!"); }
+		count = size;
+		capacity = (size + block - 1) / block * block;
+		if (capacity > 0)
+		{
+			elements = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(SOA_ALIGNMENT)));
+			for (size_t i = 0; i < capacity; i++)
+			{
+				elements[i] = 0.0;
+			}
+		}
+	}
+
+	void release()
+	{
+		if (elements != nullptr)
+		{
+			::operator delete(elements, std::align_val_t(SOA_ALIGNMENT));
+		}
+		elements = nullptr;
+		count = 0;
+		capacity = 0;
+	}
+};
+
+template<class T>
+class vec3_soa
+{
+public:
+	using value_type = T;
+	static const size_t dimension = 3;
+
+	soa_array<T> x, y, z;
+
+public:
+	vec3_soa()
+	{
+	}
+
+	explicit vec3_soa(size_t size) : x(size), y(size), z(size)
+	{
+	}
+
+	vec3_soa(size_t size, vec3<T> value) : x(size, value.x), y(size, value.y), z(size, value.z)
+	{
+	}
+
+	//Converts count array-of-structs vectors
+	vec3_soa(const vec3<T>* vecs, size_t count) : x(count), y(count), z(count)
+	{
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			T* MATH_RESTRICT px = x.data();
+			T* MATH_RESTRICT py = y.data();
+			T* MATH_RESTRICT pz = z.data();
+			for (size_t i = begin; i < end; i++)
+			{
+				px[i] = vecs[i].x; py[i] = vecs[i].y; pz[i] = vecs[i].z;
+			}
+		});
+	}
+
+public:
+	size_t size() const
+	{
+		return x.size();
+	}
+
+	soa_array<T>& component(size_t index)
+	{
+		MATH_CHECK_INDEX(index >= 3, "vec3_soa index out of range!");
+		return index == 0 ? x : (index == 1 ? y : z);
+	}
+
+	const soa_array<T>& component(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= 3, "vec3_soa index out of range!");
+		return index == 0 ? x : (index == 1 ? y : z);
+	}
+
+	vec3<T> get(size_t index) const
+	{
+		return vec3<T>(x[index], y[index], z[index]);
+	}
+
+	void set(size_t index, vec3<T> vec)
+	{
+		x[index] = vec.x; y[index] = vec.y; z[index] = vec.z;
+	}
+
+	//Writes size() array-of-structs vectors to out
+	void to_aos(vec3<T>* out) const
+	{
+		parallel_for(size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			const T* MATH_RESTRICT px = x.data();
+			const T* MATH_RESTRICT py = y.data();
+			const T* MATH_RESTRICT pz = z.data();
+			for (size_t i = begin; i < end; i++)
+			{
+				out[i].x = px[i]; out[i].y = py[i]; out[i].z = pz[i];
+			}
+		});
+	}
+
+	void normalize();
+
+	//Evaluates an expression from expression.hpp in a single pass
+	template<class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+	vec3_soa<T>& operator=(const E& expr)
+	{
+		assign(*this, expr);
+		return *this;
+	}
+};
+
+template<class T>
+class vec4_soa
+{
+public:
+	using value_type = T;
+	static const size_t dimension = 4;
+
+	soa_array<T> x, y, z, w;
+
+public:
+	vec4_soa()
+	{
+	}
+
+	explicit vec4_soa(size_t size) : x(size), y(size), z(size), w(size)
+	{
+	}
+
+	vec4_soa(size_t size, vec4<T> value) : x(size, value.x), y(size, value.y), z(size, value.z), w(size, value.w)
+	{
+	}
+
+	//Converts count array-of-structs vectors
+	vec4_soa(const vec4<T>* vecs, size_t count) : x(count), y(count), z(count), w(count)
+	{
+		//Chunks start at multiples of PARALLEL_GRAIN, so the aligned stores stay aligned
+		parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			T* MATH_RESTRICT px = x.data();
+			T* MATH_RESTRICT py = y.data();
+			T* MATH_RESTRICT pz = z.data();
+			T* MATH_RESTRICT pw = w.data();
+			size_t i = begin;
+#ifdef MATH_SSE2
+			if constexpr (std::is_same<T, float>::value)
+			{
+				//Four vectors form a 4x4 block, a transpose turns rows into columns
+				for (; i + 4 <= end; i += 4)
+				{
+					const float* src = reinterpret_cast<const float*>(vecs + i);
+					__m128 r0 = _mm_loadu_ps(src);
+					__m128 r1 = _mm_loadu_ps(src + 4);
+					__m128 r2 = _mm_loadu_ps(src + 8);
+					__m128 r3 = _mm_loadu_ps(src + 12);
+					_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+					_mm_store_ps(px + i, r0);
+					_mm_store_ps(py + i, r1);
+					_mm_store_ps(pz + i, r2);
+					_mm_store_ps(pw + i, r3);
+				}
+			}
+#endif
+			for (; i < end; i++)
+			{
+				px[i] = vecs[i].x; py[i] = vecs[i].y; pz[i] = vecs[i].z; pw[i] = vecs[i].w;
+			}
+		});
+	}
+
+public:
+	size_t size() const
+	{
+		return x.size();
+	}
+
+	soa_array<T>& component(size_t index)
+	{
+		MATH_CHECK_INDEX(index >= 4, "vec4_soa index out of range!");
+		return index == 0 ? x : (index == 1 ? y : (index == 2 ? z : w));
+	}
+
+	const soa_array<T>& component(size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= 4, "vec4_soa index out of range!");
+		return index == 0 ? x : (index == 1 ? y : (index == 2 ? z : w));
+	}
+
+	vec4<T> get(size_t index) const
+	{
+		return vec4<T>(x[index], y[index], z[index], w[index]);
+	}
+
+	void set(size_t index, vec4<T> vec)
+	{
+		x[index] = vec.x; y[index] = vec.y; z[index] = vec.z; w[index] = vec.w;
+	}
+
+	//Writes size() array-of-structs vectors to out
+	void to_aos(vec4<T>* out) const
+	{
+		parallel_for(size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			const T* MATH_RESTRICT px = x.data();
+			const T* MATH_RESTRICT py = y.data();
+			const T* MATH_RESTRICT pz = z.data();
+			const T* MATH_RESTRICT pw = w.data();
+			size_t i = begin;
+#ifdef MATH_SSE2
+			if constexpr (std::is_same<T, float>::value)
+			{
+				for (; i + 4 <= end; i += 4)
+				{
+					__m128 r0 = _mm_load_ps(px + i);
+					__m128 r1 = _mm_load_ps(py + i);
+					__m128 r2 = _mm_load_ps(pz + i);
+					__m128 r3 = _mm_load_ps(pw + i);
+					_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+					float* dst = reinterpret_cast<float*>(out + i);
+					_mm_storeu_ps(dst, r0);
+					_mm_storeu_ps(dst + 4, r1);
+					_mm_storeu_ps(dst + 8, r2);
+					_mm_storeu_ps(dst + 12, r3);
+				}
+			}
+#endif
+			for (; i < end; i++)
+			{
+				out[i].x = px[i]; out[i].y = py[i]; out[i].z = pz[i]; out[i].w = pw[i];
+			}
+		});
+	}
+
+	void normalize();
+
+	//Evaluates an expression from expression.hpp in a single pass
+	template<class E, typename std::enable_if<std::is_base_of<expr_node, E>::value, int>::type = 0>
+	vec4_soa<T>& operator=(const E& expr)
+	{
+		assign(*this, expr);
+		return *this;
+	}
+};
+
+inline void check_soa_size(size_t size1, size_t size2)
+{
+	if (size1 != size2) { throw std::invalid_argument("soa containers must have the same size!"); }
+}
+
+/*
+	soa_map
+	- applies func lane by lane to every component, returning a new container
+	- containers above PARALLEL_GRAIN lanes are split across threads, func is then called concurrently
+*/
+template<class S, class F>
+inline S soa_map(const S& vecs, F func)
+{
+	using T = typename S::value_type;
+	S ret(vecs.size());
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t c = 0; c < S::dimension; c++)
+		{
+			const T* MATH_RESTRICT a = vecs.component(c).data();
+			T* MATH_RESTRICT r = ret.component(c).data();
+			for (size_t i = begin; i < end; i++)
+			{
+				r[i] = func(a[i]);
+			}
+		}
+	});
+	return ret;
+}
+
+template<class S, class F>
+inline S soa_map(const S& vecs1, const S& vecs2, F func)
+{
+	using T = typename S::value_type;
+	check_soa_size(vecs1.size(), vecs2.size());
+	S ret(vecs1.size());
+	parallel_for(vecs1.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t c = 0; c < S::dimension; c++)
+		{
+			const T* MATH_RESTRICT a = vecs1.component(c).data();
+			const T* MATH_RESTRICT b = vecs2.component(c).data();
+			T* MATH_RESTRICT r = ret.component(c).data();
+			for (size_t i = begin; i < end; i++)
+			{
+				r[i] = func(a[i], b[i]);
+			}
+		}
+	});
+	return ret;
+}
+
+/*
+	soa_apply
+	- applies func lane by lane to every component in place
+	- containers above PARALLEL_GRAIN lanes are split across threads, func is then called concurrently
+*/
+template<class S, class F>
+inline void soa_apply(S& vecs, F func)
+{
+	using T = typename S::value_type;
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t c = 0; c < S::dimension; c++)
+		{
+			T* MATH_RESTRICT a = vecs.component(c).data();
+			for (size_t i = begin; i < end; i++)
+			{
+				a[i] = func(a[i]);
+			}
+		}
+	});
+}
+
+template<class S, class F>
+inline void soa_apply(S& vecs1, const S& vecs2, F func)
+{
+	using T = typename S::value_type;
+	check_soa_size(vecs1.size(), vecs2.size());
+	parallel_for(vecs1.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t c = 0; c < S::dimension; c++)
+		{
+			//vecs += vecs passes the same arrays twice, they are only restrict when they differ
+			if (vecs1.component(c).data() == vecs2.component(c).data())
+			{
+				T* a = vecs1.component(c).data();
+				for (size_t i = begin; i < end; i++)
+				{
+					a[i] = func(a[i], a[i]);
+				}
+				continue;
+			}
+			T* MATH_RESTRICT a = vecs1.component(c).data();
+			const T* MATH_RESTRICT b = vecs2.component(c).data();
+			for (size_t i = begin; i < end; i++)
+			{
+				a[i] = func(a[i], b[i]);
+			}
+		}
+	});
+}
+
+template<class T>
+inline vec3_soa<T> to_soa(const vec3<T>* vecs, size_t count)
+{
+	return vec3_soa<T>(vecs, count);
+}
+
+template<class T>
+inline vec4_soa<T> to_soa(const vec4<T>* vecs, size_t count)
+{
+	return vec4_soa<T>(vecs, count);
+}
+
+template<class T>
+inline void to_aos(const vec3_soa<T>& vecs, vec3<T>* out)
+{
+	vecs.to_aos(out);
+}
+
+template<class T>
+inline void to_aos(const vec4_soa<T>& vecs, vec4<T>* out)
+{
+	vecs.to_aos(out);
+}
+
+template<class T>
+inline soa_array<T> dot(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	check_soa_size(vecs1.size(), vecs2.size());
+	soa_array<T> ret(vecs1.size());
+	parallel_for(vecs1.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		const T* MATH_RESTRICT x1 = vecs1.x.data(); const T* MATH_RESTRICT x2 = vecs2.x.data();
+		const T* MATH_RESTRICT y1 = vecs1.y.data(); const T* MATH_RESTRICT y2 = vecs2.y.data();
+		const T* MATH_RESTRICT z1 = vecs1.z.data(); const T* MATH_RESTRICT z2 = vecs2.z.data();
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = x1[i] * x2[i] + y1[i] * y2[i] + z1[i] * z2[i];
+		}
+	});
+	return ret;
+}
+
+template<class T>
+inline soa_array<T> dot(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	check_soa_size(vecs1.size(), vecs2.size());
+	soa_array<T> ret(vecs1.size());
+	parallel_for(vecs1.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		const T* MATH_RESTRICT x1 = vecs1.x.data(); const T* MATH_RESTRICT x2 = vecs2.x.data();
+		const T* MATH_RESTRICT y1 = vecs1.y.data(); const T* MATH_RESTRICT y2 = vecs2.y.data();
+		const T* MATH_RESTRICT z1 = vecs1.z.data(); const T* MATH_RESTRICT z2 = vecs2.z.data();
+		const T* MATH_RESTRICT w1 = vecs1.w.data(); const T* MATH_RESTRICT w2 = vecs2.w.data();
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = x1[i] * x2[i] + y1[i] * y2[i] + z1[i] * z2[i] + w1[i] * w2[i];
+		}
+	});
+	return ret;
+}
+
+template<class T>
+inline vec3_soa<T> cross(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	check_soa_size(vecs1.size(), vecs2.size());
+	vec3_soa<T> ret(vecs1.size());
+	parallel_for(vecs1.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		const T* MATH_RESTRICT x1 = vecs1.x.data(); const T* MATH_RESTRICT x2 = vecs2.x.data();
+		const T* MATH_RESTRICT y1 = vecs1.y.data(); const T* MATH_RESTRICT y2 = vecs2.y.data();
+		const T* MATH_RESTRICT z1 = vecs1.z.data(); const T* MATH_RESTRICT z2 = vecs2.z.data();
+		T* MATH_RESTRICT rx = ret.x.data();
+		T* MATH_RESTRICT ry = ret.y.data();
+		T* MATH_RESTRICT rz = ret.z.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			rx[i] = y1[i] * z2[i] - z1[i] * y2[i];
+			ry[i] = z1[i] * x2[i] - x1[i] * z2[i];
+			rz[i] = x1[i] * y2[i] - y1[i] * x2[i];
+		}
+	});
+	return ret;
+}
+
+template<class T>
+inline soa_array<T> sqr_length(const vec3_soa<T>& vecs)
+{
+	return dot(vecs, vecs);
+}
+
+template<class T>
+inline soa_array<T> sqr_length(const vec4_soa<T>& vecs)
+{
+	return dot(vecs, vecs);
+}
+
+template<class T>
+inline soa_array<T> length(const vec3_soa<T>& vecs)
+{
+	soa_array<T> ret = dot(vecs, vecs);
+	parallel_for(ret.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = std::sqrt(r[i]);
+		}
+	});
+	return ret;
+}
+
+template<class T>
+inline soa_array<T> length(const vec4_soa<T>& vecs)
+{
+	soa_array<T> ret = dot(vecs, vecs);
+	parallel_for(ret.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = std::sqrt(r[i]);
+		}
+	});
+	return ret;
+}
+
+template<class T>
+inline void vec3_soa<T>::normalize()
+{
+	parallel_for(size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT px = x.data();
+		T* MATH_RESTRICT py = y.data();
+		T* MATH_RESTRICT pz = z.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			T length_inv = static_cast<T>(1.0) / std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+			px[i] *= length_inv; py[i] *= length_inv; pz[i] *= length_inv;
+		}
+	});
+}
+
+template<class T>
+inline void vec4_soa<T>::normalize()
+{
+	parallel_for(size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT px = x.data();
+		T* MATH_RESTRICT py = y.data();
+		T* MATH_RESTRICT pz = z.data();
+		T* MATH_RESTRICT pw = w.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			T length_inv = static_cast<T>(1.0) / std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i] + pw[i] * pw[i]);
+			px[i] *= length_inv; py[i] *= length_inv; pz[i] *= length_inv; pw[i] *= length_inv;
+		}
+	});
+}
+
+template<class T>
+inline vec3_soa<T> normal(const vec3_soa<T>& vecs)
+{
+	vec3_soa<T> ret = vecs;
+	ret.normalize();
+	return ret;
+}
+
+template<class T>
+inline vec4_soa<T> normal(const vec4_soa<T>& vecs)
+{
+	vec4_soa<T> ret = vecs;
+	ret.normalize();
+	return ret;
+}
+
+template<class T>
+inline void normalize(vec3_soa<T>& vecs)
+{
+	vecs.normalize();
+}
+
+template<class T>
+inline void normalize(vec4_soa<T>& vecs)
+{
+	vecs.normalize();
+}
+
+/*
+	rsqrt / fast_length / fast_normal / fast_normalize
+	- the array forms of the vector.hpp functions, with the same error bound
+	- float arrays run on the dispatched kernels, 4 (SSE) or 8 (AVX2) lanes of rsqrtps refined by one Newton-Raphson step
+	- arrays above PARALLEL_GRAIN lanes are split across threads
+*/
+template<class T>
+inline soa_array<T> rsqrt(const soa_array<T>& values)
+{
+	soa_array<T> ret(values.size());
+	parallel_for(values.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		const T* MATH_RESTRICT a = values.data();
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = rsqrt(a[i]);
+		}
+	});
+	return ret;
+}
+
+inline soa_array<float> rsqrt(const soa_array<float>& values)
+{
+	soa_array<float> ret(values.size());
+	parallel_for(values.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_kernels().rsqrtf(values.data() + begin, ret.data() + begin, end - begin);
+	});
+	return ret;
+}
+
+template<class T>
+inline soa_array<T> fast_length(const vec3_soa<T>& vecs)
+{
+	soa_array<T> ret = dot(vecs, vecs);
+	parallel_for(ret.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = fast_sqrt(r[i]);
+		}
+	});
+	return ret;
+}
+
+template<class T>
+inline soa_array<T> fast_length(const vec4_soa<T>& vecs)
+{
+	soa_array<T> ret = dot(vecs, vecs);
+	parallel_for(ret.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT r = ret.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			r[i] = fast_sqrt(r[i]);
+		}
+	});
+	return ret;
+}
+
+inline soa_array<float> fast_length(const vec3_soa<float>& vecs)
+{
+	soa_array<float> ret(vecs.size());
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		const float* components[] = { vecs.x.data() + begin, vecs.y.data() + begin, vecs.z.data() + begin };
+		batch_kernels().fast_length_soaf(components, 3, ret.data() + begin, end - begin);
+	});
+	return ret;
+}
+
+inline soa_array<float> fast_length(const vec4_soa<float>& vecs)
+{
+	soa_array<float> ret(vecs.size());
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		const float* components[] = { vecs.x.data() + begin, vecs.y.data() + begin, vecs.z.data() + begin, vecs.w.data() + begin };
+		batch_kernels().fast_length_soaf(components, 4, ret.data() + begin, end - begin);
+	});
+	return ret;
+}
+
+template<class T>
+inline void fast_normalize(vec3_soa<T>& vecs)
+{
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT px = vecs.x.data();
+		T* MATH_RESTRICT py = vecs.y.data();
+		T* MATH_RESTRICT pz = vecs.z.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			T length_inv = rsqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+			px[i] *= length_inv; py[i] *= length_inv; pz[i] *= length_inv;
+		}
+	});
+}
+
+template<class T>
+inline void fast_normalize(vec4_soa<T>& vecs)
+{
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		T* MATH_RESTRICT px = vecs.x.data();
+		T* MATH_RESTRICT py = vecs.y.data();
+		T* MATH_RESTRICT pz = vecs.z.data();
+		T* MATH_RESTRICT pw = vecs.w.data();
+		for (size_t i = begin; i < end; i++)
+		{
+			T length_inv = rsqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i] + pw[i] * pw[i]);
+			px[i] *= length_inv; py[i] *= length_inv; pz[i] *= length_inv; pw[i] *= length_inv;
+		}
+	});
+}
+
+inline void fast_normalize(vec3_soa<float>& vecs)
+{
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		float* components[] = { vecs.x.data() + begin, vecs.y.data() + begin, vecs.z.data() + begin };
+		batch_kernels().fast_normalize_soaf(components, 3, end - begin);
+	});
+}
+
+inline void fast_normalize(vec4_soa<float>& vecs)
+{
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		float* components[] = { vecs.x.data() + begin, vecs.y.data() + begin, vecs.z.data() + begin, vecs.w.data() + begin };
+		batch_kernels().fast_normalize_soaf(components, 4, end - begin);
+	});
+}
+
+template<class T>
+inline vec3_soa<T> fast_normal(const vec3_soa<T>& vecs)
+{
+	vec3_soa<T> ret = vecs;
+	fast_normalize(ret);
+	return ret;
+}
+
+template<class T>
+inline vec4_soa<T> fast_normal(const vec4_soa<T>& vecs)
+{
+	vec4_soa<T> ret = vecs;
+	fast_normalize(ret);
+	return ret;
+}
+
+//Built lazily by expression.hpp when MATH_EXPRESSION_TEMPLATES is defined
+#ifndef MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline vec3_soa<T> operator+(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a + b; });
+}
+
+template<class T>
+inline vec4_soa<T> operator+(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a + b; });
+}
+
+template<class T>
+inline vec3_soa<T> operator+(const vec3_soa<T>& vecs, T t)
+{
+	return soa_map(vecs, [t](T a) { return a + t; });
+}
+
+template<class T>
+inline vec4_soa<T> operator+(const vec4_soa<T>& vecs, T t)
+{
+	return soa_map(vecs, [t](T a) { return a + t; });
+}
+
+template<class T>
+inline vec3_soa<T> operator+(T t, const vec3_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t + a; });
+}
+
+template<class T>
+inline vec4_soa<T> operator+(T t, const vec4_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t + a; });
+}
+
+#endif // !MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline void operator+=(vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a + b; });
+}
+
+template<class T>
+inline void operator+=(vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a + b; });
+}
+
+template<class T>
+inline void operator+=(vec3_soa<T>& vecs, T t)
+{
+	soa_apply(vecs, [t](T a) { return a + t; });
+}
+
+template<class T>
+inline void operator+=(vec4_soa<T>& vecs, T t)
+{
+	soa_apply(vecs, [t](T a) { return a + t; });
+}
+
+#ifndef MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline vec3_soa<T> operator-(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a - b; });
+}
+
+template<class T>
+inline vec4_soa<T> operator-(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a - b; });
+}
+
+template<class T>
+inline vec3_soa<T> operator-(const vec3_soa<T>& vecs, T t)
+{
+	return soa_map(vecs, [t](T a) { return a - t; });
+}
+
+template<class T>
+inline vec4_soa<T> operator-(const vec4_soa<T>& vecs, T t)
+{
+	return soa_map(vecs, [t](T a) { return a - t; });
+}
+
+template<class T>
+inline vec3_soa<T> operator-(T t, const vec3_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t - a; });
+}
+
+template<class T>
+inline vec4_soa<T> operator-(T t, const vec4_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t - a; });
+}
+
+#endif // !MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline void operator-=(vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a - b; });
+}
+
+template<class T>
+inline void operator-=(vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a - b; });
+}
+
+template<class T>
+inline void operator-=(vec3_soa<T>& vecs, T t)
+{
+	soa_apply(vecs, [t](T a) { return a - t; });
+}
+
+template<class T>
+inline void operator-=(vec4_soa<T>& vecs, T t)
+{
+	soa_apply(vecs, [t](T a) { return a - t; });
+}
+
+#ifndef MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline vec3_soa<T> operator*(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a * b; });
+}
+
+template<class T>
+inline vec4_soa<T> operator*(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a * b; });
+}
+
+template<class T>
+inline vec3_soa<T> operator*(const vec3_soa<T>& vecs, T t)
+{
+	return soa_map(vecs, [t](T a) { return a * t; });
+}
+
+template<class T>
+inline vec4_soa<T> operator*(const vec4_soa<T>& vecs, T t)
+{
+	return soa_map(vecs, [t](T a) { return a * t; });
+}
+
+template<class T>
+inline vec3_soa<T> operator*(T t, const vec3_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t * a; });
+}
+
+template<class T>
+inline vec4_soa<T> operator*(T t, const vec4_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t * a; });
+}
+
+#endif // !MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline void operator*=(vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a * b; });
+}
+
+template<class T>
+inline void operator*=(vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a * b; });
+}
+
+template<class T>
+inline void operator*=(vec3_soa<T>& vecs, T t)
+{
+	soa_apply(vecs, [t](T a) { return a * t; });
+}
+
+template<class T>
+inline void operator*=(vec4_soa<T>& vecs, T t)
+{
+	soa_apply(vecs, [t](T a) { return a * t; });
+}
+
+#ifndef MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline vec3_soa<T> operator/(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a / b; });
+}
+
+template<class T>
+inline vec4_soa<T> operator/(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return a / b; });
+}
+
+template<class T>
+inline vec3_soa<T> operator/(const vec3_soa<T>& vecs, T t)
+{
+	T t_inv = static_cast<T>(1.0) / t;
+	return soa_map(vecs, [t_inv](T a) { return a * t_inv; });
+}
+
+template<class T>
+inline vec4_soa<T> operator/(const vec4_soa<T>& vecs, T t)
+{
+	T t_inv = static_cast<T>(1.0) / t;
+	return soa_map(vecs, [t_inv](T a) { return a * t_inv; });
+}
+
+template<class T>
+inline vec3_soa<T> operator/(T t, const vec3_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t / a; });
+}
+
+template<class T>
+inline vec4_soa<T> operator/(T t, const vec4_soa<T>& vecs)
+{
+	return soa_map(vecs, [t](T a) { return t / a; });
+}
+
+#endif // !MATH_EXPRESSION_TEMPLATES
+
+template<class T>
+inline void operator/=(vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a / b; });
+}
+
+template<class T>
+inline void operator/=(vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	soa_apply(vecs1, vecs2, [](T a, T b) { return a / b; });
+}
+
+template<class T>
+inline void operator/=(vec3_soa<T>& vecs, T t)
+{
+	T t_inv = static_cast<T>(1.0) / t;
+	soa_apply(vecs, [t_inv](T a) { return a * t_inv; });
+}
+
+template<class T>
+inline void operator/=(vec4_soa<T>& vecs, T t)
+{
+	T t_inv = static_cast<T>(1.0) / t;
+	soa_apply(vecs, [t_inv](T a) { return a * t_inv; });
+}
+
+template<class T>
+inline vec3_soa<T> max(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return max(a, b); });
+}
+
+template<class T>
+inline vec4_soa<T> max(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return max(a, b); });
+}
+
+template<class T>
+inline vec3_soa<T> min(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return min(a, b); });
+}
+
+template<class T>
+inline vec4_soa<T> min(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2)
+{
+	return soa_map(vecs1, vecs2, [](T a, T b) { return min(a, b); });
+}
+
+template<class T>
+inline vec3_soa<T> lerp(const vec3_soa<T>& vecs1, const vec3_soa<T>& vecs2, T t)
+{
+	return soa_map(vecs1, vecs2, [t](T a, T b) { return lerp(a, b, t); });
+}
+
+template<class T>
+inline vec4_soa<T> lerp(const vec4_soa<T>& vecs1, const vec4_soa<T>& vecs2, T t)
+{
+	return soa_map(vecs1, vecs2, [t](T a, T b) { return lerp(a, b, t); });
+}
+
+template<class T>
+inline vec3_soa<T> clamp(const vec3_soa<T>& vecs, T min, T max)
+{
+	return soa_map(vecs, [min, max](T a) { return clamp(a, min, max); });
+}
+
+template<class T>
+inline vec4_soa<T> clamp(const vec4_soa<T>& vecs, T min, T max)
+{
+	return soa_map(vecs, [min, max](T a) { return clamp(a, min, max); });
+}
+
+//The operators take the policy of an execution_scope, the vec and mat overloads of these names are found through their arguments
+MATH_EXECUTION_OVERLOAD(soa_map)
+MATH_EXECUTION_OVERLOAD(soa_apply)
+MATH_EXECUTION_OVERLOAD(to_soa)
+MATH_EXECUTION_OVERLOAD(to_aos)
+MATH_EXECUTION_OVERLOAD(dot)
+MATH_EXECUTION_OVERLOAD(cross)
+MATH_EXECUTION_OVERLOAD(sqr_length)
+MATH_EXECUTION_OVERLOAD(length)
+MATH_EXECUTION_OVERLOAD(normal)
+MATH_EXECUTION_OVERLOAD(normalize)
+MATH_EXECUTION_OVERLOAD(rsqrt)
+MATH_EXECUTION_OVERLOAD(fast_length)
+MATH_EXECUTION_OVERLOAD(fast_normalize)
+MATH_EXECUTION_OVERLOAD(fast_normal)
+MATH_EXECUTION_OVERLOAD(max)
+MATH_EXECUTION_OVERLOAD(min)
+MATH_EXECUTION_OVERLOAD(lerp)
+MATH_EXECUTION_OVERLOAD(clamp)
+
+#ifdef MATH_EXPRESSION_TEMPLATES
+#include "expression.hpp"
+#endif
+
+#endif // !__SOA__
@@ -0,0 +1,152 @@
+#pragma once
+
+#ifndef __TRANSFORM__
+#define __TRANSFORM__
+
+#include "dispatch.hpp"
+#include "parallel.hpp"
+
+/*
+	transform_points / transform_directions
+	- points are transformed with w = 1, directions with w = 0 (translation is ignored)
+	- out may be the same buffer as the input, the overloads without out transform in place
+	- perspective_divide divides the transformed xyz by the transformed w
+	- strided overloads read and write x, y, z at the start of each element, strides are in bytes
+	- arrays are split across threads in PARALLEL_GRAIN sized chunks
+*/
+
+//Matrix whose rows are the images of x, y, z and w, for either vector convention
+template<class T>
+inline mat4x4<T> transform_basis(const mat4x4<T>& mat, bool is_row_vector)
+{
+	return is_row_vector ? mat : mat.transpose();
+}
+
+template<class T>
+inline void transform_strided(const char* in, size_t in_stride, char* out, size_t out_stride, size_t count, const mat4x4<T>& basis, T w, bool perspective_divide)
+{
+	const T* b = basis.ptr();
+	T c0 = b[12] * w, c1 = b[13] * w, c2 = b[14] * w, c3 = b[15] * w;
+	for (size_t i = 0; i < count; i++)
+	{
+		const T* v = reinterpret_cast<const T*>(in + i * in_stride);
+		T* r = reinterpret_cast<T*>(out + i * out_stride);
+		T x = v[0], y = v[1], z = v[2];
+		T rx = x * b[0] + y * b[4] + z * b[8] + c0;
+		T ry = x * b[1] + y * b[5] + z * b[9] + c1;
+		T rz = x * b[2] + y * b[6] + z * b[10] + c2;
+		if (perspective_divide)
+		{
+			T rw = x * b[3] + y * b[7] + z * b[11] + c3;
+			rx /= rw; ry /= rw; rz /= rw;
+		}
+		r[0] = rx; r[1] = ry; r[2] = rz;
+	}
+}
+
+inline void transform_strided(const char* in, size_t in_stride, char* out, size_t out_stride, size_t count, const mat4x4<float>& basis, float w, bool perspective_divide)
+{
+	batch_kernels().transform_vec3f(in, in_stride, out, out_stride, count, basis.ptr(), w, perspective_divide);
+}
+
+template<class T>
+inline void transform_strided_parallel(const T* in, size_t in_stride, T* out, size_t out_stride, size_t count, const mat4x4<T>& mat, bool is_row_vector, T w, bool perspective_divide)
+{
+	if (in_stride < 3 * sizeof(T) || out_stride < 3 * sizeof(T)) { throw std::invalid_argument("stride must cover 3 components!"); }
+	mat4x4<T> basis = transform_basis(mat, is_row_vector);
+	const char* src = reinterpret_cast<const char*>(in);
+	char* dst = reinterpret_cast<char*>(out);
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		transform_strided(src + begin * in_stride, in_stride, dst + begin * out_stride, out_stride, end - begin, basis, w, perspective_divide);
+	});
+}
+
+template<class T>
+inline void transform_points(const T* in, size_t in_stride, T* out, size_t out_stride, size_t count, const mat4x4<T>& mat,
+	bool is_row_vector = true, bool perspective_divide = false)
+{
+	transform_strided_parallel(in, in_stride, out, out_stride, count, mat, is_row_vector, static_cast<T>(1.0), perspective_divide);
+}
+
+template<class T>
+inline void transform_directions(const T* in, size_t in_stride, T* out, size_t out_stride, size_t count, const mat4x4<T>& mat,
+	bool is_row_vector = true)
+{
+	transform_strided_parallel(in, in_stride, out, out_stride, count, mat, is_row_vector, static_cast<T>(0.0), false);
+}
+
+template<class T>
+inline void transform_points(const vec3<T>* points, vec3<T>* out, size_t count, const mat4x4<T>& mat,
+	bool is_row_vector = true, bool perspective_divide = false)
+{
+	transform_points(&points->x, sizeof(vec3<T>), &out->x, sizeof(vec3<T>), count, mat, is_row_vector, perspective_divide);
+}
+
+template<class T>
+inline void transform_points(vec3<T>* points, size_t count, const mat4x4<T>& mat, bool is_row_vector = true, bool perspective_divide = false)
+{
+	transform_points(points, points, count, mat, is_row_vector, perspective_divide);
+}
+
+template<class T>
+inline void transform_directions(const vec3<T>* directions, vec3<T>* out, size_t count, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	transform_directions(&directions->x, sizeof(vec3<T>), &out->x, sizeof(vec3<T>), count, mat, is_row_vector);
+}
+
+template<class T>
+inline void transform_directions(vec3<T>* directions, size_t count, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	transform_directions(directions, directions, count, mat, is_row_vector);
+}
+
+//Homogeneous points, the stored w is used, after a perspective divide w is 1
+template<class T>
+inline void transform_points(const vec4<T>* points, vec4<T>* out, size_t count, const mat4x4<T>& mat,
+	bool is_row_vector = true, bool perspective_divide = false)
+{
+	parallel_for(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		batch_transform(points + begin, out + begin, end - begin, mat, is_row_vector);
+		if (perspective_divide)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				T w_inv = static_cast<T>(1.0) / out[i].w;
+				out[i].x *= w_inv; out[i].y *= w_inv; out[i].z *= w_inv; out[i].w = 1.0;
+			}
+		}
+	});
+}
+
+template<class T>
+inline void transform_points(vec4<T>* points, size_t count, const mat4x4<T>& mat, bool is_row_vector = true, bool perspective_divide = false)
+{
+	transform_points(points, points, count, mat, is_row_vector, perspective_divide);
+}
+
+//xyz is transformed with w = 0, the stored w is kept
+template<class T>
+inline void transform_directions(const vec4<T>* directions, vec4<T>* out, size_t count, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	transform_directions(&directions->x, sizeof(vec4<T>), &out->x, sizeof(vec4<T>), count, mat, is_row_vector);
+	if (directions != out)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			out[i].w = directions[i].w;
+		}
+	}
+}
+
+template<class T>
+inline void transform_directions(vec4<T>* directions, size_t count, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	transform_directions(directions, directions, count, mat, is_row_vector);
+}
+
+MATH_EXECUTION_OVERLOAD(transform_points)
+MATH_EXECUTION_OVERLOAD(transform_directions)
+
+#endif // !__TRANSFORM__
@@ -5,6 +5,7 @@
 
 #include <type_traits>
 #include <stdexcept>
+#include <cassert>
 #include <exception>
 #include <cmath>
 #include <string>
@@ -14,8 +15,11 @@
 #include <iomanip>
 #include <array>
 #include <tuple>
+#include <limits>
 #include <stdio.h>
 
+#include "simd.hpp"
+
 template<class T>
 class vec2;
 
@@ -39,50 +43,116 @@ using vec4ld = vec4<long double>;
 
 #define FLOATING_POINT_THRESHOLD 0.000001
 
+/*
+	MATH_CHECK_INDEX
+	- runtime indices (operator[], operator(), row, col, ...) throw std::out_of_range by default
+	- define MATH_UNCHECKED to only assert them in debug builds and drop the check in release builds
+	- the library itself indexes through unchecked() and get<>(), which never check at run time
+*/
+#ifdef MATH_UNCHECKED
+#define MATH_CHECK_INDEX(condition, message) assert(!(condition) && message)
+#else
+#define MATH_CHECK_INDEX(condition, message) do { if (condition) { throw std::out_of_range(message); } } while (false)
+#endif
+
+template<class T>
+constexpr bool equal(T t1, T t2, T threshold = FLOATING_POINT_THRESHOLD);
+
+/*
+	constexpr_sqrt
+	- std::sqrt at run time, Newton-Raphson iterations when evaluated in a constant expression
+*/
+template<class T>
+constexpr T constexpr_sqrt(T t)
+{
+	if (!MATH_IS_CONSTANT_EVALUATED())
+	{
+		return std::sqrt(t);
+	}
+	if (!(t > 0))
+	{
+		return t < 0 ? std::numeric_limits<T>::quiet_NaN() : t;
+	}
+	//Starts above the root, each step then decreases until it stops making progress
+	T current = t >= 1 ? t : static_cast<T>(1.0);
+	for (;;)
+	{
+		T next = (current + t / current) * static_cast<T>(0.5);
+		if (!(next < current))
+		{
+			return current;
+		}
+		current = next;
+	}
+}
+
 template<class T>
 class vec2
 {
 public:
 	T x, y;
-	static vec2<T> zero;
-	static vec2<T> one;
+	static const vec2<T> zero;
+	static const vec2<T> one;
 
 public:
-	vec2()
+	constexpr vec2() : x(0.0), y(0.0)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec2 must be a floating-point type!");
-		x = 0.0; y = 0.0;
 	}
 
-	explicit vec2(T value)
+	constexpr explicit vec2(T value) : x(value), y(value)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec2 must be a floating-point type!");
-		x = value; y = value;
 	}
 
-	vec2(T x, T y)
+	constexpr vec2(T x, T y) : x(x), y(y)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec2 must be a floating-point type!");
-		this->x = x; this->y = y;
 	}
 
-	vec2(std::array<T, 2> arr)
+	constexpr vec2(std::array<T, 2> arr) : x(arr[0]), y(arr[1])
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec2 must be a floating-point type!");
-		x = arr[0]; y = arr[1];
 	}
 
 public:
-	T& operator[](size_t index)
+	constexpr T& operator[](size_t index)
+	{
+		MATH_CHECK_INDEX(index >= 2, "vec2 index out of range!");
+		return unchecked(index);
+	}
+
+	constexpr T operator[](size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= 2, "vec2 index out of range!");
+		return unchecked(index);
+	}
+
+	//Unchecked runtime access, for loops whose index is known to be in range
+	constexpr T& unchecked(size_t index)
+	{
+		return index == 0 ? x : y;
+	}
+
+	constexpr T unchecked(size_t index) const
+	{
+		return index == 0 ? x : y;
+	}
+
+	template<size_t I>
+	constexpr T& get()
 	{
-		if (index >= 2 || index < 0) { throw std::out_of_range("vec2 index out of range!"); }
-		return *(&x + index);
+		static_assert(I < 2, "vec2 index out of range!");
+		if constexpr (I == 0) { return x; }
+		else { return y; }
 	}
 
-	T operator[](size_t index) const
+	template<size_t I>
+	constexpr T get() const
 	{
-		if (index >= 2 || index < 0) { throw std::out_of_range("vec2 index out of range!"); }
-		return *(&x + index);
+		static_assert(I < 2, "vec2 index out of range!");
+		if constexpr (I == 0) { return x; }
+		else { return y; }
 	}
 
 public:
@@ -93,45 +163,45 @@ public:
 		return ptr;
 	}
 
-	T* ptr()
+	constexpr T* ptr()
 	{
 		return &x;
 	}
 
-	std::array<T, 2> to_array() const
+	constexpr std::array<T, 2> to_array() const
 	{
 		return { x, y };
 	}
 
-	T length() const
+	constexpr T length() const
 	{
-		return sqrt(x * x + y * y);
+		return constexpr_sqrt(x * x + y * y);
 	}
 
-	T sqr_length() const
+	constexpr T sqr_length() const
 	{
 		return x * x + y * y;
 	}
 
-	vec2<T> normal() const
+	constexpr vec2<T> normal() const
 	{
 		T length = this->length();
 		return vec2<T>(x / length, y / length);
 	}
 
-	void normalize()
+	constexpr void normalize()
 	{
 		T length = this->length();
 		this->x /= length;
 		this->y /= length;
 	}
 
-	bool is_normal() const
+	constexpr bool is_normal() const
 	{
 		return equal(this->length(), static_cast<T>(1.0));
 	}
 
-	T dot(vec2<T> vec) const
+	constexpr T dot(vec2<T> vec) const
 	{
 		return vec.x * this->x + vec.y * this->y;
 	}
@@ -156,45 +226,70 @@ class vec3
 {
 public:
 	T x, y, z;
-	static vec3<T> zero;
-	static vec3<T> one;
+	static const vec3<T> zero;
+	static const vec3<T> one;
 
 public:
-	vec3()
+	constexpr vec3() : x(0.0), y(0.0), z(0.0)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec3 must be a floating-point type!");
-		x = 0.0; y = 0.0; z = 0.0;
 	}
 
-	explicit vec3(T value)
+	constexpr explicit vec3(T value) : x(value), y(value), z(value)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec3 must be a floating-point type!");
-		x = value; y = value; z = value;
 	}
 
-	vec3(T x, T y, T z)
+	constexpr vec3(T x, T y, T z) : x(x), y(y), z(z)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec3 must be a floating-point type!");
-		this->x = x; this->y = y; this->z = z;
 	}
 
-	vec3(std::array<T, 3> arr)
+	constexpr vec3(std::array<T, 3> arr) : x(arr[0]), y(arr[1]), z(arr[2])
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec3 must be a floating-point type!");
-		x = arr[0]; y = arr[1]; z = arr[2];
 	}
 
 public:
-	T& operator[](size_t index)
+	constexpr T& operator[](size_t index)
 	{
-		if (index >= 3 || index < 0) { throw std::out_of_range("vec3 index out of range!"); }
-		return *(&x + index);
+		MATH_CHECK_INDEX(index >= 3, "vec3 index out of range!");
+		return unchecked(index);
 	}
 
-	T operator[](size_t index) const
+	constexpr T operator[](size_t index) const
 	{
-		if (index >= 3 || index < 0) { throw std::out_of_range("vec3 index out of range!"); }
-		return *(&x + index);
+		MATH_CHECK_INDEX(index >= 3, "vec3 index out of range!");
+		return unchecked(index);
+	}
+
+	//Unchecked runtime access, for loops whose index is known to be in range
+	constexpr T& unchecked(size_t index)
+	{
+		return index == 0 ? x : index == 1 ? y : z;
+	}
+
+	constexpr T unchecked(size_t index) const
+	{
+		return index == 0 ? x : index == 1 ? y : z;
+	}
+
+	template<size_t I>
+	constexpr T& get()
+	{
+		static_assert(I < 3, "vec3 index out of range!");
+		if constexpr (I == 0) { return x; }
+		else if constexpr (I == 1) { return y; }
+		else { return z; }
+	}
+
+	template<size_t I>
+	constexpr T get() const
+	{
+		static_assert(I < 3, "vec3 index out of range!");
+		if constexpr (I == 0) { return x; }
+		else if constexpr (I == 1) { return y; }
+		else { return z; }
 	}
 
 public:
@@ -205,33 +300,33 @@ public:
 		return ptr;
 	}
 
-	T* ptr()
+	constexpr T* ptr()
 	{
 		return &x;
 	}
 
-	std::array<T, 3> to_array() const
+	constexpr std::array<T, 3> to_array() const
 	{
 		return { x, y, z };
 	}
 
-	T length() const
+	constexpr T length() const
 	{
-		return sqrt(x * x + y * y + z * z);
+		return constexpr_sqrt(x * x + y * y + z * z);
 	}
 
-	T sqr_length() const
+	constexpr T sqr_length() const
 	{
 		return x * x + y * y + z * z;
 	}
 
-	vec3<T> normal() const
+	constexpr vec3<T> normal() const
 	{
 		T length = this->length();
 		return vec3<T>(x / length, y / length, z / length);
 	}
 
-	void normalize()
+	constexpr void normalize()
 	{
 		T length = this->length();
 		this->x /= length;
@@ -239,17 +334,17 @@ public:
 		this->z /= length;
 	}
 
-	bool is_normal() const
+	constexpr bool is_normal() const
 	{
 		return equal(this->length(), static_cast<T>(1.0));
 	}
 
-	T dot(vec3<T> vec) const
+	constexpr T dot(vec3<T> vec) const
 	{
 		return vec.x * this->x + vec.y * this->y + vec.z * this->z;
 	}
 
-	vec3<T> cross(vec3<T> vec) const
+	constexpr vec3<T> cross(vec3<T> vec) const
 	{
 		return vec3<T>(this->y * vec.z - this->z * vec.y, this->z * vec.x - this->x * vec.z, this->x * vec.y - this->y * vec.x);
 	}
@@ -274,45 +369,72 @@ class vec4
 {
 public:
 	T x, y, z, w;
-	static vec4<T> zero;
-	static vec4<T> one;
+	static const vec4<T> zero;
+	static const vec4<T> one;
 
 public:
-	vec4()
+	constexpr vec4() : x(0.0), y(0.0), z(0.0), w(0.0)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec4 must be a floating-point type!");
-		x = 0.0; y = 0.0; z = 0.0; w = 0.0;
 	}
 
-	explicit vec4(T value)
+	constexpr explicit vec4(T value) : x(value), y(value), z(value), w(value)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec4 must be a floating-point type!");
-		x = value; y = value; z = value; w = value;
 	}
 
-	vec4(T x, T y, T z, T w)
+	constexpr vec4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w)
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec4 must be a floating-point type!");
-		this->x = x; this->y = y; this->z = z; this->w = w;
 	}
 
-	vec4(std::array<T, 4> arr)
+	constexpr vec4(std::array<T, 4> arr) : x(arr[0]), y(arr[1]), z(arr[2]), w(arr[3])
 	{
 		static_assert(std::is_floating_point<T>::value, "Type T of vec4 must be a floating-point type!");
-		x = arr[0]; y = arr[1]; z = arr[2]; w = arr[3];
 	}
 
 public:
-	T& operator[](size_t index)
+	constexpr T& operator[](size_t index)
+	{
+		MATH_CHECK_INDEX(index >= 4, "vec4 index out of range!");
+		return unchecked(index);
+	}
+
+	constexpr T operator[](size_t index) const
 	{
-		if (index >= 4 || index < 0) { throw std::out_of_range("vec4 index out of range!"); }
-		return *(&x + index);
+		MATH_CHECK_INDEX(index >= 4, "vec4 index out of range!");
+		return unchecked(index);
 	}
 
-	T operator[](size_t index) const
+	//Unchecked runtime access, for loops whose index is known to be in range
+	constexpr T& unchecked(size_t index)
 	{
-		if (index >= 4 || index < 0) { throw std::out_of_range("vec4 index out of range!"); }
-		return *(&x + index);
+		return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
+	}
+
+	constexpr T unchecked(size_t index) const
+	{
+		return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
+	}
+
+	template<size_t I>
+	constexpr T& get()
+	{
+		static_assert(I < 4, "vec4 index out of range!");
+		if constexpr (I == 0) { return x; }
+		else if constexpr (I == 1) { return y; }
+		else if constexpr (I == 2) { return z; }
+		else { return w; }
+	}
+
+	template<size_t I>
+	constexpr T get() const
+	{
+		static_assert(I < 4, "vec4 index out of range!");
+		if constexpr (I == 0) { return x; }
+		else if constexpr (I == 1) { return y; }
+		else if constexpr (I == 2) { return z; }
+		else { return w; }
 	}
 
 public:
@@ -323,33 +445,33 @@ public:
 		return ptr;
 	}
 
-	T* ptr()
+	constexpr T* ptr()
 	{
 		return &x;
 	}
 
-	std::array<T, 4> to_array() const
+	constexpr std::array<T, 4> to_array() const
 	{
 		return { x, y, z, w };
 	}
 
-	T length() const
+	constexpr T length() const
 	{
-		return sqrt(x * x + y * y + z * z + w * w);
+		return constexpr_sqrt(x * x + y * y + z * z + w * w);
 	}
 
-	T sqr_length() const
+	constexpr T sqr_length() const
 	{
 		return x * x + y * y + z * z + w * w;
 	}
 
-	vec4<T> normal() const
+	constexpr vec4<T> normal() const
 	{
 		T length = this->length();
-		return vec3<T>(x / length, y / length, z / length, w / length);
+		return vec4<T>(x / length, y / length, z / length, w / length);
 	}
 
-	void normalize()
+	constexpr void normalize()
 	{
 		T length = this->length();
 		this->x /= length;
@@ -358,12 +480,12 @@ public:
 		this->w /= length;
 	}
 
-	bool is_normal() const
+	constexpr bool is_normal() const
 	{
 		return equal(this->length(), static_cast<T>(1.0));
 	}
 
-	T dot(vec4<T> vec) const
+	constexpr T dot(vec4<T> vec) const
 	{
 		return vec.x * this->x + vec.y * this->y + vec.z * this->z + vec.w * this->w;
 	}
@@ -384,22 +506,22 @@ public:
 };
 
 template<class T>
-vec2<T> vec2<T>::zero = vec2<T>(0.0, 0.0);
+constexpr vec2<T> vec2<T>::zero = vec2<T>(0.0, 0.0);
 
 template<class T>
-vec2<T> vec2<T>::one = vec2<T>(1.0, 1.0);
+constexpr vec2<T> vec2<T>::one = vec2<T>(1.0, 1.0);
 
 template<class T>
-vec3<T> vec3<T>::zero = vec3<T>(0.0, 0.0, 0.0);
+constexpr vec3<T> vec3<T>::zero = vec3<T>(0.0, 0.0, 0.0);
 
 template<class T>
-vec3<T> vec3<T>::one = vec3<T>(1.0, 1.0, 1.0);
+constexpr vec3<T> vec3<T>::one = vec3<T>(1.0, 1.0, 1.0);
 
 template<class T>
-vec4<T> vec4<T>::zero = vec4<T>(0.0, 0.0, 0.0, 0.0);
+constexpr vec4<T> vec4<T>::zero = vec4<T>(0.0, 0.0, 0.0, 0.0);
 
 template<class T>
-vec4<T> vec4<T>::one = vec4<T>(1.0, 1.0, 1.0, 1.0);
+constexpr vec4<T> vec4<T>::one = vec4<T>(1.0, 1.0, 1.0, 1.0);
 
 template<class T>
 std::unique_ptr<T[]> copy(vec2<T> vec)
@@ -437,687 +559,819 @@ T* ptr(vec4<T> vec)
 	return vec.ptr();
 }
 
+template<size_t I, class T>
+constexpr T& get(vec2<T>& vec)
+{
+	return vec.template get<I>();
+}
+
+template<size_t I, class T>
+constexpr T get(const vec2<T>& vec)
+{
+	return vec.template get<I>();
+}
+
+template<size_t I, class T>
+constexpr T& get(vec3<T>& vec)
+{
+	return vec.template get<I>();
+}
+
+template<size_t I, class T>
+constexpr T get(const vec3<T>& vec)
+{
+	return vec.template get<I>();
+}
+
+template<size_t I, class T>
+constexpr T& get(vec4<T>& vec)
+{
+	return vec.template get<I>();
+}
+
+template<size_t I, class T>
+constexpr T get(const vec4<T>& vec)
+{
+	return vec.template get<I>();
+}
+
 template<class T>
-inline std::array<T, 2> to_array(vec2<T> vec)
+constexpr std::array<T, 2> to_array(vec2<T> vec)
 {
 	return vec.to_array();
 }
 
 template<class T>
-inline std::array<T, 3> to_array(vec3<T> vec)
+constexpr std::array<T, 3> to_array(vec3<T> vec)
 {
 	return vec.to_array();
 }
 
 template<class T>
-inline std::array<T, 4> to_array(vec4<T> vec)
+constexpr std::array<T, 4> to_array(vec4<T> vec)
 {
 	return vec.to_array();
 }
 
 template<class T>
-inline vec2<T> from_array(std::array<T, 2> arr)
+constexpr vec2<T> from_array(std::array<T, 2> arr)
 {
 	return vec2<T>(arr[0], arr[1]);
 }
 
 template<class T>
-inline vec3<T> from_array(std::array<T, 3> arr)
+constexpr vec3<T> from_array(std::array<T, 3> arr)
 {
 	return vec3<T>(arr[0], arr[1], arr[2]);
 }
 
 template<class T>
-inline vec4<T> from_array(std::array<T, 4> arr)
+constexpr vec4<T> from_array(std::array<T, 4> arr)
 {
 	return vec4<T>(arr[0], arr[1], arr[2], arr[3]);
 }
 
 template<class T>
-inline T length(vec2<T> vec)
+constexpr T length(vec2<T> vec)
 {
 	return vec.length();
 }
 
 template<class T>
-inline T length(vec3<T> vec)
+constexpr T length(vec3<T> vec)
 {
 	return vec.length();
 }
 
 template<class T>
-inline T length(vec4<T> vec)
+constexpr T length(vec4<T> vec)
 {
 	return vec.length();
 }
 
 template<class T>
-inline T sqr_length(vec2<T> vec)
+constexpr T sqr_length(vec2<T> vec)
 {
 	return vec.sqr_length();
 }
 
 template<class T>
-inline T sqr_length(vec3<T> vec)
+constexpr T sqr_length(vec3<T> vec)
 {
 	return vec.sqr_length();
 }
 
 template<class T>
-inline T sqr_length(vec4<T> vec)
+constexpr T sqr_length(vec4<T> vec)
 {
 	return vec.sqr_length();
 }
 
 template<class T>
-inline vec2<T> normal(vec2<T> vec)
+constexpr vec2<T> normal(vec2<T> vec)
 {
 	return vec.normal();
 }
 
 template<class T>
-inline vec3<T> normal(vec3<T> vec)
+constexpr vec3<T> normal(vec3<T> vec)
 {
 	return vec.normal();
 }
 
 template<class T>
-inline vec4<T> normal(vec4<T> vec)
+constexpr vec4<T> normal(vec4<T> vec)
 {
 	return vec.normal();
 }
 
 template<class T>
-inline void normalize(vec2<T> vec)
+constexpr void normalize(vec2<T>& vec)
 {
 	vec.normalize();
 }
 
 template<class T>
-inline void normalize(vec3<T> vec)
+constexpr void normalize(vec3<T>& vec)
 {
 	vec.normalize();
 }
 
 template<class T>
-inline void normalize(vec4<T> vec)
+constexpr void normalize(vec4<T>& vec)
 {
 	vec.normalize();
 }
 
 template<class T>
-inline bool is_normal(vec2<T> vec)
+constexpr bool is_normal(vec2<T> vec)
 {
 	return vec.is_normal();
 }
 
 template<class T>
-inline bool is_normal(vec3<T> vec)
+constexpr bool is_normal(vec3<T> vec)
 {
 	return vec.is_normal();
 }
 
 template<class T>
-inline bool is_normal(vec4<T> vec)
+constexpr bool is_normal(vec4<T> vec)
 {
 	return vec.is_normal();
 }
 
+/*
+	rsqrt / fast_length / fast_normal / fast_normalize
+	- float t in [FLT_MIN, FLT_MAX] uses the hardware reciprocal square root estimate (rsqrtss, relative error below
+	  1.5 * 2^-12) refined by one Newton-Raphson step, the result is within 2^-21 (about 4.8e-7) relative error of
+	  1 / sqrt(t)
+	- other types, float without SSE2 and float t outside that range (zero, subnormal, infinite, negative or NaN)
+	  compute 1 / sqrt(t) exactly: rsqrt(0) is infinite and rsqrt(infinity) is 0
+	- fast_length of a zero vector is 0 and fast_normal of a zero vector is not finite like normal()
+*/
+template<class T>
+inline T rsqrt(T t)
+{
+	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
+	return static_cast<T>(1.0) / std::sqrt(t);
+}
+
+#ifdef MATH_SSE2
+template<>
+inline float rsqrt(float t)
+{
+	//rsqrtss gives infinity for subnormals, which the Newton step turns into -infinity or NaN
+	if (!(t >= std::numeric_limits<float>::min() && t <= std::numeric_limits<float>::max()))
+	{
+		return 1.0f / std::sqrt(t);
+	}
+	__m128 v = _mm_set_ss(t);
+	__m128 e = _mm_rsqrt_ss(v);
+	//e * (1.5 - 0.5 * t * e * e)
+	__m128 half_v_e2 = _mm_mul_ss(_mm_mul_ss(_mm_mul_ss(v, _mm_set_ss(0.5f)), e), e);
+	return _mm_cvtss_f32(_mm_mul_ss(e, _mm_sub_ss(_mm_set_ss(1.5f), half_v_e2)));
+}
+#endif
+
+template<class T>
+inline T fast_sqrt(T t)
+{
+	return t > 0 ? t * rsqrt(t) : static_cast<T>(0.0);
+}
+
+template<class T>
+inline T fast_length(vec2<T> vec)
+{
+	return fast_sqrt(vec.sqr_length());
+}
+
+template<class T>
+inline T fast_length(vec3<T> vec)
+{
+	return fast_sqrt(vec.sqr_length());
+}
+
+template<class T>
+inline T fast_length(vec4<T> vec)
+{
+	return fast_sqrt(vec.sqr_length());
+}
+
+template<class T>
+inline vec2<T> fast_normal(vec2<T> vec)
+{
+	T length_inv = rsqrt(vec.sqr_length());
+	return vec2<T>(vec.x * length_inv, vec.y * length_inv);
+}
+
+template<class T>
+inline vec3<T> fast_normal(vec3<T> vec)
+{
+	T length_inv = rsqrt(vec.sqr_length());
+	return vec3<T>(vec.x * length_inv, vec.y * length_inv, vec.z * length_inv);
+}
+
+template<class T>
+inline vec4<T> fast_normal(vec4<T> vec)
+{
+	T length_inv = rsqrt(vec.sqr_length());
+	return vec4<T>(vec.x * length_inv, vec.y * length_inv, vec.z * length_inv, vec.w * length_inv);
+}
+
+template<class T>
+inline void fast_normalize(vec2<T>& vec)
+{
+	vec = fast_normal(vec);
+}
+
+template<class T>
+inline void fast_normalize(vec3<T>& vec)
+{
+	vec = fast_normal(vec);
+}
+
+template<class T>
+inline void fast_normalize(vec4<T>& vec)
+{
+	vec = fast_normal(vec);
+}
+
 template<class T>
-inline T dot(vec2<T> vec1, vec2<T> vec2)
+constexpr T dot(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec1.dot(vec2);
 }
 
 template<class T>
-inline T dot(vec3<T> vec1, vec3<T> vec2)
+constexpr T dot(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec1.dot(vec2);
 }
 
 template<class T>
-inline T dot(vec4<T> vec1, vec4<T> vec2)
+constexpr T dot(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec1.dot(vec2);
 }
 
 template<class T>
-inline vec3<T> cross(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> cross(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec1.cross(vec2);
 }
 
 template<class T>
-inline bool operator==(vec2<T> vec1, vec2<T> vec2)
+constexpr bool operator==(vec2<T> vec1, vec2<T> vec2)
 {
 	return equal(vec1.x, vec2.x) && equal(vec1.y, vec2.y);
 }
 
 template<class T>
-inline bool operator==(vec3<T> vec1, vec3<T> vec2)
+constexpr bool operator==(vec3<T> vec1, vec3<T> vec2)
 {
 	return equal(vec1.x, vec2.x) && equal(vec1.y, vec2.y) && equal(vec1.z, vec2.z);
 }
 
 template<class T>
-inline bool operator==(vec4<T> vec1, vec4<T> vec2)
+constexpr bool operator==(vec4<T> vec1, vec4<T> vec2)
 {
 	return equal(vec1.x, vec2.x) && equal(vec1.y, vec2.y) && equal(vec1.z, vec2.z) && equal(vec1.w, vec2.w);
 }
 
 template<class T>
-inline bool operator!=(vec2<T> vec1, vec2<T> vec2)
+constexpr bool operator!=(vec2<T> vec1, vec2<T> vec2)
 {
 	return !(vec1 == vec2);
 }
 
 template<class T>
-inline bool operator!=(vec3<T> vec1, vec3<T> vec2)
+constexpr bool operator!=(vec3<T> vec1, vec3<T> vec2)
 {
 	return !(vec1 == vec2);
 }
 
 template<class T>
-inline bool operator!=(vec4<T> vec1, vec4<T> vec2)
+constexpr bool operator!=(vec4<T> vec1, vec4<T> vec2)
 {
 	return !(vec1 == vec2);
 }
 
 template<class T>
-inline vec2<T> operator-(vec2<T> vec)
+constexpr vec2<T> operator-(vec2<T> vec)
 {
 	return vec2<T>(-vec.x, -vec.y);
 }
 
 template<class T>
-inline vec3<T> operator-(vec3<T> vec)
+constexpr vec3<T> operator-(vec3<T> vec)
 {
 	return vec3<T>(-vec.x, -vec.y, -vec.z);
 }
 
 template<class T>
-inline vec4<T> operator-(vec4<T> vec)
+constexpr vec4<T> operator-(vec4<T> vec)
 {
 	return vec4<T>(-vec.x, -vec.y, -vec.z, -vec.w);
 }
 
 template<class T>
-inline vec2<T> operator+(vec2<T> vec1, vec2<T> vec2)
+constexpr vec2<T> operator+(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec2<T>(vec1.x + vec2.x, vec1.y + vec2.y);
 }
 
 template<class T>
-inline vec3<T> operator+(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> operator+(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec3<T>(vec1.x + vec2.x, vec1.y + vec2.y, vec1.z + vec2.z);
 }
 
 template<class T>
-inline vec4<T> operator+(vec4<T> vec1, vec4<T> vec2)
+constexpr vec4<T> operator+(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec4<T>(vec1.x + vec2.x, vec1.y + vec2.y, vec1.z + vec2.z, vec1.w + vec2.w);
 }
 
 template<class T>
-inline vec2<T> operator+(vec2<T> vec, T t)
+constexpr vec2<T> operator+(vec2<T> vec, T t)
 {
 	return vec2<T>(vec.x + t, vec.y + t);
 }
 
 template<class T>
-inline vec3<T> operator+(vec3<T> vec, T t)
+constexpr vec3<T> operator+(vec3<T> vec, T t)
 {
 	return vec3<T>(vec.x + t, vec.y + t, vec.z + t);
 }
 
 template<class T>
-inline vec4<T> operator+(vec4<T> vec, T t)
+constexpr vec4<T> operator+(vec4<T> vec, T t)
 {
 	return vec4<T>(vec.x + t, vec.y + t, vec.z + t, vec.w + t);
 }
 
 template<class T>
-inline vec2<T> operator+(T t, vec2<T> vec)
+constexpr vec2<T> operator+(T t, vec2<T> vec)
 {
 	return vec2<T>(vec.x + t, vec.y + t);
 }
 
 template<class T>
-inline vec3<T> operator+(T t, vec3<T> vec)
+constexpr vec3<T> operator+(T t, vec3<T> vec)
 {
 	return vec3<T>(vec.x + t, vec.y + t, vec.z + t);
 }
 
 template<class T>
-inline vec4<T> operator+(T t, vec4<T> vec)
+constexpr vec4<T> operator+(T t, vec4<T> vec)
 {
 	return vec4<T>(vec.x + t, vec.y + t, vec.z + t, vec.w + t);
 }
 
 template<class T>
-inline void operator+=(vec2<T>& vec1, vec2<T> vec2)
+constexpr void operator+=(vec2<T>& vec1, vec2<T> vec2)
 {
 	vec1.x += vec2.x; vec1.y += vec2.y;
 }
 
 template<class T>
-inline void operator+=(vec3<T>& vec1, vec3<T> vec2)
+constexpr void operator+=(vec3<T>& vec1, vec3<T> vec2)
 {
 	vec1.x += vec2.x; vec1.y += vec2.y; vec1.z += vec2.z;
 }
 
 template<class T>
-inline void operator+=(vec4<T>& vec1, vec4<T> vec2)
+constexpr void operator+=(vec4<T>& vec1, vec4<T> vec2)
 {
 	vec1.x += vec2.x; vec1.y += vec2.y; vec1.z += vec2.z; vec1.w += vec2.w;
 }
 
 template<class T>
-inline void operator+=(vec2<T>& vec, T t)
+constexpr void operator+=(vec2<T>& vec, T t)
 {
 	vec.x += t; vec.y += t;
 }
 
 template<class T>
-inline void operator+=(vec3<T>& vec, T t)
+constexpr void operator+=(vec3<T>& vec, T t)
 {
 	vec.x += t; vec.y += t; vec.z += t;
 }
 
 template<class T>
-inline void operator+=(vec4<T>& vec, T t)
+constexpr void operator+=(vec4<T>& vec, T t)
 {
 	vec.x += t; vec.y += t; vec.z += t; vec.w += t;
 }
 
 template<class T>
-inline vec2<T> operator-(vec2<T> vec1, vec2<T> vec2)
+constexpr vec2<T> operator-(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec2<T>(vec1.x - vec2.x, vec1.y - vec2.y);
 }
 
 template<class T>
-inline vec3<T> operator-(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> operator-(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec3<T>(vec1.x - vec2.x, vec1.y - vec2.y, vec1.z - vec2.z);
 }
 
 template<class T>
-inline vec4<T> operator-(vec4<T> vec1, vec4<T> vec2)
+constexpr vec4<T> operator-(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec4<T>(vec1.x - vec2.x, vec1.y - vec2.y, vec1.z - vec2.z, vec1.w - vec2.w);
 }
 
 template<class T>
-inline vec2<T> operator-(vec2<T> vec, T t)
+constexpr vec2<T> operator-(vec2<T> vec, T t)
 {
 	return vec2<T>(vec.x - t, vec.y - t);
 }
 
 template<class T>
-inline vec3<T> operator-(vec3<T> vec, T t)
+constexpr vec3<T> operator-(vec3<T> vec, T t)
 {
 	return vec3<T>(vec.x - t, vec.y - t, vec.z - t);
 }
 
 template<class T>
-inline vec4<T> operator-(vec4<T> vec, T t)
+constexpr vec4<T> operator-(vec4<T> vec, T t)
 {
 	return vec4<T>(vec.x - t, vec.y - t, vec.z - t, vec.w - t);
 }
 
 template<class T>
-inline vec2<T> operator-(T t, vec2<T> vec)
+constexpr vec2<T> operator-(T t, vec2<T> vec)
 {
-	return vec2<T>(vec.x - t, vec.y - t);
+	return vec2<T>(t - vec.x, t - vec.y);
 }
 
 template<class T>
-inline vec3<T> operator-(T t, vec3<T> vec)
+constexpr vec3<T> operator-(T t, vec3<T> vec)
 {
-	return vec3<T>(vec.x - t, vec.y - t, vec.z - t);
+	return vec3<T>(t - vec.x, t - vec.y, t - vec.z);
 }
 
 template<class T>
-inline vec4<T> operator-(T t, vec4<T> vec)
+constexpr vec4<T> operator-(T t, vec4<T> vec)
 {
-	return vec4<T>(vec.x - t, vec.y - t, vec.z - t, vec.w - t);
+	return vec4<T>(t - vec.x, t - vec.y, t - vec.z, t - vec.w);
 }
 
 template<class T>
-inline void operator-=(vec2<T>& vec1, vec2<T> vec2)
+constexpr void operator-=(vec2<T>& vec1, vec2<T> vec2)
 {
 	vec1.x -= vec2.x; vec1.y -= vec2.y;
 }
 
 template<class T>
-inline void operator-=(vec3<T>& vec1, vec3<T> vec2)
+constexpr void operator-=(vec3<T>& vec1, vec3<T> vec2)
 {
 	vec1.x -= vec2.x; vec1.y -= vec2.y; vec1.z -= vec2.z;
 }
 
 template<class T>
-inline void operator-=(vec4<T>& vec1, vec4<T> vec2)
+constexpr void operator-=(vec4<T>& vec1, vec4<T> vec2)
 {
 	vec1.x -= vec2.x; vec1.y -= vec2.y; vec1.z -= vec2.z; vec1.w -= vec2.w;
 }
 
 template<class T>
-inline void operator-=(vec2<T>& vec, T t)
+constexpr void operator-=(vec2<T>& vec, T t)
 {
 	vec.x -= t; vec.y -= t;
 }
 
 template<class T>
-inline void operator-=(vec3<T>& vec, T t)
+constexpr void operator-=(vec3<T>& vec, T t)
 {
 	vec.x -= t; vec.y -= t; vec.z -= t;
 }
 
 template<class T>
-inline void operator-=(vec4<T>& vec, T t)
+constexpr void operator-=(vec4<T>& vec, T t)
 {
 	vec.x -= t; vec.y -= t; vec.z -= t; vec.w -= t;
 }
 
 template<class T>
-inline vec2<T> operator*(vec2<T> vec1, vec2<T> vec2)
+constexpr vec2<T> operator*(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec2<T>(vec1.x * vec2.x, vec1.y * vec2.y);
 }
 
 template<class T>
-inline vec3<T> operator*(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> operator*(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec3<T>(vec1.x * vec2.x, vec1.y * vec2.y, vec1.z * vec2.z);
 }
 
 template<class T>
-inline vec4<T> operator*(vec4<T> vec1, vec4<T> vec2)
+constexpr vec4<T> operator*(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec4<T>(vec1.x * vec2.x, vec1.y * vec2.y, vec1.z * vec2.z, vec1.w * vec2.w);
 }
 
 template<class T>
-inline vec2<T> operator*(vec2<T> vec, T t)
+constexpr vec2<T> operator*(vec2<T> vec, T t)
 {
 	return vec2<T>(vec.x * t, vec.y * t);
 }
 
 template<class T>
-inline vec3<T> operator*(vec3<T> vec, T t)
+constexpr vec3<T> operator*(vec3<T> vec, T t)
 {
 	return vec3<T>(vec.x * t, vec.y * t, vec.z * t);
 }
 
 template<class T>
-inline vec4<T> operator*(vec4<T> vec, T t)
+constexpr vec4<T> operator*(vec4<T> vec, T t)
 {
 	return vec4<T>(vec.x * t, vec.y * t, vec.z * t, vec.w * t);
 }
 
 template<class T>
-inline vec2<T> operator*(T t, vec2<T> vec)
+constexpr vec2<T> operator*(T t, vec2<T> vec)
 {
 	return vec2<T>(vec.x * t, vec.y * t);
 }
 
 template<class T>
-inline vec3<T> operator*(T t, vec3<T> vec)
+constexpr vec3<T> operator*(T t, vec3<T> vec)
 {
 	return vec3<T>(vec.x * t, vec.y * t, vec.z * t);
 }
 
 template<class T>
-inline vec4<T> operator*(T t, vec4<T> vec)
+constexpr vec4<T> operator*(T t, vec4<T> vec)
 {
 	return vec4<T>(vec.x * t, vec.y * t, vec.z * t, vec.w * t);
 }
 
 template<class T>
-inline void operator*=(vec2<T>& vec1, vec2<T> vec2)
+constexpr void operator*=(vec2<T>& vec1, vec2<T> vec2)
 {
 	vec1.x *= vec2.x; vec1.y *= vec2.y;
 }
 
 template<class T>
-inline void operator*=(vec3<T>& vec1, vec3<T> vec2)
+constexpr void operator*=(vec3<T>& vec1, vec3<T> vec2)
 {
 	vec1.x *= vec2.x; vec1.y *= vec2.y; vec1.z *= vec2.z;
 }
 
 template<class T>
-inline void operator*=(vec4<T>& vec1, vec4<T> vec2)
+constexpr void operator*=(vec4<T>& vec1, vec4<T> vec2)
 {
 	vec1.x *= vec2.x; vec1.y *= vec2.y; vec1.z *= vec2.z; vec1.w *= vec2.w;
 }
 
 template<class T>
-inline void operator*=(vec2<T>& vec, T t)
+constexpr void operator*=(vec2<T>& vec, T t)
 {
 	vec.x *= t; vec.y *= t;
 }
 
 template<class T>
-inline void operator*=(vec3<T>& vec, T t)
+constexpr void operator*=(vec3<T>& vec, T t)
 {
 	vec.x *= t; vec.y *= t; vec.z *= t;
 }
 
 template<class T>
-inline void operator*=(vec4<T>& vec, T t)
+constexpr void operator*=(vec4<T>& vec, T t)
 {
 	vec.x *= t; vec.y *= t; vec.z *= t; vec.w *= t;
 }
 
 template<class T>
-inline vec2<T> operator/(vec2<T> vec1, vec2<T> vec2)
+constexpr vec2<T> operator/(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec2<T>(vec1.x / vec2.x, vec1.y / vec2.y);
 }
 
 template<class T>
-inline vec3<T> operator/(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> operator/(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec3<T>(vec1.x / vec2.x, vec1.y / vec2.y, vec1.z / vec2.z);
 }
 
 template<class T>
-inline vec4<T> operator/(vec4<T> vec1, vec4<T> vec2)
+constexpr vec4<T> operator/(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec4<T>(vec1.x / vec2.x, vec1.y / vec2.y, vec1.z / vec2.z, vec1.w / vec2.w);
 }
 
 template<class T>
-inline vec2<T> operator/(vec2<T> vec, T t)
+constexpr vec2<T> operator/(vec2<T> vec, T t)
 {
 	return vec2<T>(vec.x / t, vec.y / t);
 }
 
 template<class T>
-inline vec3<T> operator/(vec3<T> vec, T t)
+constexpr vec3<T> operator/(vec3<T> vec, T t)
 {
 	return vec3<T>(vec.x / t, vec.y / t, vec.z / t);
 }
 
 template<class T>
-inline vec4<T> operator/(vec4<T> vec, T t)
+constexpr vec4<T> operator/(vec4<T> vec, T t)
 {
 	return vec4<T>(vec.x / t, vec.y / t, vec.z / t, vec.w / t);
 }
 
 template<class T>
-inline vec2<T> operator/(T t, vec2<T> vec)
+constexpr vec2<T> operator/(T t, vec2<T> vec)
 {
-	return vec2<T>(vec.x / t, vec.y / t);
+	return vec2<T>(t / vec.x, t / vec.y);
 }
 
 template<class T>
-inline vec3<T> operator/(T t, vec3<T> vec)
+constexpr vec3<T> operator/(T t, vec3<T> vec)
 {
-	return vec3<T>(vec.x / t, vec.y / t, vec.z / t);
+	return vec3<T>(t / vec.x, t / vec.y, t / vec.z);
 }
 
 template<class T>
-inline vec4<T> operator/(T t, vec4<T> vec)
+constexpr vec4<T> operator/(T t, vec4<T> vec)
 {
-	return vec4<T>(vec.x / t, vec.y / t, vec.z / t, vec.w / t);
+	return vec4<T>(t / vec.x, t / vec.y, t / vec.z, t / vec.w);
 }
 
 template<class T>
-inline void operator/=(vec2<T>& vec1, vec2<T> vec2)
+constexpr void operator/=(vec2<T>& vec1, vec2<T> vec2)
 {
 	vec1.x /= vec2.x; vec1.y /= vec2.y;
 }
 
 template<class T>
-inline void operator/=(vec3<T>& vec1, vec3<T> vec2)
+constexpr void operator/=(vec3<T>& vec1, vec3<T> vec2)
 {
 	vec1.x /= vec2.x; vec1.y /= vec2.y; vec1.z /= vec2.z;
 }
 
 template<class T>
-inline void operator/=(vec4<T>& vec1, vec4<T> vec2)
+constexpr void operator/=(vec4<T>& vec1, vec4<T> vec2)
 {
 	vec1.x /= vec2.x; vec1.y /= vec2.y; vec1.z /= vec2.z; vec1.w /= vec2.w;
 }
 
 template<class T>
-inline void operator/=(vec2<T>& vec, T t)
+constexpr void operator/=(vec2<T>& vec, T t)
 {
 	vec.x /= t; vec.y /= t;
 }
 
 template<class T>
-inline void operator/=(vec3<T>& vec, T t)
+constexpr void operator/=(vec3<T>& vec, T t)
 {
 	vec.x /= t; vec.y /= t; vec.z /= t;
 }
 
 template<class T>
-inline void operator/=(vec4<T>& vec, T t)
+constexpr void operator/=(vec4<T>& vec, T t)
 {
 	vec.x /= t; vec.y /= t; vec.z /= t; vec.w /= t;
 }
 
 template<class T>
-inline T max(T t1, T t2)
+constexpr T max(T t1, T t2)
 {
 	return t1 >= t2 ? t1 : t2;
 }
 
 template<class T>
-inline vec2<T> max(vec2<T> vec1, vec2<T> vec2)
+constexpr vec2<T> max(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec2<T>(max(vec1.x, vec2.x), max(vec1.y, vec2.y));
 }
 
 template<class T>
-inline vec3<T> max(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> max(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec3<T>(max(vec1.x, vec2.x), max(vec1.y, vec2.y), max(vec1.z, vec2.z));
 }
 
 template<class T>
-inline vec4<T> max(vec4<T> vec1, vec4<T> vec2)
+constexpr vec4<T> max(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec4<T>(max(vec1.x, vec2.x), max(vec1.y, vec2.y), max(vec1.z, vec2.z), max(vec1.w, vec2.w));
 }
 
 template<class T>
-inline T min(T t1, T t2)
+constexpr T min(T t1, T t2)
 {
 	return t1 <= t2 ? t1 : t2;
 }
 
 template<class T>
-inline vec2<T> min(vec2<T> vec1, vec2<T> vec2)
+constexpr vec2<T> min(vec2<T> vec1, vec2<T> vec2)
 {
 	return vec2<T>(min(vec1.x, vec2.x), min(vec1.y, vec2.y));
 }
 
 template<class T>
-inline vec3<T> min(vec3<T> vec1, vec3<T> vec2)
+constexpr vec3<T> min(vec3<T> vec1, vec3<T> vec2)
 {
 	return vec3<T>(min(vec1.x, vec2.x), min(vec1.y, vec2.y), min(vec1.z, vec2.z));
 }
 
 template<class T>
-inline vec4<T> min(vec4<T> vec1, vec4<T> vec2)
+constexpr vec4<T> min(vec4<T> vec1, vec4<T> vec2)
 {
 	return vec4<T>(min(vec1.x, vec2.x), min(vec1.y, vec2.y), min(vec1.z, vec2.z), min(vec1.w, vec2.w));
 }
 
 template<class T>
-inline T abs(T t)
+constexpr T abs(T t)
 {
 	return t >= 0 ? t : -t;
 }
 
 template<class T>
-inline vec2<T> abs(vec2<T> vec)
+constexpr vec2<T> abs(vec2<T> vec)
 {
 	return vec2<T>(abs(vec.x), abs(vec.y));
 }
 
 template<class T>
-inline vec3<T> abs(vec3<T> vec)
+constexpr vec3<T> abs(vec3<T> vec)
 {
 	return vec3<T>(abs(vec.x), abs(vec.y), abs(vec.z));
 }
 
 template<class T>
-inline vec4<T> abs(vec4<T> vec)
+constexpr vec4<T> abs(vec4<T> vec)
 {
 	return vec4<T>(abs(vec.x), abs(vec.y), abs(vec.z), abs(vec.w));
 }
 
 template<class T>
-inline T lerp(T a, T b, T t)
+constexpr T lerp(T a, T b, T t)
 {
 	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
 	return a + t * (b - a);
 }
 
 template<class T>
-inline vec2<T> lerp(vec2<T> vec1, vec2<T> vec2, T t)
+constexpr vec2<T> lerp(vec2<T> vec1, vec2<T> vec2, T t)
 {
 	return vec2<T>(lerp(vec1.x, vec2.x, t), lerp(vec1.y, vec2.y, t));
 }
 
 template<class T>
-inline vec3<T> lerp(vec3<T> vec1, vec3<T> vec2, T t)
+constexpr vec3<T> lerp(vec3<T> vec1, vec3<T> vec2, T t)
 {
 	return vec3<T>(lerp(vec1.x, vec2.x, t), lerp(vec1.y, vec2.y, t), lerp(vec1.z, vec2.z, t));
 }
 
 template<class T>
-inline vec4<T> lerp(vec4<T> vec1, vec4<T> vec2, T t)
+constexpr vec4<T> lerp(vec4<T> vec1, vec4<T> vec2, T t)
 {
 	return vec4<T>(lerp(vec1.x, vec2.x, t), lerp(vec1.y, vec2.y, t), lerp(vec1.z, vec2.z, t), lerp(vec1.w, vec2.w, t));
 }
 
 template<class T>
-inline T clamp(T t, T min, T max)
+constexpr T clamp(T t, T min, T max)
 {
 	return t < min ? min : (t > max ? max : t);
 }
 
 template<class T>
-inline vec2<T> clamp(vec2<T> vec, T min, T max)
+constexpr vec2<T> clamp(vec2<T> vec, T min, T max)
 {
 	return vec2<T>(clamp(vec.x, min, max), clamp(vec.y, min, max));
 }
 
 template<class T>
-inline vec3<T> clamp(vec3<T> vec, T min, T max)
+constexpr vec3<T> clamp(vec3<T> vec, T min, T max)
 {
 	return vec3<T>(clamp(vec.x, min, max), clamp(vec.y, min, max), clamp(vec.z, min, max));
 }
 
 template<class T>
-inline vec4<T> clamp(vec4<T> vec, T min, T max)
+constexpr vec4<T> clamp(vec4<T> vec, T min, T max)
 {
 	return vec4<T>(clamp(vec.x, min, max), clamp(vec.y, min, max), clamp(vec.z, min, max), clamp(vec.w, min, max));
 }
@@ -1229,7 +1483,7 @@ inline vec4<T> mod(vec4<T> vec1, vec4<T> vec2)
 	- otherwise returns smooth interpolation between 0 and 1 based on the relative position of t between a and b 
 */
 template<class T>
-inline T smooth_interpolation(T a, T b, T t)
+constexpr T smooth_interpolation(T a, T b, T t)
 {
 	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
 	t = clamp((t - a) / (b - a), 0.0, 1.0);
@@ -1243,7 +1497,7 @@ inline T smooth_interpolation(T a, T b, T t)
 	- otherwise returns smooth interpolation between 0 and 1 based on the relative position of t between a and b
 */
 template<class T>
-inline vec2<T> smooth_interpolation(vec2<T> vec1, vec2<T> vec2, T t)
+constexpr vec2<T> smooth_interpolation(vec2<T> vec1, vec2<T> vec2, T t)
 {
 	return vec2<T>(smooth_interpolation(vec1.x, vec2.x, t), smooth_interpolation(vec1.y, vec2.y, t));
 }
@@ -1255,7 +1509,7 @@ inline vec2<T> smooth_interpolation(vec2<T> vec1, vec2<T> vec2, T t)
 	- otherwise returns smooth interpolation between 0 and 1 based on the relative position of t between a and b
 */
 template<class T>
-inline vec3<T> smooth_interpolation(vec3<T> vec1, vec3<T> vec2, T t)
+constexpr vec3<T> smooth_interpolation(vec3<T> vec1, vec3<T> vec2, T t)
 {
 	return vec3<T>(smooth_interpolation(vec1.x, vec2.x, t), smooth_interpolation(vec1.y, vec2.y, t), smooth_interpolation(vec1.z, vec2.z, t));
 }
@@ -1267,13 +1521,13 @@ inline vec3<T> smooth_interpolation(vec3<T> vec1, vec3<T> vec2, T t)
 	- otherwise returns smooth interpolation between 0 and 1 based on the relative position of t between a and b
 */
 template<class T>
-inline vec4<T> smooth_interpolation(vec4<T> vec1, vec4<T> vec2, T t)
+constexpr vec4<T> smooth_interpolation(vec4<T> vec1, vec4<T> vec2, T t)
 {
 	return vec4<T>(smooth_interpolation(vec1.x, vec2.x, t), smooth_interpolation(vec1.y, vec2.y, t), smooth_interpolation(vec1.z, vec2.z, t), smooth_interpolation(vec1.w, vec2.w, t));
 }
 
 template<class T>
-inline bool equal(T t1, T t2, T threshold = FLOATING_POINT_THRESHOLD)
+constexpr bool equal(T t1, T t2, T threshold)
 {
 	static_assert(std::is_floating_point<T>::value, "Type T of the function must be a floating-point type!");
 	return abs(t1 - t2) <= threshold;
@@ -1415,7 +1669,7 @@ inline std::istream& operator>>(std::istream& in, vec4<T>& vec)
 }
 
 template<class T>
-vec4<T> homogeneous(vec3<T> vec, bool is_point/*or direction?*/)
+constexpr vec4<T> homogeneous(vec3<T> vec, bool is_point/*or direction?*/)
 {
 	if (is_point)
 	{
@@ -1427,4 +1681,251 @@ vec4<T> homogeneous(vec3<T> vec, bool is_point/*or direction?*/)
 	}
 }
 
+#ifdef MATH_SSE2
+
+/*
+	vec4<float> / vec4<double> specializations
+	- the storage layout is unchanged, values are moved through __m128 / simd_d4 registers
+	- constant evaluation takes the scalar branch, intrinsics are not constexpr
+*/
+template<>
+constexpr float vec4<float>::length() const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return constexpr_sqrt(x * x + y * y + z * z + w * w);
+	}
+	__m128 v = _mm_loadu_ps(&x);
+	return _mm_cvtss_f32(_mm_sqrt_ss(simd_dot_ps(v, v)));
+}
+
+template<>
+constexpr float vec4<float>::sqr_length() const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return x * x + y * y + z * z + w * w;
+	}
+	__m128 v = _mm_loadu_ps(&x);
+	return _mm_cvtss_f32(simd_dot_ps(v, v));
+}
+
+template<>
+constexpr vec4<float> vec4<float>::normal() const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		float length = constexpr_sqrt(x * x + y * y + z * z + w * w);
+		return vec4<float>(x / length, y / length, z / length, w / length);
+	}
+	__m128 v = _mm_loadu_ps(&x);
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, _mm_div_ps(v, _mm_sqrt_ps(simd_dot_ps(v, v))));
+	return ret;
+}
+
+template<>
+constexpr void vec4<float>::normalize()
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		float length = constexpr_sqrt(x * x + y * y + z * z + w * w);
+		x /= length; y /= length; z /= length; w /= length;
+		return;
+	}
+	__m128 v = _mm_loadu_ps(&x);
+	_mm_storeu_ps(&x, _mm_div_ps(v, _mm_sqrt_ps(simd_dot_ps(v, v))));
+}
+
+template<>
+constexpr float vec4<float>::dot(vec4<float> vec) const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return x * vec.x + y * vec.y + z * vec.z + w * vec.w;
+	}
+	return _mm_cvtss_f32(simd_dot_ps(_mm_loadu_ps(&x), _mm_loadu_ps(&vec.x)));
+}
+
+template<>
+constexpr vec4<float> operator+(vec4<float> vec1, vec4<float> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<float>(vec1.x + vec2.x, vec1.y + vec2.y, vec1.z + vec2.z, vec1.w + vec2.w);
+	}
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, _mm_add_ps(_mm_loadu_ps(&vec1.x), _mm_loadu_ps(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr vec4<float> operator-(vec4<float> vec1, vec4<float> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<float>(vec1.x - vec2.x, vec1.y - vec2.y, vec1.z - vec2.z, vec1.w - vec2.w);
+	}
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, _mm_sub_ps(_mm_loadu_ps(&vec1.x), _mm_loadu_ps(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr vec4<float> operator*(vec4<float> vec1, vec4<float> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<float>(vec1.x * vec2.x, vec1.y * vec2.y, vec1.z * vec2.z, vec1.w * vec2.w);
+	}
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, _mm_mul_ps(_mm_loadu_ps(&vec1.x), _mm_loadu_ps(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr vec4<float> operator*(vec4<float> vec, float t)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<float>(vec.x * t, vec.y * t, vec.z * t, vec.w * t);
+	}
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, _mm_mul_ps(_mm_loadu_ps(&vec.x), _mm_set1_ps(t)));
+	return ret;
+}
+
+template<>
+constexpr vec4<float> operator/(vec4<float> vec1, vec4<float> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<float>(vec1.x / vec2.x, vec1.y / vec2.y, vec1.z / vec2.z, vec1.w / vec2.w);
+	}
+	vec4<float> ret;
+	_mm_storeu_ps(&ret.x, _mm_div_ps(_mm_loadu_ps(&vec1.x), _mm_loadu_ps(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr double vec4<double>::length() const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return constexpr_sqrt(x * x + y * y + z * z + w * w);
+	}
+	simd_d4 v = simd_load_d4(&x);
+	return std::sqrt(simd_dot_d4(v, v));
+}
+
+template<>
+constexpr double vec4<double>::sqr_length() const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return x * x + y * y + z * z + w * w;
+	}
+	simd_d4 v = simd_load_d4(&x);
+	return simd_dot_d4(v, v);
+}
+
+template<>
+constexpr vec4<double> vec4<double>::normal() const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		double length = constexpr_sqrt(x * x + y * y + z * z + w * w);
+		return vec4<double>(x / length, y / length, z / length, w / length);
+	}
+	simd_d4 v = simd_load_d4(&x);
+	vec4<double> ret;
+	simd_store_d4(&ret.x, simd_div_d4(v, simd_set1_d4(std::sqrt(simd_dot_d4(v, v)))));
+	return ret;
+}
+
+template<>
+constexpr void vec4<double>::normalize()
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		double length = constexpr_sqrt(x * x + y * y + z * z + w * w);
+		x /= length; y /= length; z /= length; w /= length;
+		return;
+	}
+	simd_d4 v = simd_load_d4(&x);
+	simd_store_d4(&x, simd_div_d4(v, simd_set1_d4(std::sqrt(simd_dot_d4(v, v)))));
+}
+
+template<>
+constexpr double vec4<double>::dot(vec4<double> vec) const
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return x * vec.x + y * vec.y + z * vec.z + w * vec.w;
+	}
+	return simd_dot_d4(simd_load_d4(&x), simd_load_d4(&vec.x));
+}
+
+template<>
+constexpr vec4<double> operator+(vec4<double> vec1, vec4<double> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<double>(vec1.x + vec2.x, vec1.y + vec2.y, vec1.z + vec2.z, vec1.w + vec2.w);
+	}
+	vec4<double> ret;
+	simd_store_d4(&ret.x, simd_add_d4(simd_load_d4(&vec1.x), simd_load_d4(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr vec4<double> operator-(vec4<double> vec1, vec4<double> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<double>(vec1.x - vec2.x, vec1.y - vec2.y, vec1.z - vec2.z, vec1.w - vec2.w);
+	}
+	vec4<double> ret;
+	simd_store_d4(&ret.x, simd_sub_d4(simd_load_d4(&vec1.x), simd_load_d4(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr vec4<double> operator*(vec4<double> vec1, vec4<double> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<double>(vec1.x * vec2.x, vec1.y * vec2.y, vec1.z * vec2.z, vec1.w * vec2.w);
+	}
+	vec4<double> ret;
+	simd_store_d4(&ret.x, simd_mul_d4(simd_load_d4(&vec1.x), simd_load_d4(&vec2.x)));
+	return ret;
+}
+
+template<>
+constexpr vec4<double> operator*(vec4<double> vec, double t)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<double>(vec.x * t, vec.y * t, vec.z * t, vec.w * t);
+	}
+	vec4<double> ret;
+	simd_store_d4(&ret.x, simd_mul_d4(simd_load_d4(&vec.x), simd_set1_d4(t)));
+	return ret;
+}
+
+template<>
+constexpr vec4<double> operator/(vec4<double> vec1, vec4<double> vec2)
+{
+	if (MATH_IS_CONSTANT_EVALUATED())
+	{
+		return vec4<double>(vec1.x / vec2.x, vec1.y / vec2.y, vec1.z / vec2.z, vec1.w / vec2.w);
+	}
+	vec4<double> ret;
+	simd_store_d4(&ret.x, simd_div_d4(simd_load_d4(&vec1.x), simd_load_d4(&vec2.x)));
+	return ret;
+}
+
+#endif // MATH_SSE2
+
 #endif // !__VECTOR__
@@ -0,0 +1,458 @@
+#pragma once
+
+#ifndef __VIEW__
+#define __VIEW__
+
+#include <iterator>
+
+#include "batch.hpp"
+#include "transform.hpp"
+
+template<class V>
+class strided_view;
+
+template<class T>
+using vec3_view = strided_view<vec3<T>>;
+
+template<class T>
+using vec4_view = strided_view<vec4<T>>;
+
+template<class T>
+using mat4x4_view = strided_view<mat4x4<T>>;
+
+template<class T>
+using const_vec3_view = strided_view<const vec3<T>>;
+
+template<class T>
+using const_vec4_view = strided_view<const vec4<T>>;
+
+template<class T>
+using const_mat4x4_view = strided_view<const mat4x4<T>>;
+
+using vec3f_view = vec3_view<float>;
+using vec3d_view = vec3_view<double>;
+using vec3ld_view = vec3_view<long double>;
+
+using vec4f_view = vec4_view<float>;
+using vec4d_view = vec4_view<double>;
+using vec4ld_view = vec4_view<long double>;
+
+using mat4x4f_view = mat4x4_view<float>;
+using mat4x4d_view = mat4x4_view<double>;
+using mat4x4ld_view = mat4x4_view<long double>;
+
+/*
+	strided_view
+	- count elements of type V starting at base, consecutive elements are stride bytes apart
+	- does not own or copy anything, e.g. the normals of an interleaved vertex buffer are
+	  vec3f_view(vertices + offsetof(vertex, normal), vertex_count, sizeof(vertex))
+	- base must be aligned for the component type, stride must be at least sizeof(V)
+	- a view of V converts to a view of const V
+*/
+template<class V>
+class strided_view
+{
+private:
+	using byte_type = typename std::conditional<std::is_const<V>::value, const char, char>::type;
+	using void_type = typename std::conditional<std::is_const<V>::value, const void, void>::type;
+
+	byte_type* base;
+	size_t count;
+	size_t step;
+
+public:
+	class iterator
+	{
+	private:
+		byte_type* ptr;
+		size_t step;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = typename std::remove_const<V>::type;
+		using difference_type = ptrdiff_t;
+		using pointer = V*;
+		using reference = V&;
+
+		iterator() : ptr(nullptr), step(0) {}
+		iterator(byte_type* ptr, size_t step) : ptr(ptr), step(step) {}
+
+		V& operator*() const { return *reinterpret_cast<V*>(ptr); }
+		V* operator->() const { return reinterpret_cast<V*>(ptr); }
+		V& operator[](ptrdiff_t n) const { return *reinterpret_cast<V*>(ptr + n * static_cast<ptrdiff_t>(step)); }
+
+		iterator& operator++() { ptr += step; return *this; }
+		iterator& operator--() { ptr -= step; return *this; }
+		iterator operator++(int) { iterator it = *this; ptr += step; return it; }
+		iterator operator--(int) { iterator it = *this; ptr -= step; return it; }
+		iterator& operator+=(ptrdiff_t n) { ptr += n * static_cast<ptrdiff_t>(step); return *this; }
+		iterator& operator-=(ptrdiff_t n) { ptr -= n * static_cast<ptrdiff_t>(step); return *this; }
+		iterator operator+(ptrdiff_t n) const { iterator it = *this; return it += n; }
+		iterator operator-(ptrdiff_t n) const { iterator it = *this; return it -= n; }
+		friend iterator operator+(ptrdiff_t n, iterator it) { return it += n; }
+		ptrdiff_t operator-(iterator it) const { return (ptr - it.ptr) / static_cast<ptrdiff_t>(step); }
+
+		bool operator==(iterator it) const { return ptr == it.ptr; }
+		bool operator!=(iterator it) const { return ptr != it.ptr; }
+		bool operator<(iterator it) const { return ptr < it.ptr; }
+		bool operator>(iterator it) const { return ptr > it.ptr; }
+		bool operator<=(iterator it) const { return ptr <= it.ptr; }
+		bool operator>=(iterator it) const { return ptr >= it.ptr; }
+	};
+
+public:
+	strided_view() : base(nullptr), count(0), step(sizeof(V))
+	{
+	}
+
+	strided_view(void_type* base, size_t count, size_t stride) : base(static_cast<byte_type*>(base)), count(count), step(stride)
+	{
+		if (stride < sizeof(V)) { throw std::invalid_argument("stride must cover the whole element!"); }
+	}
+
+	//Tightly packed array
+	strided_view(V* elements, size_t count) : base(reinterpret_cast<byte_type*>(elements)), count(count), step(sizeof(V))
+	{
+	}
+
+	template<class U, typename std::enable_if<std::is_same<const U, V>::value, int>::type = 0>
+	strided_view(strided_view<U> view) : base(reinterpret_cast<byte_type*>(view.data())), count(view.size()), step(view.stride())
+	{
+	}
+
+public:
+	V& operator[](size_t index) const
+	{
+		MATH_CHECK_INDEX(index >= count, "strided_view index out of range!");
+		return unchecked(index);
+	}
+
+	V& unchecked(size_t index) const
+	{
+		return *reinterpret_cast<V*>(base + index * step);
+	}
+
+	V& front() const
+	{
+		return (*this)[0];
+	}
+
+	V& back() const
+	{
+		return (*this)[count - 1];
+	}
+
+	V* data() const
+	{
+		return reinterpret_cast<V*>(base);
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	//Bytes between consecutive elements
+	size_t stride() const
+	{
+		return step;
+	}
+
+	//True when the elements are packed like a V array, the batch kernels then run on the view directly
+	bool contiguous() const
+	{
+		return step == sizeof(V);
+	}
+
+	iterator begin() const
+	{
+		return iterator(base, step);
+	}
+
+	iterator end() const
+	{
+		return iterator(base + count * step, step);
+	}
+
+	strided_view<V> subview(size_t offset, size_t size) const
+	{
+		MATH_CHECK_INDEX(offset > count || size > count - offset, "strided_view subview out of range!");
+		return strided_view<V>(base + offset * step, size, step);
+	}
+};
+
+//Enables a batch overload when the (possibly const) view element V is E
+template<class V, class E>
+using enable_view = typename std::enable_if<std::is_same<typename std::remove_const<V>::type, E>::value, int>::type;
+
+template<class V1, class V2>
+inline void check_view_sizes(const strided_view<V1>& view1, const strided_view<V2>& view2)
+{
+	if (view1.size() != view2.size()) { throw std::invalid_argument("views must have the same size!"); }
+}
+
+/*
+	transform_points / transform_directions on views
+	- vec3 views go straight to the strided kernels of transform.hpp
+	- vec4 views run the packed kernels when both views are contiguous, otherwise one element at a time
+*/
+template<class T, class V, enable_view<V, vec3<T>> = 0>
+inline void transform_points(strided_view<V> in, vec3_view<T> out, const mat4x4<T>& mat, bool is_row_vector = true, bool perspective_divide = false)
+{
+	check_view_sizes(in, out);
+	transform_points(reinterpret_cast<const T*>(in.data()), in.stride(), reinterpret_cast<T*>(out.data()), out.stride(), in.size(), mat, is_row_vector, perspective_divide);
+}
+
+template<class T>
+inline void transform_points(vec3_view<T> points, const mat4x4<T>& mat, bool is_row_vector = true, bool perspective_divide = false)
+{
+	transform_points(points, points, mat, is_row_vector, perspective_divide);
+}
+
+template<class T, class V, enable_view<V, vec3<T>> = 0>
+inline void transform_directions(strided_view<V> in, vec3_view<T> out, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	check_view_sizes(in, out);
+	transform_directions(reinterpret_cast<const T*>(in.data()), in.stride(), reinterpret_cast<T*>(out.data()), out.stride(), in.size(), mat, is_row_vector);
+}
+
+template<class T>
+inline void transform_directions(vec3_view<T> directions, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	transform_directions(directions, directions, mat, is_row_vector);
+}
+
+template<class T, class V, enable_view<V, vec4<T>> = 0>
+inline void transform_points(strided_view<V> in, vec4_view<T> out, const mat4x4<T>& mat, bool is_row_vector = true, bool perspective_divide = false)
+{
+	check_view_sizes(in, out);
+	if (in.contiguous() && out.contiguous())
+	{
+		transform_points(in.data(), out.data(), in.size(), mat, is_row_vector, perspective_divide);
+		return;
+	}
+	parallel_for(in.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			vec4<T> point = transform(in.unchecked(i), mat, is_row_vector);
+			if (perspective_divide)
+			{
+				T w_inv = static_cast<T>(1.0) / point.w;
+				point.x *= w_inv; point.y *= w_inv; point.z *= w_inv; point.w = 1.0;
+			}
+			out.unchecked(i) = point;
+		}
+	});
+}
+
+template<class T>
+inline void transform_points(vec4_view<T> points, const mat4x4<T>& mat, bool is_row_vector = true, bool perspective_divide = false)
+{
+	transform_points(points, points, mat, is_row_vector, perspective_divide);
+}
+
+//xyz goes through the vec3 strided kernel, the stored w is kept
+template<class T, class V, enable_view<V, vec4<T>> = 0>
+inline void transform_directions(strided_view<V> in, vec4_view<T> out, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	check_view_sizes(in, out);
+	transform_directions(reinterpret_cast<const T*>(in.data()), in.stride(), reinterpret_cast<T*>(out.data()), out.stride(), in.size(), mat, is_row_vector);
+	if (in.data() != out.data())
+	{
+		parallel_for(in.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				out.unchecked(i).w = in.unchecked(i).w;
+			}
+		});
+	}
+}
+
+template<class T>
+inline void transform_directions(vec4_view<T> directions, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	transform_directions(directions, directions, mat, is_row_vector);
+}
+
+/*
+	batch_transform / batch_normalize / batch_dot on views
+	- contiguous views run the dispatched kernels of dispatch.hpp, strided views one element at a time, split across
+	  threads above PARALLEL_GRAIN
+*/
+template<class T, class V, enable_view<V, vec4<T>> = 0>
+inline void batch_transform(strided_view<V> vecs, vec4_view<T> out, const mat4x4<T>& mat, bool is_row_vector = true)
+{
+	check_view_sizes(vecs, out);
+	if (vecs.contiguous() && out.contiguous())
+	{
+		batch_transform(vecs.data(), out.data(), vecs.size(), mat, is_row_vector);
+		return;
+	}
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out.unchecked(i) = transform(vecs.unchecked(i), mat, is_row_vector);
+		}
+	});
+}
+
+template<class T>
+inline void batch_normalize(vec4_view<T> vecs)
+{
+	if (vecs.contiguous())
+	{
+		batch_normalize(vecs.data(), vecs.size());
+		return;
+	}
+	parallel_for(vecs.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			vecs.unchecked(i).normalize();
+		}
+	});
+}
+
+template<class T, class V1, class V2, enable_view<V1, vec4<T>> = 0, enable_view<V2, vec4<T>> = 0>
+inline void batch_dot(strided_view<V1> vecs1, strided_view<V2> vecs2, T* out)
+{
+	check_view_sizes(vecs1, vecs2);
+	if (vecs1.contiguous() && vecs2.contiguous())
+	{
+		batch_dot(vecs1.data(), vecs2.data(), out, vecs1.size());
+		return;
+	}
+	parallel_for(vecs1.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = vecs1.unchecked(i).dot(vecs2.unchecked(i));
+		}
+	});
+}
+
+/*
+	multiply / batch_inverse / batch_det on views
+	- contiguous views run the batch.hpp entry points as they are, strided views are split across threads the same way
+	  and go through the mat4x4 operators one matrix at a time
+*/
+template<class T, class V1, class V2, enable_view<V1, mat4x4<T>> = 0, enable_view<V2, mat4x4<T>> = 0>
+inline void multiply(strided_view<V1> mats1, strided_view<V2> mats2, mat4x4_view<T> out)
+{
+	check_view_sizes(mats1, mats2);
+	check_view_sizes(mats1, out);
+	if (mats1.contiguous() && mats2.contiguous() && out.contiguous())
+	{
+		multiply(mats1.data(), mats2.data(), out.data(), out.size());
+		return;
+	}
+	parallel_for(out.size(), PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out.unchecked(i) = mats1.unchecked(i) * mats2.unchecked(i);
+		}
+	});
+}
+
+template<class T, class V, enable_view<V, mat4x4<T>> = 0>
+inline void multiply(const mat4x4<T>& left, strided_view<V> mats, mat4x4_view<T> out)
+{
+	check_view_sizes(mats, out);
+	if (mats.contiguous() && out.contiguous())
+	{
+		multiply(left, mats.data(), out.data(), out.size());
+		return;
+	}
+	mat4x4<T> shared = left;
+	parallel_for(out.size(), PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out.unchecked(i) = shared * mats.unchecked(i);
+		}
+	});
+}
+
+template<class T, class V, enable_view<V, mat4x4<T>> = 0>
+inline void multiply(strided_view<V> mats, const mat4x4<T>& right, mat4x4_view<T> out)
+{
+	check_view_sizes(mats, out);
+	if (mats.contiguous() && out.contiguous())
+	{
+		multiply(mats.data(), right, out.data(), out.size());
+		return;
+	}
+	mat4x4<T> shared = right;
+	parallel_for(out.size(), PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out.unchecked(i) = mats.unchecked(i) * shared;
+		}
+	});
+}
+
+template<class T, class V, enable_view<V, mat4x4<T>> = 0>
+inline size_t batch_inverse(strided_view<V> mats, mat4x4_view<T> out, uint64_t* singular_mask = nullptr, T threshold = FLOATING_POINT_THRESHOLD)
+{
+	check_view_sizes(mats, out);
+	if (mats.contiguous() && out.contiguous())
+	{
+		return batch_inverse(mats.data(), out.data(), out.size(), singular_mask, threshold);
+	}
+	if (singular_mask != nullptr)
+	{
+		for (size_t i = 0; i < (out.size() + 63) / 64; i++)
+		{
+			singular_mask[i] = 0;
+		}
+	}
+	std::atomic<size_t> singular(0);
+	parallel_for(out.size(), PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		size_t chunk_singular = 0;
+		for (size_t i = begin; i < end; i++)
+		{
+			std::tuple<bool, mat4x4<T>> inversed = mats.unchecked(i).inverse(threshold);
+			out.unchecked(i) = std::get<1>(inversed);
+			if (!std::get<0>(inversed))
+			{
+				if (singular_mask != nullptr)
+				{
+					singular_mask[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+				}
+				chunk_singular++;
+			}
+		}
+		singular += chunk_singular;
+	});
+	return singular;
+}
+
+template<class T, class V, enable_view<V, mat4x4<T>> = 0>
+inline void batch_det(strided_view<V> mats, T* out)
+{
+	if (mats.contiguous())
+	{
+		batch_det(mats.data(), out, mats.size());
+		return;
+	}
+	parallel_for(mats.size(), PARALLEL_MATRIX_GRAIN, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			out[i] = mats.unchecked(i).det();
+		}
+	});
+}
+
+#endif // !__VIEW__